@@ -0,0 +1,43 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+/**
+ * bench.h
+ *
+ * Timing helpers shared by the micro-benchmarks in bench/.
+ * Include before any system header (it selects the POSIX clock API).
+ */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_REPEATS 5              // Runs per measurement; the fastest one is reported
+
+/**
+ * Monotonic wall-clock time.
+ *
+ * @return Seconds since an arbitrary fixed point.
+ */
+static inline double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Prints one result line: time per operation and throughput.
+ *
+ * @param name    Label for the measured variant.
+ * @param ops     Operations performed in the measured run.
+ * @param seconds Duration of the measured run.
+ */
+static inline void bench_report(const char *name, uint64_t ops, double seconds) {
+    printf("%-20s %8.2f ns/op %10.1f Mops/s\n", name, seconds * 1e9 / (double)ops, (double)ops / seconds / 1e6);
+}
+
+#endif
@@ -0,0 +1,120 @@
+/**
+ * bench_dispatch.c
+ *
+ * Compares the two dispatch strategies in dispatch.c:
+ * - Flat: one lookup in the generated 64K-entry dispatch_table
+ * - Two-level: main_table by top nibble, then the group subdispatcher
+ *
+ * Both run the same pseudo-random opcode stream (register, skip, jump,
+ * timer and undefined opcodes; no drawing or memory stores) against the same
+ * leaf handlers, so the difference is the cost of dispatching. The final
+ * machine states are compared to make sure both paths agree.
+ *
+ * Usage: bench_dispatch [passes]
+ */
+
+#include "bench.h"
+#include <stdlib.h>
+#include <string.h>
+
+#include "chip8.h"
+#include "dispatch.h"
+#include "timer.h"
+
+#define STREAM_LENGTH 0x10000
+#define DEFAULT_PASSES 200
+
+static uint16_t stream[STREAM_LENGTH];
+
+/**
+ * Fills the opcode stream from a fixed-seed xorshift generator.
+ */
+static void build_stream(void) {
+    // Templates whose operand bits are randomized
+    static const uint16_t templates[] = {
+        0x1000, 0x3000, 0x4000, 0x5000, 0x6000, 0x7000, 0x7000, 0x6000,
+        0x8000, 0x8001, 0x8002, 0x8003, 0x8004, 0x8005, 0x8006, 0x8007, 0x800E,
+        0x9000, 0xA000, 0xB000,
+        0xF007, 0xF015, 0xF018, 0xF01E, 0xF029,
+        0x0123, 0x800F, 0xF0FF,    // Undefined
+    };
+    static const uint16_t operand_masks[] = {
+        0x0FFF, 0x0FFF, 0x0FFF, 0x0FF0, 0x0FFF, 0x0FFF, 0x0FFF, 0x0FFF,
+        0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0,
+        0x0FF0, 0x0FFF, 0x0FFF,
+        0x0F00, 0x0F00, 0x0F00, 0x0F00, 0x0F00,
+        0x0000, 0x0FF0, 0x0F00,
+    };
+    const uint32_t count = sizeof(templates) / sizeof(templates[0]);
+    uint32_t state = 0x12345678u;
+
+    for (uint32_t i = 0; i < STREAM_LENGTH; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+
+        uint32_t pick = (state >> 8) % count;
+        uint16_t operands = (uint16_t)(state >> 16);
+        stream[i] = templates[pick] | (operands & operand_masks[pick]);
+    }
+}
+
+/**
+ * Runs the stream `passes` times through one dispatch function.
+ *
+ * @return Duration of the fastest of BENCH_REPEATS runs, in seconds.
+ */
+static double run(Chip8 *chip8, void (*dispatch)(Chip8 *, uint16_t), int passes) {
+    double best = 0;
+
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        memset(chip8, 0, sizeof(*chip8));
+
+        double start = bench_now();
+        for (int p = 0; p < passes; p++)
+            for (uint32_t i = 0; i < STREAM_LENGTH; i++)
+                dispatch(chip8, stream[i]);
+        double elapsed = bench_now() - start;
+
+        if (r == 0 || elapsed < best) best = elapsed;
+    }
+
+    return best;
+}
+
+/**
+ * Flat-table dispatch with the same signature as dispatch_opcode_nested.
+ */
+static void dispatch_flat(Chip8 *chip8, uint16_t opcode) {
+    dispatch_opcode(chip8, opcode);
+}
+
+int main(int argc, char *argv[]) {
+    int passes = argc > 1 ? atoi(argv[1]) : DEFAULT_PASSES;
+    if (passes <= 0) {
+        fprintf(stderr, "Usage: %s [passes]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // The handlers used here never touch the platform, so no chip8_init()
+    static Chip8 flat, nested;
+    uint64_t ops = (uint64_t)STREAM_LENGTH * (uint64_t)passes;
+
+    build_stream();
+    printf("dispatch: %d opcodes x %d passes (best of %d)\n", STREAM_LENGTH, passes, BENCH_REPEATS);
+
+    double t_flat = run(&flat, dispatch_flat, passes);
+    double t_nested = run(&nested, dispatch_opcode_nested, passes);
+
+    bench_report("flat table", ops, t_flat);
+    bench_report("two-level tables", ops, t_nested);
+    printf("speedup: %.2fx\n", t_nested / t_flat);
+
+    if (memcmp(flat.V, nested.V, sizeof(flat.V)) != 0 || flat.I != nested.I || flat.pc != nested.pc ||
+        get_delay_timer(&flat) != get_delay_timer(&nested) || get_sound_timer(&flat) != get_sound_timer(&nested)) {
+        fprintf(stderr, "dispatch paths disagree on final state\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
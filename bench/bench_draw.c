@@ -0,0 +1,165 @@
+/**
+ * bench_draw.c
+ *
+ * Measures Dxyn throughput with the bit-packed framebuffer:
+ * - Packed: `draw_sprite` in display.c (one rotate, XOR and AND per row)
+ * - Bytewise: the previous one-byte-per-pixel loop (a modulo, a multiply
+ *   and a branch per pixel), kept here as the reference
+ *
+ * Both draw the same pseudo-random stream of sprites (positions anywhere on
+ * and past the screen, heights 1 to 15, random sprite bytes). The resulting
+ * framebuffers and collision flags are compared through `display_unpack`.
+ *
+ * Usage: bench_draw [passes]
+ */
+
+#include "bench.h"
+#include <stdlib.h>
+#include <string.h>
+
+#include "chip8.h"
+#include "display.h"
+
+#define STREAM_LENGTH 4096
+#define DEFAULT_PASSES 200
+
+typedef struct {
+    uint8_t x, y, height;
+    uint16_t sprite;                 // Offset of the sprite bytes in memory
+} Draw;
+
+static Draw stream[STREAM_LENGTH];
+
+/**
+ * Fills memory and the draw stream from a fixed-seed xorshift generator.
+ */
+static void build_stream(Chip8 *chip8) {
+    uint32_t state = 0x9E3779B9u;
+
+    for (uint32_t i = 0; i < MEMORY_SIZE; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        chip8->memory[i] = (uint8_t)(state >> 24);
+    }
+
+    for (uint32_t i = 0; i < STREAM_LENGTH; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+
+        stream[i].x = (uint8_t)state;
+        stream[i].y = (uint8_t)(state >> 8);
+        stream[i].height = 1 + (state >> 16) % 15;
+        stream[i].sprite = (uint16_t)((state >> 20) % (MEMORY_SIZE - 16));
+    }
+}
+
+/**
+ * Previous draw_sprite: one byte per pixel, every bit tested and wrapped.
+ */
+static int draw_bytewise(uint8_t *display, uint8_t x, uint8_t y, uint8_t height, const uint8_t *sprite) {
+    int collision = 0;
+
+    for (uint8_t row = 0; row < height; ++row) {
+        uint8_t sprite_byte = sprite[row];
+
+        for (uint8_t col = 0; col < 8; ++col) {
+            if ((sprite_byte & (0x80 >> col)) != 0) {
+                uint8_t px = (x + col) % DISPLAY_WIDTH;
+                uint8_t py = (y + row) % DISPLAY_HEIGHT;
+                uint16_t index = py * DISPLAY_WIDTH + px;
+
+                if (display[index] == 1)
+                    collision = 1;
+
+                display[index] ^= 1;
+            }
+        }
+    }
+
+    return collision;
+}
+
+/**
+ * Draws the whole stream `passes` times with the packed framebuffer.
+ *
+ * @return Number of draws that reported a collision (keeps the work observable).
+ */
+static uint32_t run_packed(Chip8 *chip8, int passes) {
+    uint32_t collisions = 0;
+
+    for (int p = 0; p < passes; p++) {
+        for (uint32_t i = 0; i < STREAM_LENGTH; i++) {
+            const Draw *d = &stream[i];
+            chip8->I = d->sprite;
+            collisions += (uint32_t)draw_sprite(chip8, d->x, d->y, d->height, &chip8->memory[d->sprite]);
+        }
+    }
+    return collisions;
+}
+
+/**
+ * Draws the whole stream `passes` times with the bytewise reference.
+ */
+static uint32_t run_bytewise(const Chip8 *chip8, uint8_t *display, int passes) {
+    uint32_t collisions = 0;
+
+    for (int p = 0; p < passes; p++) {
+        for (uint32_t i = 0; i < STREAM_LENGTH; i++) {
+            const Draw *d = &stream[i];
+            collisions += (uint32_t)draw_bytewise(display, d->x, d->y, d->height, &chip8->memory[d->sprite]);
+        }
+    }
+    return collisions;
+}
+
+int main(int argc, char *argv[]) {
+    int passes = argc > 1 ? atoi(argv[1]) : DEFAULT_PASSES;
+    if (passes <= 0) {
+        fprintf(stderr, "Usage: %s [passes]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    static Chip8 chip8;
+    static uint8_t bytewise[DISPLAY_WIDTH * DISPLAY_HEIGHT];
+    static uint8_t unpacked[DISPLAY_WIDTH * DISPLAY_HEIGHT];
+
+    chip8_init(&chip8);
+    build_stream(&chip8);
+
+    uint64_t draws = (uint64_t)STREAM_LENGTH * (uint64_t)passes;
+    double best_packed = 0, best_bytewise = 0;
+    uint32_t hits_packed = 0, hits_bytewise = 0;
+
+    printf("draw: %d sprites x %d passes (best of %d)\n", STREAM_LENGTH, passes, BENCH_REPEATS);
+
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        // Same starting screen for every run of both variants
+        memset(chip8.display, 0, sizeof(chip8.display));
+        memset(bytewise, 0, sizeof(bytewise));
+
+        double start = bench_now();
+        hits_packed = run_packed(&chip8, passes);
+        double elapsed = bench_now() - start;
+        if (r == 0 || elapsed < best_packed) best_packed = elapsed;
+
+        start = bench_now();
+        hits_bytewise = run_bytewise(&chip8, bytewise, passes);
+        elapsed = bench_now() - start;
+        if (r == 0 || elapsed < best_bytewise) best_bytewise = elapsed;
+    }
+
+    bench_report("packed rows", draws, best_packed);
+    bench_report("byte per pixel", draws, best_bytewise);
+    printf("speedup: %.2fx\n", best_bytewise / best_packed);
+
+    // Both layouts must produce the same screen and the same collisions
+    display_unpack(chip8.display, unpacked);
+    if (hits_packed != hits_bytewise || memcmp(unpacked, bytewise, sizeof(bytewise)) != 0) {
+        fprintf(stderr, "packed and bytewise framebuffers differ\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
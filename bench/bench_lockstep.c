@@ -0,0 +1,234 @@
+/**
+ * bench_lockstep.c
+ *
+ * Compares the lockstep engine (lockstep.c) with stepping the same lanes
+ * one `chip8_cycle` at a time, and checks that every lane ends in the same
+ * state (machine state and framebuffer hashes from farm.c).
+ *
+ * Workloads:
+ * - synthetic: a generated program of ALU, skip, jump and load opcodes
+ *   (including x or y = F) on lanes with random registers, so the kernels
+ *   are checked against the handlers on diverging lanes
+ * - each ROM with the same keys on every lane (lanes never diverge) and
+ *   with seeded random keys per lane (lanes diverge on input)
+ *
+ * Each workload runs BENCH_REPEATS times on both sides, from power-on, and
+ * the fastest run of each is reported.
+ *
+ * Keys change once per frame of CYCLES_PER_FRAME instructions. Every lane
+ * keeps the default Cxkk seed, so ROMs that use Cxkk draw the same numbers
+ * on both sides whatever order the engine runs lanes in.
+ *
+ * Usage: bench_lockstep [lanes] [frames] [ROM...]
+ */
+
+#include "bench.h"
+#include <stdlib.h>
+#include <string.h>
+
+#include "chip8.h"
+#include "farm.h"
+#include "lockstep.h"
+
+#define DEFAULT_LANES 256
+#define DEFAULT_FRAMES 600
+#define SYNTHETIC_LENGTH 1024        // Instructions in the generated program
+#define KEY_SEED 0x2545F491u
+
+// Input given to the lanes of one workload
+typedef enum {
+    INPUT_NONE,                      // Keypad never pressed
+    INPUT_SAME,                      // One key sequence for all lanes
+    INPUT_PER_LANE                   // A different key sequence per lane
+} InputMode;
+
+/**
+ * Advances a xorshift32 generator.
+ */
+static uint32_t next_random(uint32_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+/**
+ * Writes the synthetic program to the ROM image: random register opcodes,
+ * forward skips and an occasional jump back to the start.
+ */
+static void build_synthetic(uint8_t *memory) {
+    static const uint16_t templates[] = {
+        0x3000, 0x4000, 0x5000, 0x6000, 0x7000, 0x7000,
+        0x8000, 0x8001, 0x8002, 0x8003, 0x8004, 0x8005, 0x8006, 0x8007, 0x800E,
+        0x9000, 0xA000, 0x8F04, 0x80F5, 0x8FF7,
+    };
+    static const uint16_t operand_masks[] = {
+        0x0FFF, 0x0FFF, 0x0FF0, 0x0FFF, 0x0FFF, 0x0FFF,
+        0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0,
+        0x0FF0, 0x0FFF, 0x00F0, 0x0F00, 0x0000,
+    };
+    const uint32_t count = sizeof(templates) / sizeof(templates[0]);
+    uint32_t state = 0x12345678u;
+
+    for (uint32_t i = 0; i < SYNTHETIC_LENGTH; i++) {
+        uint32_t r = next_random(&state);
+        uint32_t pick = (r >> 8) % count;
+        uint16_t opcode = templates[pick] | ((uint16_t)(r >> 16) & operand_masks[pick]);
+
+        if (i == SYNTHETIC_LENGTH - 1 || r % 97 == 0) opcode = 0x1200;
+        memory[0x200 + 2 * i] = (uint8_t)(opcode >> 8);
+        memory[0x200 + 2 * i + 1] = (uint8_t)opcode;
+    }
+}
+
+/**
+ * Puts a lane at power-on with the workload's program and, for the
+ * synthetic program, random registers.
+ */
+static void prepare_lane(Chip8 *chip8, const char *rom, uint32_t lane) {
+    chip8_reset(chip8);
+    if (rom) {
+        chip8_load_rom(chip8, rom);
+        return;
+    }
+
+    build_synthetic(chip8->memory);
+    uint32_t state = 0x9E3779B9u * (lane + 1);
+    for (int r = 0; r < REGISTER_COUNT; r++) chip8->V[r] = (uint8_t)next_random(&state);
+    chip8->I = (uint16_t)(next_random(&state) & 0x0FFF);
+}
+
+/**
+ * Sets one lane's keypad for the next frame: with probability 1/8 a random
+ * key is pressed, otherwise every key is up.
+ */
+static void set_keys(Chip8 *chip8, uint32_t *state) {
+    uint32_t r = next_random(state);
+    memset(chip8->keypad, 0, KEYPAD_SIZE);
+    if ((r & 7) == 0) chip8->keypad[(r >> 3) & 0xF] = 1;
+}
+
+/**
+ * Applies the frame's keys to every lane.
+ */
+static void frame_keys(Chip8 *lanes, uint32_t count, InputMode input, uint32_t *states) {
+    if (input == INPUT_NONE) return;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (input == INPUT_SAME && i > 0) {
+            memcpy(lanes[i].keypad, lanes[0].keypad, KEYPAD_SIZE);
+        } else {
+            set_keys(&lanes[i], &states[i]);
+        }
+    }
+}
+
+/**
+ * Runs one workload both ways, reports both rates and compares the lanes.
+ *
+ * @return Number of lanes whose final state differs.
+ */
+static uint32_t run_workload(const char *name, const char *rom, InputMode input, uint32_t lanes, uint32_t frames) {
+    Lockstep ls;
+    Chip8 *reference = malloc(lanes * sizeof(Chip8));
+    uint32_t *states = malloc(lanes * sizeof(uint32_t));
+    uint32_t mismatches = 0;
+
+    if (!reference || !states || !lockstep_init(&ls, lanes)) {
+        fprintf(stderr, "Out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    double scalar_seconds = 0.0;
+    double lockstep_seconds = 0.0;
+    uint64_t ops = 0;
+
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        // Reference: every lane one chip8_cycle at a time, lanes in order
+        for (uint32_t i = 0; i < lanes; i++) {
+            if (r == 0) chip8_init(&reference[i]);
+            prepare_lane(&reference[i], rom, i);
+            states[i] = KEY_SEED + i;
+        }
+        double start = bench_now();
+        for (uint32_t f = 0; f < frames; f++) {
+            frame_keys(reference, lanes, input, states);
+            for (uint32_t c = 0; c < CYCLES_PER_FRAME; c++) {
+                for (uint32_t i = 0; i < lanes; i++) chip8_cycle(&reference[i]);
+            }
+        }
+        double elapsed = bench_now() - start;
+        if (r == 0 || elapsed < scalar_seconds) scalar_seconds = elapsed;
+
+        // Lockstep
+        if (rom && lockstep_load_rom(&ls, rom)) {
+            fprintf(stderr, "Failed to load ROM: %s\n", rom);
+            exit(EXIT_FAILURE);
+        }
+        for (uint32_t i = 0; i < lanes; i++) {
+            if (!rom) prepare_lane(&ls.vm[i], NULL, i);
+            states[i] = KEY_SEED + i;
+        }
+        if (!rom) lockstep_invalidate(&ls, 0x200, 2 * SYNTHETIC_LENGTH);
+        ls.simd_ops = ls.list_ops = ls.handler_ops = ls.cycle_ops = 0;
+        start = bench_now();
+        for (uint32_t f = 0; f < frames; f++) {
+            frame_keys(ls.vm, lanes, input, states);
+            lockstep_run(&ls, CYCLES_PER_FRAME);
+        }
+        elapsed = bench_now() - start;
+        if (r == 0 || elapsed < lockstep_seconds) lockstep_seconds = elapsed;
+        ops = ls.simd_ops + ls.list_ops + ls.handler_ops + ls.cycle_ops;
+    }
+
+    for (uint32_t i = 0; i < lanes; i++) {
+        if (farm_state_hash(&ls.vm[i]) != farm_state_hash(&reference[i]) ||
+            farm_display_hash(&ls.vm[i]) != farm_display_hash(&reference[i])) {
+            if (mismatches == 0) fprintf(stderr, "%s: lane %u differs from chip8_cycle\n", name, i);
+            mismatches++;
+        }
+    }
+
+    printf("%-28s %10.1f %10.1f %7.2fx %6.1f%% %6.1f%% %s\n", name, (double)ops / scalar_seconds / 1e6,
+           (double)ops / lockstep_seconds / 1e6, scalar_seconds / lockstep_seconds,
+           ops ? 100.0 * (double)ls.simd_ops / (double)ops : 0.0,
+           ops ? 100.0 * (double)ls.list_ops / (double)ops : 0.0, mismatches ? "MISMATCH" : "ok");
+
+    lockstep_free(&ls);
+    free(reference);
+    free(states);
+    return mismatches;
+}
+
+int main(int argc, char *argv[]) {
+    static const char *input_names[] = { "", " same keys", " per-lane keys" };
+    uint32_t lanes = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : DEFAULT_LANES;
+    uint32_t frames = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : DEFAULT_FRAMES;
+    uint32_t mismatches = 0;
+    char name[64];
+
+    if (lanes == 0 || frames == 0) {
+        fprintf(stderr, "Usage: %s [lanes] [frames] [ROM...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("%u lanes, %u frames of %d instructions\n", lanes, frames, CYCLES_PER_FRAME);
+    printf("%-28s %10s %10s %8s %7s %7s\n", "workload", "scalar M/s", "lockstep", "speedup", "simd", "list");
+
+    mismatches += run_workload("synthetic", NULL, INPUT_NONE, lanes, frames);
+    for (int a = 3; a < argc; a++) {
+        const char *base = strrchr(argv[a], '/');
+        base = base ? base + 1 : argv[a];
+
+        for (int mode = INPUT_SAME; mode <= INPUT_PER_LANE; mode++) {
+            snprintf(name, sizeof(name), "%.14s%s", base, input_names[mode]);
+            mismatches += run_workload(name, argv[a], (InputMode)mode, lanes, frames);
+        }
+    }
+
+    if (mismatches) {
+        fprintf(stderr, "%u lanes differ from chip8_cycle\n", mismatches);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,390 @@
+/**
+ * bench_opcodes.c
+ *
+ * Times every leaf handler in opcodes.c in isolation, then the cost of
+ * reaching them through the dispatch tables.
+ *
+ * Each sample restores a machine state drawn from a pool of random states
+ * (registers, I, memory, framebuffer, keys, stack) and then times a batch
+ * of calls to one handler. The batch uses operands drawn from the same
+ * fixed-seed xorshift generator. The restore is not timed. After warmup
+ * samples, outliers are dropped with Tukey fences (outside 1.5 IQR of the
+ * quartiles), and the median and mean of the remaining samples are
+ * reported per call.
+ *
+ * Ticks are TSC cycles where rdtsc is available (x86 with GCC or Clang),
+ * otherwise nanoseconds from clock_gettime. The cost of the timing loop
+ * itself (an empty handler called the same way) is reported first and
+ * subtracted in the `net` column.
+ *
+ * Dispatch overhead: a mixed stream of every handler runs three ways:
+ * direct calls to the pre-resolved handlers, `dispatch_opcode` (flat
+ * table) and `dispatch_opcode_nested` (two-level tables). The difference to
+ * the direct calls is the cost of dispatching.
+ *
+ * Usage: bench_opcodes [samples] [seed]
+ */
+
+#include "bench.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(__EMSCRIPTEN__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#endif
+
+#include "chip8.h"
+#include "dispatch.h"
+#include "opcodes.h"
+
+#define DEFAULT_SAMPLES 2000
+#define DEFAULT_SEED 0x12345678u
+#define WARMUP_SAMPLES 200           // Timed but discarded (caches, branch predictors, clocks)
+#define BATCH 64                     // Calls per sample
+#define STATE_POOL 64                // Distinct random machine states
+#define CALIBRATION_SECONDS 0.05
+
+// A leaf handler and the operand bits randomized in its opcodes
+typedef struct {
+    const char *name;
+    OpcodeHandler handler;
+    uint16_t opcode;                 // Template
+    uint16_t operand_mask;           // Bits replaced by random operands
+    uint8_t batch;                   // Calls per sample (stack handlers stop at STACK_SIZE)
+} OpcodeBench;
+
+static const OpcodeBench handlers[] = {
+    { "00E0", op_00E0, 0x00E0, 0x0000, BATCH },
+    { "00EE", op_00EE, 0x00EE, 0x0000, STACK_SIZE },
+    { "1nnn", op_1nnn, 0x1000, 0x0FFF, BATCH },
+    { "2nnn", op_2nnn, 0x2000, 0x0FFF, STACK_SIZE },
+    { "3xkk", op_3xkk, 0x3000, 0x0FFF, BATCH },
+    { "4xkk", op_4xkk, 0x4000, 0x0FFF, BATCH },
+    { "5xy0", op_5xy0, 0x5000, 0x0FF0, BATCH },
+    { "6xkk", op_6xkk, 0x6000, 0x0FFF, BATCH },
+    { "7xkk", op_7xkk, 0x7000, 0x0FFF, BATCH },
+    { "8xy0", op_8xy0, 0x8000, 0x0FF0, BATCH },
+    { "8xy1", op_8xy1, 0x8001, 0x0FF0, BATCH },
+    { "8xy2", op_8xy2, 0x8002, 0x0FF0, BATCH },
+    { "8xy3", op_8xy3, 0x8003, 0x0FF0, BATCH },
+    { "8xy4", op_8xy4, 0x8004, 0x0FF0, BATCH },
+    { "8xy5", op_8xy5, 0x8005, 0x0FF0, BATCH },
+    { "8xy6", op_8xy6, 0x8006, 0x0FF0, BATCH },
+    { "8xy7", op_8xy7, 0x8007, 0x0FF0, BATCH },
+    { "8xyE", op_8xyE, 0x800E, 0x0FF0, BATCH },
+    { "9xy0", op_9xy0, 0x9000, 0x0FF0, BATCH },
+    { "Annn", op_Annn, 0xA000, 0x0FFF, BATCH },
+    { "Bnnn", op_Bnnn, 0xB000, 0x0FFF, BATCH },
+    { "Cxkk", op_Cxkk, 0xC000, 0x0FFF, BATCH },
+    { "Dxyn", op_Dxyn, 0xD000, 0x0FFF, BATCH },
+    { "Ex9E", op_Ex9E, 0xE09E, 0x0F00, BATCH },
+    { "ExA1", op_ExA1, 0xE0A1, 0x0F00, BATCH },
+    { "Fx07", op_Fx07, 0xF007, 0x0F00, BATCH },
+    { "Fx0A", op_Fx0A, 0xF00A, 0x0F00, BATCH },
+    { "Fx15", op_Fx15, 0xF015, 0x0F00, BATCH },
+    { "Fx18", op_Fx18, 0xF018, 0x0F00, BATCH },
+    { "Fx1E", op_Fx1E, 0xF01E, 0x0F00, BATCH },
+    { "Fx29", op_Fx29, 0xF029, 0x0F00, BATCH },
+    { "Fx33", op_Fx33, 0xF033, 0x0F00, BATCH },
+    { "Fx55", op_Fx55, 0xF055, 0x0F00, BATCH },
+    { "Fx65", op_Fx65, 0xF065, 0x0F00, BATCH },
+};
+
+#define HANDLER_COUNT (sizeof(handlers) / sizeof(handlers[0]))
+
+// Random machine state restored before each sample
+typedef struct {
+    uint8_t memory[MEMORY_SIZE];
+    uint8_t V[REGISTER_COUNT];
+    uint16_t I;
+    uint16_t pc;
+    uint16_t stack[STACK_SIZE];      // Return addresses (RET runs with a full stack)
+    uint64_t display[DISPLAY_HEIGHT];
+    uint8_t keypad[KEYPAD_SIZE];
+} BenchState;
+
+static BenchState pool[STATE_POOL];
+static uint16_t operands[STATE_POOL][BATCH];   // Random operand bits, one stream per state
+static uint32_t rng_state;
+
+// Per-call statistics of one measurement, in ticks
+typedef struct {
+    double median;
+    double mean;                     // Mean of the samples inside the fences
+    int rejected;                    // Samples outside the fences
+} Stats;
+
+/**
+ * Next value of the fixed-seed generator (xorshift32).
+ */
+static uint32_t next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/**
+ * Timestamp in ticks (TSC cycles, or nanoseconds without rdtsc).
+ */
+static inline uint64_t ticks(void) {
+#ifdef HAVE_RDTSC
+    _mm_lfence();                    // Keep earlier instructions out of the measured window
+    return __rdtsc();
+#else
+    return (uint64_t)(bench_now() * 1e9);
+#endif
+}
+
+/**
+ * Ticks per nanosecond, measured against the monotonic clock.
+ */
+static double calibrate(void) {
+    double start = bench_now();
+    uint64_t t0 = ticks();
+    while (bench_now() - start < CALIBRATION_SECONDS) { }
+    uint64_t t1 = ticks();
+    return (double)(t1 - t0) / ((bench_now() - start) * 1e9);
+}
+
+/**
+ * Fills the state pool and operand streams from the generator.
+ * I stays below 0xFF0 so `Fx33`/`Fx55`/`Fx65` remain inside memory.
+ */
+static void build_states(void) {
+    for (int s = 0; s < STATE_POOL; s++) {
+        BenchState *state = &pool[s];
+
+        for (int i = 0; i < MEMORY_SIZE; i++) state->memory[i] = (uint8_t)next_random();
+        for (int i = 0; i < REGISTER_COUNT; i++) state->V[i] = (uint8_t)next_random();
+        for (int i = 0; i < STACK_SIZE; i++) state->stack[i] = 0x200 + (next_random() & 0xDFE);
+        for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+            state->display[y] = ((uint64_t)next_random() << 32) | next_random();
+        }
+        for (int i = 0; i < KEYPAD_SIZE; i++) state->keypad[i] = (next_random() & 7) == 0;
+
+        state->I = 0x200 + next_random() % 0xDF0;
+        state->pc = 0x200 + (next_random() & 0xDFE);
+
+        for (int i = 0; i < BATCH; i++) operands[s][i] = (uint16_t)next_random();
+    }
+}
+
+/**
+ * Restores pool state `s`; `sp` is chosen by the caller (empty for CALL, full for RET).
+ */
+static void restore(Chip8 *chip8, int s, uint8_t sp) {
+    const BenchState *state = &pool[s];
+
+    memcpy(chip8->memory, state->memory, sizeof(chip8->memory));
+    memcpy(chip8->V, state->V, sizeof(chip8->V));
+    memcpy(chip8->stack, state->stack, sizeof(chip8->stack));
+    memcpy(chip8->display, state->display, sizeof(chip8->display));
+    memcpy(chip8->keypad, state->keypad, sizeof(chip8->keypad));
+    chip8->I = state->I;
+    chip8->pc = state->pc;
+    chip8->sp = sp;
+}
+
+/**
+ * Calls `handler` on each opcode of a batch and returns the elapsed ticks.
+ * Kept out of line so every handler is timed through the same loop.
+ */
+static __attribute__((noinline)) uint64_t time_batch(Chip8 *chip8, OpcodeHandler handler, const uint16_t *opcodes,
+                                                     int count) {
+    uint64_t start = ticks();
+    for (int i = 0; i < count; i++) handler(chip8, opcodes[i]);
+    return ticks() - start;
+}
+
+/**
+ * Mixed-stream variants for the dispatch comparison.
+ */
+static __attribute__((noinline)) uint64_t time_direct(Chip8 *chip8, const OpcodeHandler *resolved,
+                                                      const uint16_t *opcodes, int count) {
+    uint64_t start = ticks();
+    for (int i = 0; i < count; i++) resolved[i](chip8, opcodes[i]);
+    return ticks() - start;
+}
+
+static __attribute__((noinline)) uint64_t time_flat(Chip8 *chip8, const OpcodeHandler *resolved,
+                                                    const uint16_t *opcodes, int count) {
+    (void)resolved;
+    uint64_t start = ticks();
+    for (int i = 0; i < count; i++) dispatch_opcode(chip8, opcodes[i]);
+    return ticks() - start;
+}
+
+static __attribute__((noinline)) uint64_t time_nested(Chip8 *chip8, const OpcodeHandler *resolved,
+                                                      const uint16_t *opcodes, int count) {
+    (void)resolved;
+    uint64_t start = ticks();
+    for (int i = 0; i < count; i++) dispatch_opcode_nested(chip8, opcodes[i]);
+    return ticks() - start;
+}
+
+/**
+ * Handler that does nothing: the cost of the timing loop and the indirect call.
+ */
+static void op_empty(Chip8 *chip8, uint16_t opcode) {
+    (void)chip8;
+    (void)opcode;
+}
+
+/**
+ * qsort comparator: ascending ticks.
+ */
+static int compare_ticks(const void *a, const void *b) {
+    uint64_t ta = *(const uint64_t *)a, tb = *(const uint64_t *)b;
+    return (ta > tb) - (ta < tb);
+}
+
+/**
+ * Sorts the samples and summarizes the ones inside the Tukey fences.
+ *
+ * @param samples Ticks per sample (reordered).
+ * @param count   Number of samples.
+ * @param calls   Calls per sample, to report per-call figures.
+ */
+static Stats summarize(uint64_t *samples, int count, int calls) {
+    qsort(samples, (size_t)count, sizeof(samples[0]), compare_ticks);
+
+    double q1 = (double)samples[count / 4];
+    double q3 = (double)samples[(3 * count) / 4];
+    double low = q1 - 1.5 * (q3 - q1);
+    double high = q3 + 1.5 * (q3 - q1);
+
+    double sum = 0;
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        if ((double)samples[i] >= low && (double)samples[i] <= high) {
+            sum += (double)samples[i];
+            kept++;
+        }
+    }
+
+    return (Stats){
+        .median = (double)samples[count / 2] / calls,
+        .mean = kept ? sum / kept / calls : 0.0,
+        .rejected = count - kept,
+    };
+}
+
+/**
+ * Measures one handler over the state pool.
+ */
+static Stats measure_handler(Chip8 *chip8, const OpcodeBench *bench, uint64_t *samples, int sample_count) {
+    static uint16_t opcodes[STATE_POOL][BATCH];
+    const uint8_t sp = bench->handler == op_00EE ? STACK_SIZE : 0;
+
+    for (int s = 0; s < STATE_POOL; s++) {
+        for (int i = 0; i < bench->batch; i++) {
+            opcodes[s][i] = bench->opcode | (operands[s][i] & bench->operand_mask);
+        }
+    }
+
+    for (int n = -WARMUP_SAMPLES; n < sample_count; n++) {
+        int s = (n + WARMUP_SAMPLES) % STATE_POOL;
+        restore(chip8, s, sp);
+        uint64_t elapsed = time_batch(chip8, bench->handler, opcodes[s], bench->batch);
+        if (n >= 0) samples[n] = elapsed;
+    }
+
+    return summarize(samples, sample_count, bench->batch);
+}
+
+/**
+ * Measures a mixed stream of every handler through one of the time_* loops.
+ * CALL and RET are left out: a mixed stream would overflow or drain the stack.
+ */
+static Stats measure_mixed(Chip8 *chip8, uint64_t (*run)(Chip8 *, const OpcodeHandler *, const uint16_t *, int),
+                           uint64_t *samples, int sample_count) {
+    static uint16_t opcodes[STATE_POOL][BATCH];
+    static OpcodeHandler resolved[STATE_POOL][BATCH];
+    static bool built;
+
+    if (!built) {
+        for (int s = 0; s < STATE_POOL; s++) {
+            for (int i = 0; i < BATCH; i++) {
+                const OpcodeBench *bench;
+                do {
+                    bench = &handlers[next_random() % HANDLER_COUNT];
+                } while (bench->batch != BATCH);
+
+                opcodes[s][i] = bench->opcode | (operands[s][i] & bench->operand_mask);
+                resolved[s][i] = bench->handler;
+            }
+        }
+        built = true;
+    }
+
+    for (int n = -WARMUP_SAMPLES; n < sample_count; n++) {
+        int s = (n + WARMUP_SAMPLES) % STATE_POOL;
+        restore(chip8, s, 0);
+        uint64_t elapsed = run(chip8, resolved[s], opcodes[s], BATCH);
+        if (n >= 0) samples[n] = elapsed;
+    }
+
+    return summarize(samples, sample_count, BATCH);
+}
+
+/**
+ * Prints one result line.
+ */
+static void print_stats(const char *name, Stats stats, double overhead, double ticks_per_ns, int sample_count) {
+    printf("%-16s %9.2f %9.2f %9.2f %9.2f %6.1f%%\n", name, stats.median, stats.mean, stats.median - overhead,
+           stats.median / ticks_per_ns, 100.0 * stats.rejected / sample_count);
+}
+
+int main(int argc, char *argv[]) {
+    int sample_count = argc > 1 ? atoi(argv[1]) : DEFAULT_SAMPLES;
+    uint32_t seed = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : DEFAULT_SEED;
+    if (sample_count < 4 || seed == 0) {
+        fprintf(stderr, "Usage: %s [samples] [seed]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Headless instance; the handlers see no platform, so beeps and draws stay in memory
+    static Chip8 chip8;
+    uint64_t *samples = malloc((size_t)sample_count * sizeof(uint64_t));
+    if (!samples) {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    chip8_init(&chip8);
+    rng_state = seed;
+    chip8_seed(&chip8, seed);        // Cxkk
+    build_states();
+    double ticks_per_ns = calibrate();
+
+#ifdef HAVE_RDTSC
+    printf("opcodes: %d samples of up to %d calls, seed 0x%08X; ticks = TSC cycles (%.2f per ns)\n",
+           sample_count, BATCH, seed, ticks_per_ns);
+#else
+    printf("opcodes: %d samples of up to %d calls, seed 0x%08X; ticks = ns\n", sample_count, BATCH, seed);
+#endif
+    printf("%-16s %9s %9s %9s %9s %7s\n", "handler", "median", "mean", "net", "ns", "outlier");
+
+    const OpcodeBench empty = { "(empty)", op_empty, 0x0000, 0x0000, BATCH };
+    Stats loop = measure_handler(&chip8, &empty, samples, sample_count);
+    print_stats("(timing loop)", loop, loop.median, ticks_per_ns, sample_count);
+
+    for (size_t h = 0; h < HANDLER_COUNT; h++) {
+        Stats stats = measure_handler(&chip8, &handlers[h], samples, sample_count);
+        print_stats(handlers[h].name, stats, loop.median, ticks_per_ns, sample_count);
+    }
+
+    printf("\nDispatch, mixed stream (net = cost over direct calls)\n");
+    Stats direct = measure_mixed(&chip8, time_direct, samples, sample_count);
+    Stats flat = measure_mixed(&chip8, time_flat, samples, sample_count);
+    Stats nested = measure_mixed(&chip8, time_nested, samples, sample_count);
+
+    print_stats("direct call", direct, direct.median, ticks_per_ns, sample_count);
+    print_stats("flat table", flat, direct.median, ticks_per_ns, sample_count);
+    print_stats("two-level", nested, direct.median, ticks_per_ns, sample_count);
+
+    free(samples);
+    return EXIT_SUCCESS;
+}
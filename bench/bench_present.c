@@ -0,0 +1,108 @@
+/**
+ * bench_present.c
+ *
+ * Measures how many frames per second the SDL backend can present:
+ * - full screen: every row damaged (init, reset, full-screen effects)
+ * - sprite: 5 damaged rows (a typical single-sprite frame)
+ * - one row: a single damaged row
+ *
+ * Each present expands the damaged rows into the ARGB streaming texture and
+ * does one scaled copy to the window (see platform_sdl.c). The frames are
+ * pseudo-random, so every present uploads new pixels.
+ *
+ * Runs without a display: unless set in the environment, the dummy video
+ * and audio drivers and the software renderer are selected, with vsync off.
+ *
+ * Usage: bench_present [presents]
+ */
+
+#include "bench.h"
+#include <stdlib.h>
+#include <SDL.h>
+
+#include "chip8.h"
+#include "platform.h"
+
+#define DEFAULT_PRESENTS 5000
+#define FRAME_COUNT 64               // Distinct frames cycled through
+
+static uint64_t frames[FRAME_COUNT][DISPLAY_HEIGHT];
+
+/**
+ * Fills the frames from a fixed-seed xorshift generator.
+ */
+static void build_frames(void) {
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+
+    for (int f = 0; f < FRAME_COUNT; f++) {
+        for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            frames[f][y] = state;
+        }
+    }
+}
+
+/**
+ * Times `presents` presents with the damage mask chosen by `damage_for`.
+ *
+ * @return Duration of the fastest of BENCH_REPEATS runs, in seconds.
+ */
+static double run(const Platform *platform, uint32_t (*damage_for)(int), int presents) {
+    double best = 0;
+
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        double start = bench_now();
+        for (int i = 0; i < presents; i++) {
+            platform_update_rows(platform, frames[i % FRAME_COUNT], damage_for(i));
+        }
+        double elapsed = bench_now() - start;
+
+        if (r == 0 || elapsed < best) best = elapsed;
+    }
+
+    return best;
+}
+
+static uint32_t damage_all(int i) { (void)i; return PLATFORM_ALL_ROWS; }
+static uint32_t damage_sprite(int i) { return 0x1Fu << (i % (DISPLAY_HEIGHT - 4)); }
+static uint32_t damage_row(int i) { return 1u << (i % DISPLAY_HEIGHT); }
+
+/**
+ * Prints one result line: time per present and presents per second.
+ */
+static void report(const char *name, int presents, double seconds) {
+    printf("%-20s %8.2f us/present %10.0f presents/s\n", name, seconds * 1e6 / presents, presents / seconds);
+}
+
+int main(int argc, char *argv[]) {
+    int presents = argc > 1 ? atoi(argv[1]) : DEFAULT_PRESENTS;
+    if (presents <= 0) {
+        fprintf(stderr, "Usage: %s [presents]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Headless SDL; an explicit environment setting wins
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+    SDL_setenv("SDL_RENDER_DRIVER", "software", 0);
+    SDL_setenv("SDL_RENDER_VSYNC", "0", 0);
+
+    Platform platform;
+    if (!platform_sdl_init(&platform)) return EXIT_FAILURE;
+
+    build_frames();
+    printf("present: %d presents (best of %d)\n", presents, BENCH_REPEATS);
+
+    double t_all = run(&platform, damage_all, presents);
+    double t_sprite = run(&platform, damage_sprite, presents);
+    double t_row = run(&platform, damage_row, presents);
+
+    report("full screen", presents, t_all);
+    report("sprite (5 rows)", presents, t_sprite);
+    report("one row", presents, t_row);
+
+    platform_quit(&platform);
+    return EXIT_SUCCESS;
+}
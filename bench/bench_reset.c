@@ -0,0 +1,102 @@
+/**
+ * bench_reset.c
+ *
+ * Measures the cost of returning a VM to its power-on state, as done once
+ * per run by fuzzers and batch testers:
+ * - chip8_init: clears the whole structure, including the decode cache
+ * - chip8_reset: clears the power-on state and only the decoded range
+ *
+ * Each variant is measured on its own and after running a short program
+ * (a sprite-drawing loop), so the decode cache has entries to drop. The
+ * reset instance is then checked against a freshly initialized one.
+ *
+ * Usage: bench_reset [iterations]
+ */
+
+#include "bench.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "chip8.h"
+
+#define DEFAULT_ITERATIONS 200000
+#define RUN_CYCLES 64                // Instructions executed before each reset
+
+// Sprite-drawing loop: draws font glyphs across the screen
+static const uint8_t program[] = {
+    0x60, 0x00,    // 200: LD V0, 0x00
+    0x61, 0x00,    // 202: LD V1, 0x00
+    0xF0, 0x29,    // 204: LD F, V0
+    0xD1, 0x15,    // 206: DRW V1, V1, 5
+    0x70, 0x01,    // 208: ADD V0, 0x01
+    0x71, 0x05,    // 20A: ADD V1, 0x05
+    0x12, 0x04,    // 20C: JP 0x204
+};
+
+/**
+ * Copies the program to 0x200 and runs it for RUN_CYCLES instructions.
+ */
+static void run_program(Chip8 *chip8) {
+    memcpy(&chip8->memory[0x200], program, sizeof(program));
+    chip8_run(chip8, RUN_CYCLES);
+}
+
+/**
+ * Times `iterations` calls of `reset`, optionally running the program first.
+ *
+ * @return Duration of the fastest of BENCH_REPEATS runs, in seconds.
+ */
+static double run(Chip8 *chip8, void (*reset)(Chip8 *), bool with_program, int iterations) {
+    double best = 0;
+
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        double start = bench_now();
+        for (int i = 0; i < iterations; i++) {
+            if (with_program) run_program(chip8);
+            reset(chip8);
+        }
+        double elapsed = bench_now() - start;
+
+        if (r == 0 || elapsed < best) best = elapsed;
+    }
+
+    return best;
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = argc > 1 ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0) {
+        fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Headless instances: no platform is attached, so nothing leaves the process
+    static Chip8 chip8, fresh;
+    chip8_init(&chip8);
+
+    printf("reset: %d iterations (best of %d)\n", iterations, BENCH_REPEATS);
+
+    double t_init = run(&chip8, chip8_init, false, iterations);
+    double t_reset = run(&chip8, chip8_reset, false, iterations);
+    double t_run_init = run(&chip8, chip8_init, true, iterations);
+    double t_run_reset = run(&chip8, chip8_reset, true, iterations);
+
+    bench_report("chip8_init", (uint64_t)iterations, t_init);
+    bench_report("chip8_reset", (uint64_t)iterations, t_reset);
+    bench_report("run + chip8_init", (uint64_t)iterations, t_run_init);
+    bench_report("run + chip8_reset", (uint64_t)iterations, t_run_reset);
+
+    // A reset after running must be indistinguishable from a fresh instance
+    run_program(&chip8);
+    chip8_reset(&chip8);
+    chip8_init(&fresh);
+
+    if (memcmp(&chip8, &fresh, offsetof(Chip8, cpu_hz)) != 0 ||
+        memcmp(chip8.decoded, fresh.decoded, sizeof(chip8.decoded)) != 0) {
+        fprintf(stderr, "chip8_reset does not restore the power-on state\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,126 @@
+/**
+ * bench_state.c
+ *
+ * Measures saving and restoring a snapshot (state.c), as done per step by
+ * rewind buffers and search:
+ * - chip8_save_state: serialize the machine state
+ * - chip8_load_state: restore it into the instance it came from, after
+ *   running on (only the framebuffer area and registers differ)
+ * - chip8_load_state, other program: every memory block differs, so every
+ *   decoded entry of the program is invalidated
+ *
+ * A restored instance is then checked against the one that was saved, and
+ * a corrupted snapshot must be rejected.
+ *
+ * Usage: bench_state [iterations] [ROM]
+ */
+
+#include "bench.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "chip8.h"
+#include "state.h"
+
+#define DEFAULT_ITERATIONS 200000
+#define DEFAULT_ROM "roms/BRIX"
+#define RUN_FRAMES 60                // Frames run before the snapshot is taken
+
+/**
+ * Whether two instances hold the same machine state (the part a snapshot
+ * covers; `draw_flag` is set by every load).
+ */
+static bool same_state(const Chip8 *a, const Chip8 *b) {
+    return memcmp(a->memory, b->memory, sizeof(a->memory)) == 0 && memcmp(a->V, b->V, sizeof(a->V)) == 0 &&
+           a->I == b->I && a->pc == b->pc && a->sp == b->sp && memcmp(a->stack, b->stack, sizeof(a->stack)) == 0 &&
+           a->cycles == b->cycles && a->idle_skipped == b->idle_skipped && a->delay_timer == b->delay_timer &&
+           a->sound_timer == b->sound_timer && a->delay_set_at == b->delay_set_at &&
+           a->sound_set_at == b->sound_set_at && a->rng == b->rng && a->key_wait == b->key_wait &&
+           a->sound_active == b->sound_active && memcmp(a->display, b->display, sizeof(a->display)) == 0 &&
+           memcmp(a->keypad, b->keypad, sizeof(a->keypad)) == 0 && a->key_event_count == b->key_event_count &&
+           a->key_event_next == b->key_event_next;
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = argc > 1 ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    const char *rom = argc > 2 ? argv[2] : DEFAULT_ROM;
+    if (iterations <= 0) {
+        fprintf(stderr, "Usage: %s [iterations] [ROM]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Headless instances: no platform is attached, so nothing leaves the process
+    static Chip8 chip8, saved, other;
+    static uint8_t snapshot[CHIP8_STATE_SIZE], other_snapshot[CHIP8_STATE_SIZE];
+
+    chip8_init(&chip8);
+    if (chip8_load_rom(&chip8, rom)) {
+        fprintf(stderr, "Failed to load ROM: %s\n", rom);
+        return EXIT_FAILURE;
+    }
+    for (int f = 0; f < RUN_FRAMES; f++) chip8_run_frame(&chip8);
+
+    // A second program, so that loading its snapshot changes every block
+    chip8_init(&other);
+    for (int addr = 0x200; addr < MEMORY_SIZE; addr++) other.memory[addr] = (uint8_t)(addr * 7);
+    chip8_save_state(&other, other_snapshot, sizeof(other_snapshot));
+
+    printf("state: %d iterations (best of %d), %d-byte snapshots of %s\n", iterations, BENCH_REPEATS,
+           CHIP8_STATE_SIZE, rom);
+
+    double t_save = 0, t_load = 0, t_other = 0;
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        double start = bench_now();
+        for (int i = 0; i < iterations; i++) chip8_save_state(&chip8, snapshot, sizeof(snapshot));
+        double elapsed = bench_now() - start;
+        if (r == 0 || elapsed < t_save) t_save = elapsed;
+
+        start = bench_now();
+        for (int i = 0; i < iterations; i++) chip8_load_state(&chip8, snapshot, sizeof(snapshot));
+        elapsed = bench_now() - start;
+        if (r == 0 || elapsed < t_load) t_load = elapsed;
+
+        start = bench_now();
+        for (int i = 0; i < iterations; i++) {
+            chip8_load_state(&chip8, (i & 1) ? snapshot : other_snapshot, sizeof(snapshot));
+        }
+        elapsed = bench_now() - start;
+        if (r == 0 || elapsed < t_other) t_other = elapsed;
+    }
+
+    bench_report("chip8_save_state", (uint64_t)iterations, t_save);
+    bench_report("chip8_load_state", (uint64_t)iterations, t_load);
+    bench_report("load, other program", (uint64_t)iterations, t_other);
+
+    // Run on, rewind, and run the same frames again: the result must match
+    chip8_load_state(&chip8, snapshot, sizeof(snapshot));
+    saved = chip8;
+    for (int f = 0; f < RUN_FRAMES; f++) chip8_run_frame(&chip8);
+    Chip8 *ahead = malloc(sizeof(Chip8));
+    if (!ahead) {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+    *ahead = chip8;
+
+    if (chip8_load_state(&chip8, snapshot, sizeof(snapshot)) != 0 || !same_state(&chip8, &saved)) {
+        fprintf(stderr, "chip8_load_state does not restore the saved state\n");
+        return EXIT_FAILURE;
+    }
+    for (int f = 0; f < RUN_FRAMES; f++) chip8_run_frame(&chip8);
+    if (!same_state(&chip8, ahead)) {
+        fprintf(stderr, "a restored instance does not replay the same frames\n");
+        return EXIT_FAILURE;
+    }
+    free(ahead);
+
+    // Any flipped byte must be caught by the checksum
+    snapshot[CHIP8_STATE_HEADER + 0x300] ^= 0x01;
+    if (chip8_load_state(&chip8, snapshot, sizeof(snapshot)) == 0) {
+        fprintf(stderr, "a corrupted snapshot was accepted\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,110 @@
+/**
+ * bench_vecenv.c
+ *
+ * Frames per second of the vectorized RL environment (env/vecenv.c):
+ * batches of random key masks on every ROM given, with each observation
+ * format, auto-reset and frame skip as an agent would use them.
+ *
+ * Usage: bench_vecenv [envs] [steps] [frame_skip] ROM...
+ */
+
+#include "bench.h"
+#include <stdlib.h>
+#include <string.h>
+
+#include "vecenv.h"
+
+#define DEFAULT_ENVS 256
+#define DEFAULT_STEPS 2000
+#define DEFAULT_FRAME_SKIP 4
+#define ACTION_SEED 0x2545F491u
+
+// Observation settings compared per ROM
+static const struct {
+    const char *name;
+    VecEnvObs obs;
+    uint32_t downsample;
+    bool flicker;
+} formats[] = {
+    { "packed", VECENV_OBS_PACKED, 1, false },
+    { "pixels/2", VECENV_OBS_PIXELS, 2, false },
+    { "pixels/1 flicker", VECENV_OBS_PIXELS, 1, true },
+};
+
+/**
+ * Advances a xorshift32 generator.
+ */
+static uint32_t next_random(uint32_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+int main(int argc, char *argv[]) {
+    uint32_t envs = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : DEFAULT_ENVS;
+    uint32_t steps = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : DEFAULT_STEPS;
+    uint32_t frame_skip = argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 0) : DEFAULT_FRAME_SKIP;
+
+    if (envs == 0 || steps == 0 || frame_skip == 0 || argc < 5) {
+        fprintf(stderr, "Usage: %s [envs] [steps] [frame_skip] ROM...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    uint16_t *actions = malloc(envs * sizeof(uint16_t));
+    uint32_t *seeds = malloc(envs * sizeof(uint32_t));
+    uint8_t *obs = malloc(envs * DISPLAY_HEIGHT * DISPLAY_WIDTH);
+    float *rewards = malloc(envs * sizeof(float));
+    uint8_t *dones = malloc(envs);
+    if (!actions || !seeds || !obs || !rewards || !dones) {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+    for (uint32_t i = 0; i < envs; i++) seeds[i] = i;
+
+    printf("%u envs, %u steps of %u frames\n", envs, steps, frame_skip);
+    printf("%-16s %-18s %12s %10s %9s\n", "rom", "observation", "M frames/s", "ns/frame", "episodes");
+
+    for (int a = 4; a < argc; a++) {
+        const char *base = strrchr(argv[a], '/');
+        base = base ? base + 1 : argv[a];
+
+        for (size_t m = 0; m < sizeof(formats) / sizeof(formats[0]); m++) {
+            VecEnvConfig config = {
+                .rom = argv[a], .count = envs, .obs = formats[m].obs, .downsample = formats[m].downsample,
+                .flicker = formats[m].flicker, .max_frames = 3600, .noop_max = 30, .skip_idle = true,
+            };
+            VecEnv env;
+            if (!vecenv_init(&env, &config)) return EXIT_FAILURE;
+
+            uint32_t state = ACTION_SEED;
+            uint64_t episodes = 0;
+            vecenv_reset(&env, seeds, obs);
+            uint64_t start_frames = env.total_frames;
+
+            double start = bench_now();
+            for (uint32_t s = 0; s < steps; s++) {
+                // Half the environments hold one random key
+                for (uint32_t i = 0; i < envs; i++) {
+                    uint32_t r = next_random(&state);
+                    actions[i] = (r & 1) ? (uint16_t)(1u << ((r >> 1) & 0xF)) : 0;
+                }
+                vecenv_step(&env, actions, frame_skip, obs, rewards, dones);
+                for (uint32_t i = 0; i < envs; i++) episodes += dones[i] != 0;
+            }
+            double seconds = bench_now() - start;
+            uint64_t frames = env.total_frames - start_frames;
+
+            printf("%-16.16s %-18s %12.2f %10.1f %9llu\n", base, formats[m].name, (double)frames / seconds / 1e6,
+                   seconds * 1e9 / (double)frames, (unsigned long long)episodes);
+            vecenv_free(&env);
+        }
+    }
+
+    free(actions);
+    free(seeds);
+    free(obs);
+    free(rewards);
+    free(dones);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,416 @@
+/**
+ * chip8_bench.c
+ *
+ * ROM-level throughput suite: runs each ROM headless for a fixed number of
+ * emulated instructions and reports instructions per second, ns per
+ * instruction, frames per second and the peak resident set size.
+ *
+ * Runs are reproducible: the VM's Cxkk generator is seeded with `--seed`
+ * before every run, and keys are pressed and released by a scripted input platform
+ * driven by the same seed, on a virtual 60Hz clock. Frames are presented to
+ * an in-memory framebuffer, so damage tracking is part of the measurement.
+ * Each ROM runs BENCH_REPEATS times and the fastest run is reported; a
+ * checksum of the final machine state shows that every run did the same work.
+ *
+ * Results are printed as a table and, with --json, written to a file. With
+ * --baseline, a file written by an earlier run is read back and every ROM
+ * whose instruction rate dropped by more than --threshold percent is
+ * reported as a regression (exit status 1).
+ *
+ * Usage:
+ *     chip8-bench [--cycles N] [--seed N] [--json FILE] [--baseline FILE]
+ *                 [--threshold PCT] [--jit] [--no-skip-idle] <ROM>...
+ */
+
+#include "bench.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "chip8.h"
+#include "jit.h"
+#include "display.h"
+#include "platform.h"
+
+#define DEFAULT_CYCLES 5000000         // Emulated instructions per ROM and run
+#define DEFAULT_SEED 1
+#define DEFAULT_THRESHOLD 5.0          // Percent slower than the baseline that fails
+#define FRAME_US (1000000 / 60)        // Virtual host time per input read
+#define MAX_ROMS 64
+#define NAME_MAX_LENGTH 32
+#define LINE_MAX_LENGTH 512
+
+// Scripted input: pseudo-random key taps on a virtual clock, plus the presented frame
+typedef struct {
+    uint32_t state;                  // xorshift state, seeded per run
+    uint64_t now_us;                 // Virtual host clock
+    int held;                        // Key being held, or -1
+    int hold_frames;                 // Reads left until it is released
+    uint64_t rows[DISPLAY_HEIGHT];   // Last presented framebuffer
+} BenchInput;
+
+// Result of one ROM
+typedef struct {
+    char name[NAME_MAX_LENGTH];
+    uint64_t instructions;           // Emulated instructions (including fast-forwarded ones)
+    uint64_t skipped;                // Of those, fast-forwarded in idle loops
+    uint64_t frames;
+    double seconds;                  // Fastest run
+    long peak_rss_kb;                // Process peak after the ROM's runs (0 if unknown)
+    uint32_t checksum;               // Final machine state
+} BenchResult;
+
+// ROM entry of a baseline file
+typedef struct {
+    char name[NAME_MAX_LENGTH];
+    double instructions_per_second;
+    uint32_t checksum;               // 0 if the file has none
+} BaselineEntry;
+
+/**
+ * Next value of the input generator (xorshift32).
+ */
+static uint32_t next_random(BenchInput *input) {
+    input->state ^= input->state << 13;
+    input->state ^= input->state >> 17;
+    input->state ^= input->state << 5;
+    return input->state;
+}
+
+/**
+ * One virtual frame of input: while no key is held, a random key is pressed
+ * with probability 1/8 and held for 1 to 8 frames. Events fall at a random
+ * point inside the frame, so they land mid-batch like host input does.
+ */
+static size_t scripted_read_input(void *ctx, InputEvent *events, size_t max, uint64_t *now_us) {
+    BenchInput *input = ctx;
+    uint64_t start = input->now_us;
+
+    input->now_us += FRAME_US;
+    *now_us = input->now_us;
+    if (max == 0) return 0;
+
+    uint64_t time_us = start + next_random(input) % FRAME_US;
+
+    if (input->held >= 0) {
+        if (--input->hold_frames > 0) return 0;
+        events[0] = (InputEvent){ .time_us = time_us, .key = (uint8_t)input->held, .down = false };
+        input->held = -1;
+        return 1;
+    }
+
+    uint32_t roll = next_random(input);
+    if (roll & 7) return 0;
+
+    input->held = (int)((roll >> 8) % KEYPAD_SIZE);
+    input->hold_frames = 1 + (int)((roll >> 16) % 8);
+    events[0] = (InputEvent){ .time_us = time_us, .key = (uint8_t)input->held, .down = true };
+    return 1;
+}
+
+/**
+ * Keeps a copy of the damaged rows, as a headless host would.
+ */
+static void scripted_update_rows(void *ctx, const uint64_t *rows, uint32_t damage) {
+    BenchInput *input = ctx;
+    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+        if (damage & (1u << y)) input->rows[y] = rows[y];
+    }
+}
+
+/**
+ * FNV-1a over the state a run leaves behind (memory, registers, screen, clock).
+ */
+static uint32_t state_checksum(const Chip8 *chip8) {
+    uint32_t hash = 2166136261u;
+    const struct { const void *data; size_t size; } parts[] = {
+        { chip8->memory, sizeof(chip8->memory) },
+        { chip8->V, sizeof(chip8->V) },
+        { &chip8->I, sizeof(chip8->I) },
+        { &chip8->pc, sizeof(chip8->pc) },
+        { &chip8->cycles, sizeof(chip8->cycles) },
+        { chip8->display, sizeof(chip8->display) },
+    };
+
+    for (size_t p = 0; p < sizeof(parts) / sizeof(parts[0]); p++) {
+        const uint8_t *bytes = parts[p].data;
+        for (size_t i = 0; i < parts[p].size; i++) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+/**
+ * Peak resident set size of the process.
+ *
+ * @return Kilobytes, or 0 where the host does not report it.
+ */
+static long peak_rss_kb(void) {
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;   // Bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+// Emulator options shared by every run
+typedef struct {
+    uint64_t cycles;
+    uint32_t seed;
+    bool jit;
+    bool skip_idle;
+} BenchConfig;
+
+/**
+ * Runs one ROM BENCH_REPEATS times and keeps the fastest run.
+ *
+ * @return 0 on success, -1 if the ROM cannot be loaded or runs diverge.
+ */
+static int bench_rom(const char *path, const BenchConfig *config, BenchResult *result) {
+    static Chip8 chip8;
+    static BenchInput input;
+    const Platform platform = {
+        .ctx = &input,
+        .read_input = scripted_read_input,
+        .update_rows = scripted_update_rows,
+    };
+
+    const char *name = strrchr(path, '/');
+    name = name ? name + 1 : path;
+    snprintf(result->name, sizeof(result->name), "%s", name);
+
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        chip8_init(&chip8);
+        chip8.platform = &platform;
+        chip8.skip_idle = config->skip_idle;
+        if (chip8_load_rom(&chip8, path)) {
+            fprintf(stderr, "Failed to load ROM: %s\n", path);
+            return -1;
+        }
+        if (config->jit) jit_enable(&chip8, JIT_HOT_THRESHOLD);
+
+        input = (BenchInput){ .state = config->seed * 2654435761u | 1, .held = -1 };
+        chip8_seed(&chip8, config->seed);
+
+        uint64_t frames = 0;
+        double start = bench_now();
+        while (chip8.cycles < config->cycles) {
+            Chip8Frame frame = chip8_run_frame(&chip8);
+            if (frame.draw) update_display(&chip8);
+            frames++;
+        }
+        double elapsed = bench_now() - start;
+
+        uint32_t checksum = state_checksum(&chip8);
+        if (config->jit) jit_disable(&chip8);
+
+        if (r > 0 && checksum != result->checksum) {
+            fprintf(stderr, "%s: run %d ended in a different state\n", result->name, r + 1);
+            return -1;
+        }
+        if (r == 0 || elapsed < result->seconds) result->seconds = elapsed;
+
+        result->instructions = chip8.cycles;
+        result->skipped = chip8.idle_skipped;
+        result->frames = frames;
+        result->checksum = checksum;
+    }
+
+    result->peak_rss_kb = peak_rss_kb();
+    return 0;
+}
+
+/**
+ * Emulated instructions per second of a result.
+ */
+static double instructions_per_second(const BenchResult *result) {
+    return result->seconds > 0 ? (double)result->instructions / result->seconds : 0.0;
+}
+
+/**
+ * Writes the results as JSON (one ROM object per line, read back by load_baseline).
+ *
+ * @return 0 on success, -1 if the file cannot be written.
+ */
+static int write_json(const char *path, const BenchConfig *config, const BenchResult *results, int count) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return -1;
+    }
+
+    fprintf(file, "{\n  \"cycles\": %llu,\n  \"seed\": %u,\n", (unsigned long long)config->cycles, config->seed);
+    fprintf(file, "  \"jit\": %s,\n  \"skip_idle\": %s,\n  \"roms\": [\n",
+            config->jit ? "true" : "false", config->skip_idle ? "true" : "false");
+
+    for (int i = 0; i < count; i++) {
+        const BenchResult *r = &results[i];
+        double ips = instructions_per_second(r);
+
+        fprintf(file,
+                "    {\"name\": \"%s\", \"instructions\": %llu, \"skipped\": %llu, \"frames\": %llu, "
+                "\"seconds\": %.6f, \"instructions_per_second\": %.0f, \"ns_per_instruction\": %.4f, "
+                "\"frames_per_second\": %.1f, \"peak_rss_kb\": %ld, \"checksum\": \"%08x\"}%s\n",
+                r->name, (unsigned long long)r->instructions, (unsigned long long)r->skipped,
+                (unsigned long long)r->frames, r->seconds, ips, ips > 0 ? 1e9 / ips : 0.0,
+                r->seconds > 0 ? (double)r->frames / r->seconds : 0.0, r->peak_rss_kb, r->checksum,
+                i + 1 < count ? "," : "");
+    }
+
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return 0;
+}
+
+/**
+ * Reads the per-ROM lines of a file written by write_json.
+ *
+ * @return Number of ROMs read, or -1 if the file cannot be opened.
+ */
+static int load_baseline(const char *path, BaselineEntry *baseline, int max) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Cannot open baseline %s\n", path);
+        return -1;
+    }
+
+    char line[LINE_MAX_LENGTH];
+    int count = 0;
+
+    while (count < max && fgets(line, sizeof(line), file)) {
+        const char *name = strstr(line, "\"name\": \"");
+        const char *ips = strstr(line, "\"instructions_per_second\": ");
+        const char *checksum = strstr(line, "\"checksum\": \"");
+        if (!name || !ips) continue;
+
+        BaselineEntry *b = &baseline[count];
+        *b = (BaselineEntry){0};
+        if (sscanf(name + 9, "%31[^\"]", b->name) != 1) continue;
+
+        b->instructions_per_second = strtod(ips + 27, NULL);
+        if (b->instructions_per_second <= 0) continue;
+        if (checksum) b->checksum = (uint32_t)strtoul(checksum + 13, NULL, 16);
+        count++;
+    }
+
+    fclose(file);
+    return count;
+}
+
+/**
+ * Compares the results with a baseline.
+ *
+ * @return Number of ROMs slower than the baseline by more than `threshold` percent.
+ */
+static int compare_baseline(const BenchResult *results, int count, const BaselineEntry *baseline, int baseline_count,
+                            double threshold) {
+    int regressions = 0;
+
+    printf("\n%-12s %14s %14s %9s\n", "ROM", "baseline M/s", "current M/s", "change");
+    for (int i = 0; i < count; i++) {
+        const BaselineEntry *b = NULL;
+        for (int k = 0; k < baseline_count && !b; k++) {
+            if (strcmp(baseline[k].name, results[i].name) == 0) b = &baseline[k];
+        }
+        if (!b) {
+            printf("%-12s %14s %14.1f %9s\n", results[i].name, "-", instructions_per_second(&results[i]) / 1e6, "new");
+            continue;
+        }
+
+        double before = b->instructions_per_second;
+        double now = instructions_per_second(&results[i]);
+        double change = (now - before) / before * 100.0;
+        bool regressed = change < -threshold;
+
+        printf("%-12s %14.1f %14.1f %+8.1f%%%s%s\n", results[i].name, before / 1e6, now / 1e6, change,
+               regressed ? "  REGRESSION" : "",
+               b->checksum && b->checksum != results[i].checksum ? "  (different final state)" : "");
+        regressions += regressed;
+    }
+
+    return regressions;
+}
+
+static const char usage[] =
+    "Usage: %s [--cycles N] [--seed N] [--json FILE] [--baseline FILE] [--threshold PCT] "
+    "[--jit] [--no-skip-idle] <ROM>...\n";
+
+int main(int argc, char *argv[]) {
+    BenchConfig config = { .cycles = DEFAULT_CYCLES, .seed = DEFAULT_SEED, .skip_idle = true };
+    const char *json = NULL;
+    const char *baseline_path = NULL;
+    double threshold = DEFAULT_THRESHOLD;
+    const char *roms[MAX_ROMS];
+    int rom_count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--cycles") == 0 && i + 1 < argc) {
+            config.cycles = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config.seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "--jit") == 0) {
+            config.jit = true;
+        } else if (strcmp(argv[i], "--no-skip-idle") == 0) {
+            config.skip_idle = false;
+        } else if (argv[i][0] != '-' && rom_count < MAX_ROMS) {
+            roms[rom_count++] = argv[i];
+        } else {
+            fprintf(stderr, usage, argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (rom_count == 0 || config.cycles == 0) {
+        fprintf(stderr, usage, argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    static BenchResult results[MAX_ROMS];
+    static BaselineEntry baseline[MAX_ROMS];
+
+    printf("chip8-bench: %llu instructions per ROM, seed %u, best of %d%s%s\n\n",
+           (unsigned long long)config.cycles, config.seed, BENCH_REPEATS, config.jit ? ", jit" : "",
+           config.skip_idle ? "" : ", no-skip-idle");
+    printf("%-12s %12s %10s %12s %8s %10s %9s\n", "ROM", "M instr/s", "ns/instr", "frames/s", "idle %", "peak RSS", "checksum");
+
+    for (int i = 0; i < rom_count; i++) {
+        BenchResult *r = &results[i];
+        if (bench_rom(roms[i], &config, r)) return EXIT_FAILURE;
+
+        double ips = instructions_per_second(r);
+        printf("%-12s %12.1f %10.3f %12.0f %7.1f%% %7ld KB  %08x\n", r->name, ips / 1e6, 1e9 / ips,
+               (double)r->frames / r->seconds, 100.0 * (double)r->skipped / (double)r->instructions,
+               r->peak_rss_kb, r->checksum);
+    }
+
+    if (json && write_json(json, &config, results, rom_count)) return EXIT_FAILURE;
+
+    if (baseline_path) {
+        int baseline_count = load_baseline(baseline_path, baseline, MAX_ROMS);
+        if (baseline_count < 0) return EXIT_FAILURE;
+
+        int regressions = compare_baseline(results, rom_count, baseline, baseline_count, threshold);
+        if (regressions) {
+            fprintf(stderr, "%d ROM(s) more than %.1f%% slower than %s\n", regressions, threshold, baseline_path);
+            return EXIT_FAILURE;
+        }
+        printf("No regressions beyond %.1f%% against %s\n", threshold, baseline_path);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,235 @@
+"""
+chip8_env.py
+
+Python binding of the vectorized RL environment (env/vecenv.c) over ctypes.
+
+One `reset` or `step` call runs every environment in C, including frame
+skip and auto-reset, and writes into buffers that are allocated once, so
+the Python cost is per batch rather than per frame. With numpy installed
+the results are numpy arrays viewing those buffers (no copies); without
+it they are memoryviews of the same shape. Either way, they are
+overwritten by the next call.
+
+Build the shared library first:
+    $ make env                      (build/libchip8env.so)
+
+Usage:
+    from chip8_env import Chip8VecEnv, register
+
+    env = Chip8VecEnv("roms/BRIX", count=256, downsample=2, rewards=[(register(0xE), 1.0)])
+    obs = env.reset(seeds=range(256))
+    obs, rewards, dones = env.step(actions, frame_skip=4)   # actions: key mask per env
+
+Run as a script for a throughput check:
+    $ python env/chip8_env.py roms/PONG [count] [steps] [frame_skip]
+"""
+
+import ctypes
+import os
+import random
+import sys
+import time
+
+try:
+    import numpy as np
+except ImportError:  # numpy is optional
+    np = None
+
+MEMORY_SIZE = 4096
+DISPLAY_WIDTH = 64
+DISPLAY_HEIGHT = 32
+MAX_REWARDS = 4
+
+# Observation formats (VecEnvObs)
+OBS_PACKED = 0
+OBS_PIXELS = 1
+
+# Bits of the done flags
+TERMINATED = 0x01
+TRUNCATED = 0x02
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_LIBRARY = os.path.join(SCRIPT_DIR, "..", "build", "libchip8env.so")
+
+
+def register(r: int) -> int:
+    """Probe address of register Vr (VECENV_REGISTER in vecenv.h)."""
+    return MEMORY_SIZE + r
+
+
+class _Reward(ctypes.Structure):
+    _fields_ = [("addr", ctypes.c_uint16), ("weight", ctypes.c_float)]
+
+
+class _Config(ctypes.Structure):
+    # Mirrors VecEnvConfig in include/vecenv.h
+    _fields_ = [
+        ("rom", ctypes.c_char_p),
+        ("count", ctypes.c_uint32),
+        ("obs", ctypes.c_int),
+        ("downsample", ctypes.c_uint32),
+        ("flicker", ctypes.c_bool),
+        ("rewards", _Reward * MAX_REWARDS),
+        ("reward_count", ctypes.c_uint32),
+        ("done_addr", ctypes.c_uint16),
+        ("done_value", ctypes.c_uint8),
+        ("max_frames", ctypes.c_uint32),
+        ("noop_max", ctypes.c_uint32),
+        ("skip_idle", ctypes.c_bool),
+    ]
+
+
+def _load_library(path: str) -> ctypes.CDLL:
+    lib = ctypes.CDLL(path)
+    lib.vecenv_create.argtypes = [ctypes.POINTER(_Config)]
+    lib.vecenv_create.restype = ctypes.c_void_p
+    lib.vecenv_destroy.argtypes = [ctypes.c_void_p]
+    lib.vecenv_destroy.restype = None
+    lib.vecenv_obs_size.argtypes = [ctypes.c_void_p]
+    lib.vecenv_obs_size.restype = ctypes.c_size_t
+    lib.vecenv_reset.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p]
+    lib.vecenv_reset.restype = None
+    lib.vecenv_step.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_uint32,
+                                ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p]
+    lib.vecenv_step.restype = None
+    return lib
+
+
+class Chip8VecEnv:
+    """
+    `count` copies of one ROM stepped together.
+
+    Args:
+        rom:        ROM file.
+        count:      Number of environments.
+        downsample: Observation block size (1, 2, 4 or 8): one byte per block,
+                    the share of lit pixels scaled to 0-255. None for the packed
+                    framebuffer (32 uint64 rows per environment, bit 63 = leftmost).
+        flicker:    OR the last two frames of a step into the observation.
+        rewards:    Up to 4 (address, weight) pairs: reward is weight times the
+                    signed change of the byte since the previous step. Addresses
+                    below 4096 are memory, register(r) is Vr.
+        done:       (address, value): the episode terminates when the byte reads value.
+        max_frames: Truncate episodes after this many frames (0 = never).
+        noop_max:   Up to this many keyless frames after each reset, picked by the seed.
+        library:    Path of libchip8env.so (default: $CHIP8_ENV_LIB or build/).
+    """
+
+    def __init__(self, rom, count, downsample=2, flicker=True, rewards=(), done=None, max_frames=0,
+                 noop_max=0, skip_idle=True, library=None):
+        if len(rewards) > MAX_REWARDS:
+            raise ValueError(f"at most {MAX_REWARDS} reward terms")
+
+        self._lib = _load_library(library or os.environ.get("CHIP8_ENV_LIB", DEFAULT_LIBRARY))
+        config = _Config(rom=os.fsencode(rom), count=count, obs=OBS_PACKED if downsample is None else OBS_PIXELS,
+                         downsample=downsample or 1, flicker=flicker, reward_count=len(rewards),
+                         max_frames=max_frames, noop_max=noop_max, skip_idle=skip_idle)
+        for t, (addr, weight) in enumerate(rewards):
+            config.rewards[t] = _Reward(addr, weight)
+        if done is not None:
+            config.done_addr, config.done_value = done
+
+        self._env = self._lib.vecenv_create(ctypes.byref(config))
+        if not self._env:
+            raise RuntimeError(f"cannot create environments for {rom}")
+
+        self.count = count
+        self.obs_size = self._lib.vecenv_obs_size(self._env)
+        if downsample is None:
+            self.obs_shape = (DISPLAY_HEIGHT,)
+            obs_format = "Q"
+        else:
+            self.obs_shape = (DISPLAY_HEIGHT // downsample, DISPLAY_WIDTH // downsample)
+            obs_format = "B"
+
+        # Buffers shared with C for the lifetime of the environment
+        self._obs = (ctypes.c_uint8 * (count * self.obs_size))()
+        self._rewards = (ctypes.c_float * count)()
+        self._dones = (ctypes.c_uint8 * count)()
+        self._actions = (ctypes.c_uint16 * count)()
+        self._seeds = (ctypes.c_uint32 * count)()
+
+        if np is not None:
+            dtype = np.uint64 if downsample is None else np.uint8
+            self.obs = np.frombuffer(self._obs, dtype=dtype).reshape((count,) + self.obs_shape)
+            self.rewards = np.frombuffer(self._rewards, dtype=np.float32)
+            self.dones = np.frombuffer(self._dones, dtype=np.uint8)
+        else:
+            self.obs = memoryview(self._obs).cast("B").cast(obs_format, (count,) + self.obs_shape)
+            self.rewards = memoryview(self._rewards).cast("B").cast("f")
+            self.dones = memoryview(self._dones).cast("B")
+
+    def reset(self, seeds=None):
+        """Start a new episode everywhere (seeds default to the indices); returns the observations."""
+        seeds_ptr = None
+        if seeds is not None:
+            for i, seed in enumerate(seeds):
+                self._seeds[i] = seed & 0xFFFFFFFF
+            seeds_ptr = self._seeds
+        self._lib.vecenv_reset(self._env, seeds_ptr, self._obs)
+        return self.obs
+
+    def step(self, actions, frame_skip=4):
+        """
+        Hold actions[i] (bit k = key k down) for frame_skip frames in every
+        environment; finished environments restart. Returns (obs, rewards, dones).
+        """
+        if np is not None and isinstance(actions, np.ndarray):
+            actions = np.ascontiguousarray(actions, dtype=np.uint16)
+            if actions.size != self.count:
+                raise ValueError(f"expected {self.count} actions")
+            actions_ptr = actions.ctypes.data
+        else:
+            if len(actions) != self.count:
+                raise ValueError(f"expected {self.count} actions")
+            for i, action in enumerate(actions):
+                self._actions[i] = action
+            actions_ptr = self._actions
+
+        self._lib.vecenv_step(self._env, actions_ptr, frame_skip, self._obs, self._rewards, self._dones)
+        return self.obs, self.rewards, self.dones
+
+    def close(self):
+        if self._env:
+            self._lib.vecenv_destroy(self._env)
+            self._env = None
+
+    def __del__(self):
+        self.close()
+
+
+def main() -> int:
+    if len(sys.argv) < 2:
+        print(f"Usage: {sys.argv[0]} ROM [count] [steps] [frame_skip]", file=sys.stderr)
+        return 1
+
+    rom = sys.argv[1]
+    count = int(sys.argv[2]) if len(sys.argv) > 2 else 256
+    steps = int(sys.argv[3]) if len(sys.argv) > 3 else 1000
+    frame_skip = int(sys.argv[4]) if len(sys.argv) > 4 else 4
+
+    env = Chip8VecEnv(rom, count, max_frames=3600, noop_max=30)
+    env.reset(range(count))
+
+    # A few batches of random single-key actions, drawn before timing
+    rng = random.Random(1)
+    batches = [[(1 << rng.randrange(16)) if rng.random() < 0.5 else 0 for _ in range(count)] for _ in range(16)]
+    if np is not None:
+        batches = [np.array(batch, dtype=np.uint16) for batch in batches]
+
+    episodes = 0
+    start = time.perf_counter()
+    for s in range(steps):
+        _, _, dones = env.step(batches[s % len(batches)], frame_skip)
+        episodes += sum(1 for d in dones if d)
+    seconds = time.perf_counter() - start
+
+    frames = steps * count * frame_skip
+    print(f"{count} envs x {steps} steps x {frame_skip} frames in {seconds:.3f} s: "
+          f"{frames / seconds / 1e6:.2f} M frames/s, {steps / seconds:.0f} steps/s, {episodes} episodes ended")
+    env.close()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
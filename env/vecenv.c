@@ -0,0 +1,403 @@
+/**
+ * vecenv.c
+ *
+ * Vectorized reinforcement-learning environment: N copies of one ROM
+ * stepped with one call, for agents that act on batches.
+ *
+ * `vecenv_step` takes one action per environment (a mask of held keys),
+ * runs `frame_skip` frames of each machine with `chip8_run_frame`, and
+ * writes the stacked observations, rewards and done flags into the
+ * caller's buffers. Finished environments are reset in the same call, so
+ * the host (e.g. env/chip8_env.py) pays its own overhead once per batch.
+ *
+ * - Observations: the packed framebuffer, or one byte per block of pixels.
+ *   With `flicker`, the last two frames are ORed, since CHIP-8 programs
+ *   erase and redraw sprites with XOR.
+ * - Rewards: the weighted change of up to VECENV_MAX_REWARDS bytes of memory
+ *   or registers (a score counter) since the previous step.
+ * - Done: a probe byte reaching a value (terminated), the PC leaving memory
+ *   (terminated) or `max_frames` (truncated). The observation returned for
+ *   a finished environment is the first one of its next episode.
+ * - Seeds: each episode has a seed, which seeds the VM's Cxkk generator and
+ *   picks the number of keyless frames run after the reset (`noop_max`).
+ *   The next episode's seed
+ *   follows from it, so a run depends only on the seeds given to
+ *   `vecenv_reset` and the actions.
+ *
+ * Environments share nothing but the ROM image; one VecEnv per thread
+ * scales across cores.
+ */
+
+#include "vecenv.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Seed of the episode after one with `seed` (LCG step).
+ */
+static uint32_t next_seed(uint32_t seed) {
+    return seed * 1664525u + 1013904223u;
+}
+
+/**
+ * Scrambles a seed so that neighbouring seeds pick unrelated no-op counts.
+ */
+static uint32_t mix_seed(uint32_t seed) {
+    seed ^= seed >> 16;
+    seed *= 0x85EBCA6Bu;
+    seed ^= seed >> 13;
+    seed *= 0xC2B2AE35u;
+    seed ^= seed >> 16;
+    return seed;
+}
+
+/**
+ * Reads a probe: a memory byte, or register Vr at VECENV_REGISTER(r).
+ */
+static inline uint8_t probe(const Chip8 *chip8, uint16_t addr) {
+    return addr < MEMORY_SIZE ? chip8->memory[addr] : chip8->V[addr - MEMORY_SIZE];
+}
+
+/**
+ * Bits of one block's field in `spread`: enough for block * block lit pixels.
+ */
+static uint32_t field_bits(uint32_t block) {
+    uint32_t bits = 1;
+    while ((1u << bits) <= block * block) bits++;
+    return bits;
+}
+
+/**
+ * Fills the tables that turn framebuffer bytes into pixel observations.
+ *
+ * A byte covers 8 / block blocks. `spread[byte]` counts the lit pixels of
+ * each in its own bit field, so the fields of the block's rows can simply
+ * be added. `pixels` maps every possible sum to the 8 / block observation
+ * bytes (lit share scaled to 0-255). The largest table is 16 KB (block 2).
+ *
+ * @return false if out of memory.
+ */
+static bool build_tables(VecEnv *env) {
+    const uint32_t block = env->config.downsample;
+    const uint32_t per_byte = 8 / block;
+    const uint32_t bits = field_bits(block);
+    const uint32_t sums = 1u << (bits * per_byte);
+
+    env->pixels = malloc((size_t)sums * per_byte);
+    if (!env->pixels) return false;
+
+    for (uint32_t byte = 0; byte < 256; byte++) {
+        uint32_t fields = 0;
+        for (uint32_t bit = 0; bit < 8; bit++) {
+            if (byte & (0x80u >> bit)) fields += 1u << (bits * (bit / block));
+        }
+        env->spread[byte] = (uint16_t)fields;
+    }
+    for (uint32_t sum = 0; sum < sums; sum++) {
+        for (uint32_t j = 0; j < per_byte; j++) {
+            uint32_t lit = (sum >> (bits * j)) & ((1u << bits) - 1);
+            if (lit > block * block) lit = block * block;  // Sums that never occur
+            env->pixels[sum * per_byte + j] = (uint8_t)(lit * 255 / (block * block));
+        }
+    }
+    return true;
+}
+
+/**
+ * Pixel observation with `block` x `block` blocks: per block row and
+ * framebuffer byte, the rows' `spread` fields are added and the sum is
+ * looked up in `pixels`. Inlined per block size so the copies have a
+ * constant length.
+ */
+static inline void write_pixels(const VecEnv *env, const uint64_t *shown, uint8_t *out, const uint32_t block) {
+    for (uint32_t y = 0; y < DISPLAY_HEIGHT; y += block) {
+        for (int c = 0; c < DISPLAY_WIDTH / 8; c++) {
+            uint32_t sum = 0;
+            for (uint32_t r = 0; r < block; r++) sum += env->spread[(shown[y + r] >> (56 - 8 * c)) & 0xFF];
+            memcpy(out, env->pixels + sum * (8 / block), 8 / block);
+            out += 8 / block;
+        }
+    }
+}
+
+/**
+ * Writes one environment's observation.
+ *
+ * @param shown Framebuffer to encode (the last frame, or the last two ORed).
+ */
+static void write_obs(const VecEnv *env, const uint64_t *shown, uint8_t *out) {
+    switch (env->config.obs == VECENV_OBS_PACKED ? 0 : env->config.downsample) {
+        case 0: memcpy(out, shown, DISPLAY_HEIGHT * sizeof(uint64_t)); break;
+        case 1: write_pixels(env, shown, out, 1); break;
+        case 2: write_pixels(env, shown, out, 2); break;
+        case 4: write_pixels(env, shown, out, 4); break;
+        default: write_pixels(env, shown, out, 8); break;
+    }
+}
+
+/**
+ * Encodes an environment's current observation, ORed with `previous` if given.
+ */
+static void observe(const VecEnv *env, uint32_t i, const uint64_t *previous, uint8_t *obs) {
+    if (!obs) return;
+
+    const Chip8 *vm = &env->vm[i];
+    uint8_t *out = obs + (size_t)i * env->obs_size;
+
+    if (!previous) {
+        write_obs(env, vm->display, out);
+        return;
+    }
+
+    uint64_t both[DISPLAY_HEIGHT];
+    for (int y = 0; y < DISPLAY_HEIGHT; y++) both[y] = vm->display[y] | previous[y];
+    write_obs(env, both, out);
+}
+
+/**
+ * Starts environment i's next episode: power-on reset, the ROM image back
+ * in memory, Cxkk seeded, then the seed's number of keyless frames.
+ */
+static void reset_env(VecEnv *env, uint32_t i, uint32_t seed) {
+    Chip8 *vm = &env->vm[i];
+
+    // chip8_reset also drops the decode cache, so the copied image is decoded afresh
+    chip8_reset(vm);
+    memcpy(vm->memory, env->image, MEMORY_SIZE);
+    chip8_seed(vm, seed);
+
+    env->seeds[i] = seed;
+    env->frames[i] = 0;
+
+    uint32_t noops = env->config.noop_max ? mix_seed(seed) % (env->config.noop_max + 1) : 0;
+    for (uint32_t f = 0; f < noops; f++) {
+        if (chip8_run_frame(vm).cycles == 0) break;
+        env->frames[i]++;
+    }
+    env->total_frames += env->frames[i];
+
+    for (uint32_t t = 0; t < env->config.reward_count; t++) {
+        env->probes[(size_t)i * VECENV_MAX_REWARDS + t] = probe(vm, env->config.rewards[t].addr);
+    }
+}
+
+/**
+ * Allocates `config->count` machines, loads the ROM once and keeps its
+ * memory image as the start of every episode.
+ *
+ * The environments are not started: call `vecenv_reset` first.
+ *
+ * @param env    Environment to set up.
+ * @param config Environment description (copied; `rom` is only read here).
+ * @return       false if the configuration is invalid, the ROM cannot be
+ *               loaded or memory runs out (a message is printed).
+ */
+bool vecenv_init(VecEnv *env, const VecEnvConfig *config) {
+    if (!env || !config || !config->rom) {
+        fprintf(stderr, "vecenv_init called with null pointer\n");
+        return false;
+    }
+
+    memset(env, 0, sizeof(VecEnv));
+
+    uint32_t block = config->downsample;
+    bool block_ok = block == 1 || block == 2 || block == 4 || block == 8;
+    if (config->count == 0 || config->reward_count > VECENV_MAX_REWARDS ||
+        (config->obs == VECENV_OBS_PIXELS && !block_ok) ||
+        (config->obs != VECENV_OBS_PACKED && config->obs != VECENV_OBS_PIXELS)) {
+        fprintf(stderr, "[VECENV] Invalid configuration\n");
+        return false;
+    }
+    for (uint32_t t = 0; t < config->reward_count; t++) {
+        if (config->rewards[t].addr >= VECENV_REGISTER(REGISTER_COUNT)) {
+            fprintf(stderr, "[VECENV] Reward probe 0x%X out of range\n", config->rewards[t].addr);
+            return false;
+        }
+    }
+    if (config->done_addr >= VECENV_REGISTER(REGISTER_COUNT)) {
+        fprintf(stderr, "[VECENV] Done probe 0x%X out of range\n", config->done_addr);
+        return false;
+    }
+
+    env->config = *config;
+    env->config.rom = NULL;
+    env->count = config->count;
+    env->obs_size = config->obs == VECENV_OBS_PACKED
+                  ? DISPLAY_HEIGHT * sizeof(uint64_t)
+                  : (size_t)(DISPLAY_WIDTH / block) * (DISPLAY_HEIGHT / block);
+
+    env->vm = malloc((size_t)env->count * sizeof(Chip8));
+    env->probes = calloc((size_t)env->count * VECENV_MAX_REWARDS, 1);
+    env->frames = calloc(env->count, sizeof(uint32_t));
+    env->seeds = calloc(env->count, sizeof(uint32_t));
+    if (!env->vm || !env->probes || !env->frames || !env->seeds) {
+        fprintf(stderr, "[VECENV] Out of memory\n");
+        vecenv_free(env);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < env->count; i++) {
+        chip8_init(&env->vm[i]);
+        env->vm[i].skip_idle = config->skip_idle;
+    }
+
+    if (chip8_load_rom(&env->vm[0], config->rom)) {
+        fprintf(stderr, "[VECENV] Failed to load ROM: %s\n", config->rom);
+        vecenv_free(env);
+        return false;
+    }
+    memcpy(env->image, env->vm[0].memory, MEMORY_SIZE);
+
+    if (config->obs == VECENV_OBS_PIXELS && !build_tables(env)) {
+        fprintf(stderr, "[VECENV] Out of memory\n");
+        vecenv_free(env);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Frees everything `vecenv_init` allocated.
+ *
+ * @param env Environment (may be partially initialized).
+ */
+void vecenv_free(VecEnv *env) {
+    if (!env) return;
+
+    free(env->vm);
+    free(env->probes);
+    free(env->frames);
+    free(env->seeds);
+    free(env->pixels);
+    memset(env, 0, sizeof(VecEnv));
+}
+
+/**
+ * Allocates and initializes an environment on the heap (for bindings that
+ * only hold a pointer, such as env/chip8_env.py).
+ *
+ * @param config Environment description.
+ * @return       The environment, or NULL on failure.
+ */
+VecEnv *vecenv_create(const VecEnvConfig *config) {
+    VecEnv *env = malloc(sizeof(VecEnv));
+    if (!env) {
+        fprintf(stderr, "[VECENV] Out of memory\n");
+        return NULL;
+    }
+    if (!vecenv_init(env, config)) {
+        free(env);
+        return NULL;
+    }
+    return env;
+}
+
+/**
+ * Frees an environment from `vecenv_create`.
+ *
+ * @param env Environment, or NULL.
+ */
+void vecenv_destroy(VecEnv *env) {
+    vecenv_free(env);
+    free(env);
+}
+
+/**
+ * Size of one environment's observation: 256 bytes packed, or
+ * (64 / downsample) * (32 / downsample) bytes.
+ *
+ * @param env Environment.
+ * @return    Bytes per environment in the `obs` buffers.
+ */
+size_t vecenv_obs_size(const VecEnv *env) {
+    if (!env) {
+        fprintf(stderr, "vecenv_obs_size called with null pointer\n");
+        return 0;
+    }
+    return env->obs_size;
+}
+
+/**
+ * Starts a new episode in every environment.
+ *
+ * @param env   Environment.
+ * @param seeds One seed per environment, or NULL to use the indices.
+ * @param obs   Receives count * obs_size bytes of first observations (may be NULL).
+ */
+void vecenv_reset(VecEnv *env, const uint32_t *seeds, uint8_t *obs) {
+    if (!env || !env->vm) {
+        fprintf(stderr, "vecenv_reset called with null pointer\n");
+        return;
+    }
+
+    for (uint32_t i = 0; i < env->count; i++) {
+        reset_env(env, i, seeds ? seeds[i] : i);
+        observe(env, i, NULL, obs);
+    }
+}
+
+/**
+ * Steps every environment.
+ *
+ * Environment i holds the keys of `actions[i]` (bit k = key k down) for
+ * `frame_skip` frames, stopping early when its episode ends. Its reward is
+ * the weighted change of the reward probes over the step. A finished
+ * environment is reset before the call returns, with the next seed, and its
+ * observation is the first of the new episode.
+ *
+ * @param env        Environment.
+ * @param actions    Key mask per environment.
+ * @param frame_skip Frames per step (at least 1).
+ * @param obs        Receives count * obs_size bytes (may be NULL).
+ * @param rewards    Receives one reward per environment (may be NULL).
+ * @param dones      Receives VECENV_TERMINATED/VECENV_TRUNCATED bits, 0 while running (may be NULL).
+ */
+void vecenv_step(VecEnv *env, const uint16_t *actions, uint32_t frame_skip, uint8_t *obs, float *rewards,
+                 uint8_t *dones) {
+    if (!env || !env->vm || !actions) {
+        fprintf(stderr, "vecenv_step called with null pointer\n");
+        return;
+    }
+    if (frame_skip == 0) frame_skip = 1;
+
+    const VecEnvConfig *config = &env->config;
+    uint64_t previous[DISPLAY_HEIGHT];
+
+    for (uint32_t i = 0; i < env->count; i++) {
+        Chip8 *vm = &env->vm[i];
+        uint8_t done = 0;
+        uint32_t f;
+
+        for (int k = 0; k < KEYPAD_SIZE; k++) vm->keypad[k] = (actions[i] >> k) & 1;
+
+        for (f = 0; f < frame_skip && !done; f++) {
+            if (config->flicker && f + 1 == frame_skip) memcpy(previous, vm->display, sizeof(previous));
+
+            if (chip8_run_frame(vm).cycles == 0) done = VECENV_TERMINATED;
+            env->frames[i]++;
+            if (config->done_addr && probe(vm, config->done_addr) == config->done_value) done = VECENV_TERMINATED;
+        }
+        if (!done && config->max_frames && env->frames[i] >= config->max_frames) done = VECENV_TRUNCATED;
+        env->total_frames += f;
+
+        // Signed 8-bit change, so a counter that wraps still counts as going up
+        float reward = 0.0f;
+        uint8_t *last = &env->probes[(size_t)i * VECENV_MAX_REWARDS];
+        for (uint32_t t = 0; t < config->reward_count; t++) {
+            uint8_t value = probe(vm, config->rewards[t].addr);
+            reward += config->rewards[t].weight * (float)(int8_t)(uint8_t)(value - last[t]);
+            last[t] = value;
+        }
+
+        if (rewards) rewards[i] = reward;
+        if (dones) dones[i] = done;
+
+        if (done) {
+            reset_env(env, i, next_seed(env->seeds[i]));
+            observe(env, i, NULL, obs);
+        } else {
+            observe(env, i, config->flicker && f == frame_skip ? previous : NULL, obs);
+        }
+    }
+}
@@ -0,0 +1,354 @@
+/**
+ * farm.c
+ *
+ * Runs many ROM jobs in one process on a work-stealing thread pool.
+ *
+ * Each worker owns one Chip8 for the whole run. It brings the VM back to
+ * power-on state with `chip8_reset` between jobs, so the decode cache and
+ * the JIT code buffer are allocated once per worker rather than once per job.
+ *
+ * Scheduling: the job list is split into one contiguous range per worker.
+ * The owner takes jobs from the front of its range. A worker whose range is
+ * empty picks victims round-robin from a random start and steals the back
+ * half of the first non-empty range it finds. Each range has its own lock,
+ * held only to move the bounds, and a worker never holds two locks, so
+ * workers contend only while stealing. Jobs do not create jobs: a worker
+ * that finds every range empty is done.
+ */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "farm.h"
+#include "display.h"
+#include "platform.h"
+#include "timer.h"
+#include "jit.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#define FNV_OFFSET 0xCBF29CE484222325ull
+#define FNV_PRIME 0x100000001B3ull
+
+struct Farm;
+
+// Worker thread: its queue range [next, end) and its reused VM
+typedef struct {
+    pthread_mutex_t lock;            // Guards next/end
+    size_t next;                     // Next job the owner runs
+    size_t end;                      // One past the last job; thieves take from here
+    uint64_t steals;
+    uint32_t rng;                    // Victim selection
+    int index;
+    pthread_t thread;
+    Chip8 *chip8;
+    struct Farm *farm;
+} FarmWorker;
+
+// State shared by the workers of one farm_run call
+typedef struct Farm {
+    const FarmJob *jobs;
+    FarmResult *results;
+    const FarmConfig *config;
+    FarmWorker *workers;
+    int worker_count;
+} Farm;
+
+/**
+ * FNV-1a over a block of bytes, continuing from `hash`.
+ */
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t size) {
+    const uint8_t *bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * Hash of the machine state a run leaves behind, framebuffer excluded:
+ * memory, V, I, PC, stack, timer values, keypad, the emulated clock and
+ * the Cxkk generator state.
+ *
+ * @param chip8 Pointer to the emulator state.
+ * @return      64-bit FNV-1a hash.
+ */
+uint64_t farm_state_hash(const Chip8 *chip8) {
+    if (!chip8) {
+        fprintf(stderr, "farm_state_hash called on null Chip8 pointer\n");
+        return 0;
+    }
+
+    const uint8_t timers[2] = { get_delay_timer(chip8), get_sound_timer(chip8) };
+    uint64_t hash = FNV_OFFSET;
+
+    hash = fnv1a(hash, chip8->memory, sizeof(chip8->memory));
+    hash = fnv1a(hash, chip8->V, sizeof(chip8->V));
+    hash = fnv1a(hash, &chip8->I, sizeof(chip8->I));
+    hash = fnv1a(hash, &chip8->pc, sizeof(chip8->pc));
+    hash = fnv1a(hash, chip8->stack, sizeof(chip8->stack));
+    hash = fnv1a(hash, &chip8->sp, sizeof(chip8->sp));
+    hash = fnv1a(hash, timers, sizeof(timers));
+    hash = fnv1a(hash, chip8->keypad, sizeof(chip8->keypad));
+    hash = fnv1a(hash, &chip8->cycles, sizeof(chip8->cycles));
+    hash = fnv1a(hash, &chip8->rng, sizeof(chip8->rng));
+    return hash;
+}
+
+/**
+ * Hash of the framebuffer.
+ *
+ * @param chip8 Pointer to the emulator state.
+ * @return      64-bit FNV-1a hash of the 32 packed rows.
+ */
+uint64_t farm_display_hash(const Chip8 *chip8) {
+    if (!chip8) {
+        fprintf(stderr, "farm_display_hash called on null Chip8 pointer\n");
+        return 0;
+    }
+    return fnv1a(FNV_OFFSET, chip8->display, sizeof(chip8->display));
+}
+
+/**
+ * Monotonic wall-clock time in seconds.
+ */
+static double farm_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Number of online CPUs (at least 1).
+ */
+static int cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+/**
+ * Runs one job on the worker's VM and fills in its result.
+ */
+static void run_job(FarmWorker *worker, size_t index) {
+    const Farm *farm = worker->farm;
+    const FarmJob *job = &farm->jobs[index];
+    FarmResult *result = &farm->results[index];
+    Chip8 *chip8 = worker->chip8;
+    Platform platform = {0};
+
+    *result = (FarmResult){ .worker = worker->index };
+
+    // Configuration, the JIT and the decode cache allocation survive the reset
+    chip8_reset(chip8);
+    chip8_seed(chip8, job->seed);
+    chip8->platform = NULL;
+
+    if (job->key_script && !platform_null_init(&platform, job->key_script)) return;
+    if (chip8_load_rom(chip8, job->rom)) {
+        fprintf(stderr, "[FARM] Failed to load ROM: %s\n", job->rom);
+        platform_quit(&platform);
+        return;
+    }
+    if (job->key_script) chip8->platform = &platform;
+
+    double start = farm_now();
+    while (chip8->cycles < job->cycles) {
+        Chip8Frame frame = chip8_run_frame(chip8);
+        result->frames++;
+        if (frame.cycles == 0) {
+            result->halted = true;
+            break;
+        }
+    }
+    result->seconds = farm_now() - start;
+
+    result->cycles = chip8->cycles;
+    result->state_hash = farm_state_hash(chip8);
+    result->display_hash = farm_display_hash(chip8);
+    result->ok = true;
+
+    chip8->platform = NULL;
+    platform_quit(&platform);
+}
+
+/**
+ * Takes the next job from the worker's own range.
+ *
+ * @return true with `*index` set, or false if the range is empty.
+ */
+static bool take_own(FarmWorker *worker, size_t *index) {
+    bool found = false;
+
+    pthread_mutex_lock(&worker->lock);
+    if (worker->next < worker->end) {
+        *index = worker->next++;
+        found = true;
+    }
+    pthread_mutex_unlock(&worker->lock);
+    return found;
+}
+
+/**
+ * Moves the back half of another worker's range into this worker's (empty) range.
+ *
+ * @return true if jobs were stolen, false if every other range is empty.
+ */
+static bool steal(FarmWorker *worker) {
+    const Farm *farm = worker->farm;
+
+    worker->rng ^= worker->rng << 13;
+    worker->rng ^= worker->rng >> 17;
+    worker->rng ^= worker->rng << 5;
+    int first = (int)(worker->rng % (uint32_t)farm->worker_count);
+
+    for (int k = 0; k < farm->worker_count; k++) {
+        FarmWorker *victim = &farm->workers[(first + k) % farm->worker_count];
+        if (victim == worker) continue;
+
+        pthread_mutex_lock(&victim->lock);
+        size_t remaining = victim->end - victim->next;
+        size_t take = (remaining + 1) / 2;
+        size_t from = victim->end - take;
+        victim->end = from;
+        pthread_mutex_unlock(&victim->lock);
+
+        if (take == 0) continue;
+
+        pthread_mutex_lock(&worker->lock);
+        worker->next = from;
+        worker->end = from + take;
+        pthread_mutex_unlock(&worker->lock);
+
+        worker->steals++;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Worker thread: runs its own jobs, then steals until no work is left.
+ */
+static void *worker_main(void *arg) {
+    FarmWorker *worker = arg;
+    size_t index;
+
+    for (;;) {
+        if (take_own(worker, &index)) {
+            run_job(worker, index);
+        } else if (!steal(worker)) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Runs a list of jobs on a pool of worker threads, each reusing one VM.
+ *
+ * Results do not depend on the number of threads or on which worker runs
+ * a job: each job seeds its VM's own Cxkk generator with `job->seed`.
+ *
+ * @param jobs    Jobs to run.
+ * @param count   Number of jobs.
+ * @param config  Worker count and VM options (NULL for the defaults:
+ *                one worker per CPU, idle skipping on).
+ * @param results `count` entries, filled in job order.
+ * @param stats   Receives the totals (may be NULL).
+ * @return        false if the workers could not be started.
+ */
+bool farm_run(const FarmJob *jobs, size_t count, const FarmConfig *config, FarmResult *results, FarmStats *stats) {
+    static const FarmConfig defaults = { .threads = 0, .skip_idle = true };
+
+    if ((!jobs || !results) && count > 0) {
+        fprintf(stderr, "farm_run called with null pointer\n");
+        return false;
+    }
+    if (!config) config = &defaults;
+
+    int worker_count = config->threads > 0 ? config->threads : cpu_count();
+    if ((size_t)worker_count > count) worker_count = count > 0 ? (int)count : 1;
+
+    Farm farm = { .jobs = jobs, .results = results, .config = config, .worker_count = worker_count };
+    farm.workers = calloc((size_t)worker_count, sizeof(FarmWorker));
+    if (!farm.workers) {
+        fprintf(stderr, "[FARM] Out of memory\n");
+        return false;
+    }
+
+    int started = 0;
+    bool ok = true;
+    double start = farm_now();
+
+    for (int i = 0; i < worker_count; i++) {
+        FarmWorker *worker = &farm.workers[i];
+
+        worker->index = i;
+        worker->farm = &farm;
+        worker->rng = 0x9E3779B9u * (uint32_t)(i + 1);
+        worker->next = count * (size_t)i / (size_t)worker_count;
+        worker->end = count * (size_t)(i + 1) / (size_t)worker_count;
+        pthread_mutex_init(&worker->lock, NULL);
+    }
+
+    for (int i = 0; i < worker_count; i++) {
+        FarmWorker *worker = &farm.workers[i];
+
+        worker->chip8 = malloc(sizeof(Chip8));
+        if (!worker->chip8) {
+            fprintf(stderr, "[FARM] Out of memory\n");
+            ok = false;
+            break;
+        }
+        chip8_init(worker->chip8);
+        worker->chip8->skip_idle = config->skip_idle;
+        if (config->jit) jit_enable(worker->chip8, JIT_HOT_THRESHOLD);
+    }
+
+    // Workers that fail to start leave their range to be stolen by the others
+    for (int i = 0; ok && i < worker_count; i++) {
+        if (pthread_create(&farm.workers[i].thread, NULL, worker_main, &farm.workers[i]) != 0) {
+            fprintf(stderr, "[FARM] Could not start worker %d\n", i);
+            break;
+        }
+        started++;
+    }
+    for (int i = 0; i < started; i++) pthread_join(farm.workers[i].thread, NULL);
+
+    if (started == 0) ok = false;
+
+    if (stats) {
+        *stats = (FarmStats){ .threads = started, .seconds = farm_now() - start };
+        for (int i = 0; i < started; i++) stats->steals += farm.workers[i].steals;
+        for (size_t j = 0; ok && j < count; j++) {
+            stats->cycles += results[j].cycles;
+            stats->failed += !results[j].ok;
+        }
+    }
+
+    for (int i = 0; i < worker_count; i++) {
+        FarmWorker *worker = &farm.workers[i];
+        if (worker->chip8) {
+            jit_disable(worker->chip8);
+            free(worker->chip8);
+        }
+        pthread_mutex_destroy(&worker->lock);
+    }
+    free(farm.workers);
+    return ok;
+}
@@ -0,0 +1,265 @@
+/**
+ * farm_main.c
+ *
+ * Entry point of `chip8-farm`: runs a list of ROM jobs on all cores through
+ * farm.c and prints one report (final state and framebuffer hashes, and
+ * instruction rate per job, then the totals).
+ *
+ * Jobs come from a job file (--jobs), one per line:
+ *
+ *     # rom              cycles    seed  [key script]
+ *     roms/PONG          1000000   1     keys/pong.txt
+ *     roms/BRIX          1000000   7
+ *
+ * or from the ROMs on the command line, each run with --cycles, --seed and
+ * --keys. --repeat N adds every job N times (throughput and scaling runs).
+ *
+ * Usage:
+ *     chip8-farm [--threads N] [--jobs FILE] [--cycles N] [--seed N] [--keys FILE]
+ *                [--repeat N] [--json FILE] [--quiet] [--jit] [--no-skip-idle] [ROM...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "farm.h"
+
+#define DEFAULT_CYCLES 1000000
+#define DEFAULT_SEED 1
+#define LINE_MAX_LENGTH 512
+
+static const char usage[] =
+    "Usage: %s [--threads N] [--jobs FILE] [--cycles N] [--seed N] [--keys FILE] [--repeat N] "
+    "[--json FILE] [--quiet] [--jit] [--no-skip-idle] [ROM...]\n";
+
+// Growable job list; strings are owned by the list
+typedef struct {
+    FarmJob *jobs;
+    size_t count;
+    size_t capacity;
+} JobList;
+
+/**
+ * Duplicates a string (strdup is not in C99).
+ */
+static char *copy_string(const char *text) {
+    size_t length = strlen(text) + 1;
+    char *copy = malloc(length);
+    if (copy) memcpy(copy, text, length);
+    return copy;
+}
+
+/**
+ * Appends a job, copying its strings.
+ *
+ * @return false if out of memory.
+ */
+static bool add_job(JobList *list, const char *rom, uint64_t cycles, uint32_t seed, const char *keys) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 64;
+        FarmJob *grown = realloc(list->jobs, capacity * sizeof(FarmJob));
+        if (!grown) return false;
+        list->jobs = grown;
+        list->capacity = capacity;
+    }
+
+    FarmJob job = { .rom = copy_string(rom), .cycles = cycles, .seed = seed };
+    if (keys) job.key_script = copy_string(keys);
+    if (!job.rom || (keys && !job.key_script)) return false;
+
+    list->jobs[list->count++] = job;
+    return true;
+}
+
+/**
+ * Reads a job file: "<rom> <cycles> <seed> [key script]" per line, '#' comments.
+ *
+ * @return true on success; on failure an error naming the line is printed.
+ */
+static bool load_jobs(JobList *list, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Cannot open job file: %s\n", path);
+        return false;
+    }
+
+    char line[LINE_MAX_LENGTH];
+    int line_number = 0;
+    bool ok = true;
+
+    while (ok && fgets(line, sizeof(line), file)) {
+        line_number++;
+
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+
+        char rom[256], keys[256], extra;
+        unsigned long long cycles;
+        unsigned long seed;
+        int fields = sscanf(line, "%255s %llu %lu %255s %c", rom, &cycles, &seed, keys, &extra);
+
+        if (fields <= 0) continue;  // Blank or comment-only line
+
+        if (fields < 3 || fields > 4 || cycles == 0) {
+            fprintf(stderr, "%s:%d: expected '<rom> <cycles> <seed> [key script]'\n", path, line_number);
+            ok = false;
+        } else if (!add_job(list, rom, cycles, (uint32_t)seed, fields == 4 ? keys : NULL)) {
+            fprintf(stderr, "Out of memory reading %s\n", path);
+            ok = false;
+        }
+    }
+
+    fclose(file);
+    return ok;
+}
+
+/**
+ * Writes the report as JSON (one job object per line).
+ *
+ * @return 0 on success, -1 if the file cannot be written.
+ */
+static int write_json(const char *path, const JobList *list, const FarmResult *results, const FarmStats *stats) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return -1;
+    }
+
+    fprintf(file, "{\n  \"threads\": %d,\n  \"seconds\": %.6f,\n  \"cycles\": %llu,\n  \"steals\": %llu,\n"
+                  "  \"failed\": %d,\n  \"jobs\": [\n",
+            stats->threads, stats->seconds, (unsigned long long)stats->cycles,
+            (unsigned long long)stats->steals, stats->failed);
+
+    for (size_t i = 0; i < list->count; i++) {
+        const FarmJob *job = &list->jobs[i];
+        const FarmResult *r = &results[i];
+
+        fprintf(file,
+                "    {\"rom\": \"%s\", \"cycles\": %llu, \"seed\": %u, \"keys\": \"%s\", \"ok\": %s, "
+                "\"state_hash\": \"%016llx\", \"display_hash\": \"%016llx\", \"halted\": %s, \"executed\": %llu, "
+                "\"frames\": %llu, \"seconds\": %.6f, \"instructions_per_second\": %.0f, \"worker\": %d}%s\n",
+                job->rom, (unsigned long long)job->cycles, job->seed, job->key_script ? job->key_script : "",
+                r->ok ? "true" : "false", (unsigned long long)r->state_hash, (unsigned long long)r->display_hash,
+                r->halted ? "true" : "false", (unsigned long long)r->cycles, (unsigned long long)r->frames, r->seconds,
+                r->seconds > 0 ? (double)r->cycles / r->seconds : 0.0, r->worker,
+                i + 1 < list->count ? "," : "");
+    }
+
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    FarmConfig config = { .skip_idle = true };
+    uint64_t cycles = DEFAULT_CYCLES;
+    uint32_t seed = DEFAULT_SEED;
+    const char *keys = NULL;
+    const char *jobs_path = NULL;
+    const char *json = NULL;
+    long repeat = 1;
+    bool quiet = false;
+    const char **roms = malloc((size_t)argc * sizeof(char *));
+    int rom_count = 0;
+
+    if (!roms) {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            config.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs_path = argv[++i];
+        } else if (strcmp(argv[i], "--cycles") == 0 && i + 1 < argc) {
+            cycles = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--keys") == 0 && i + 1 < argc) {
+            keys = argv[++i];
+        } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = strtol(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json = argv[++i];
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            quiet = true;
+        } else if (strcmp(argv[i], "--jit") == 0) {
+            config.jit = true;
+        } else if (strcmp(argv[i], "--no-skip-idle") == 0) {
+            config.skip_idle = false;
+        } else if (argv[i][0] != '-') {
+            roms[rom_count++] = argv[i];
+        } else {
+            fprintf(stderr, usage, argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (cycles == 0 || repeat <= 0 || config.threads < 0 || (!jobs_path && rom_count == 0)) {
+        fprintf(stderr, usage, argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Job list: the job file, then the ROMs on the command line; the whole list --repeat times
+    JobList list = {0};
+    if (jobs_path && !load_jobs(&list, jobs_path)) return EXIT_FAILURE;
+    for (int i = 0; i < rom_count; i++) {
+        if (!add_job(&list, roms[i], cycles, seed, keys)) {
+            fprintf(stderr, "Out of memory\n");
+            return EXIT_FAILURE;
+        }
+    }
+    size_t unique = list.count;
+    for (long r = 1; r < repeat; r++) {
+        for (size_t j = 0; j < unique; j++) {
+            const FarmJob *job = &list.jobs[j];
+            if (!add_job(&list, job->rom, job->cycles, job->seed, job->key_script)) {
+                fprintf(stderr, "Out of memory\n");
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    FarmResult *results = calloc(list.count ? list.count : 1, sizeof(FarmResult));
+    FarmStats stats;
+    if (!results || !farm_run(list.jobs, list.count, &config, results, &stats)) {
+        fprintf(stderr, "Farm failed to run\n");
+        return EXIT_FAILURE;
+    }
+
+    if (!quiet) {
+        printf("%-5s %-20s %10s %6s %-16s %-16s %10s %6s\n", "job", "rom", "cycles", "seed", "state", "display",
+               "M instr/s", "worker");
+        for (size_t i = 0; i < list.count; i++) {
+            const FarmJob *job = &list.jobs[i];
+            const FarmResult *r = &results[i];
+
+            if (!r->ok) {
+                printf("%-5zu %-20s %10s\n", i, job->rom, "FAILED");
+                continue;
+            }
+            printf("%-5zu %-20s %10llu %6u %016llx %016llx %10.1f %6d%s\n", i, job->rom,
+                   (unsigned long long)r->cycles, job->seed, (unsigned long long)r->state_hash,
+                   (unsigned long long)r->display_hash, r->seconds > 0 ? (double)r->cycles / r->seconds / 1e6 : 0.0,
+                   r->worker, r->halted ? "  halted" : "");
+        }
+        printf("\n");
+    }
+
+    printf("%zu jobs on %d threads in %.3f s: %.1f M instructions/s, %llu steals, %d failed\n", list.count,
+           stats.threads, stats.seconds, stats.seconds > 0 ? (double)stats.cycles / stats.seconds / 1e6 : 0.0,
+           (unsigned long long)stats.steals, stats.failed);
+
+    int status = stats.failed ? EXIT_FAILURE : EXIT_SUCCESS;
+    if (json && write_json(json, &list, results, &stats)) status = EXIT_FAILURE;
+
+    for (size_t i = 0; i < list.count; i++) {
+        free((char *)list.jobs[i].rom);
+        free((char *)list.jobs[i].key_script);
+    }
+    free(list.jobs);
+    free(results);
+    free(roms);
+    return status;
+}
@@ -12,33 +12,107 @@
 #define DISPLAY_HEIGHT 32          // Display height in pixels
 #define KEYPAD_SIZE 16             // 16-key hexadecimal keypad
 #define FONTSET_SIZE 80            // Size of the built-in fontset
+#define KEY_EVENT_QUEUE 32         // Key presses/releases applied per frame (see input.h)
 
-// Core CHIP-8 system state
+// Execution rate constants
+#define CPU_FREQUENCY 700          // Default emulated CPU frequency (instructions per second)
+#define TIMER_FREQUENCY 60         // Delay/sound timer tick rate (Hz)
+#define CYCLES_PER_FRAME (CPU_FREQUENCY / TIMER_FREQUENCY) // Instructions per 60Hz frame
+
+struct Chip8;
+
+// Opcode handler signature shared by the dispatch tables and the decode cache
+typedef void (*OpcodeHandler)(struct Chip8 *chip8, uint16_t opcode);
+
+// Predecoded instruction cached per memory address (filled lazily by dispatch.c), 4 bytes
 typedef struct {
+    uint16_t opcode;                 // Opcode the handler was resolved from
+    uint8_t handler;                 // Leaf handler: index into dispatch_handlers, 0 if not decoded yet
+    bool idle;                       // A timer-wait loop starts here (see idle.h)
+} DecodedOp;
+
+// Key press or release scheduled on the emulated clock (see keypad_scan)
+typedef struct {
+    uint64_t cycle;                  // Applied before the instruction at this `cycles` value
+    uint8_t key;                     // Key index 0x0-0xF
+    bool down;                       // Pressed (true) or released (false)
+} KeyEvent;
+
+// Core CHIP-8 system state
+typedef struct Chip8 {
+    // Power-on state: everything up to `cpu_hz` is cleared by chip8_reset() and saved by chip8_save_state()
     uint8_t memory[MEMORY_SIZE];      // RAM
     uint8_t V[REGISTER_COUNT];        // Registers V0 through VF
     uint16_t I;                       // Index register (typically used for memory addresses)
     uint16_t pc;                      // Program counter
 
-    uint8_t delay_timer;             // Delay timer (ticks at 60Hz)
-    uint8_t sound_timer;             // Sound timer (ticks at 60Hz, beeps when non-zero)
+    uint64_t cycles;                 // Emulated clock: instructions executed since reset
+    uint64_t idle_skipped;           // Of those, instructions fast-forwarded in idle loops
+
+    // Timers are stored as "value set at cycle T" and computed on read (see timer.h)
+    uint8_t delay_timer;             // Delay timer value when last set
+    uint8_t sound_timer;             // Sound timer value when last set (beeps while non-zero)
+    uint64_t delay_set_at;           // `cycles` when the delay timer was set
+    uint64_t sound_set_at;           // `cycles` when the sound timer was set
 
     uint16_t stack[STACK_SIZE];      // Stack for subroutine calls
     uint8_t sp;                      // Stack pointer
 
-    uint8_t display[DISPLAY_WIDTH * DISPLAY_HEIGHT];  // Monochrome framebuffer (1 byte per pixel)
+    uint64_t rng;                    // Cxkk generator state, derived from `seed` on reset (see rng.h)
+
+    uint64_t display[DISPLAY_HEIGHT];  // Monochrome framebuffer: one word per row, bit 63 = leftmost pixel
+    uint64_t shown[DISPLAY_HEIGHT];  // Framebuffer as last presented by update_display()
+    uint32_t dirty_rows;             // Rows written since the last present (bit y = row y)
     uint8_t keypad[KEYPAD_SIZE];     // Key states: 1 = pressed, 0 = not pressed
+    KeyEvent key_events[KEY_EVENT_QUEUE]; // Key changes of the running frame, in cycle order
+    uint8_t key_event_count;         // Events queued for the frame
+    uint8_t key_event_next;          // Next event to apply
+    uint64_t input_read_us;          // Host time of the previous platform input read (0 = none yet)
 
-    bool draw_flag;                  // True if the screen needs to be redrawn
+    bool draw_flag;                  // True if the whole screen must be redrawn (after init/reset)
+    bool sound_active;               // Last beep state reported to the platform
+    bool key_wait;                   // Blocked in Fx0A until a key is down (see chip8_run)
+
+    // Configuration and host attachments: kept across chip8_reset()
+    uint32_t cpu_hz;                 // Emulated CPU frequency; timers tick every cpu_hz / 60 cycles
+    bool skip_idle;                  // Fast-forward timer-wait loops (see idle.h)
+    uint64_t seed;                   // Seed of the Cxkk generator (set with chip8_seed)
+    bool libc_rand;                  // Cxkk draws from the process-wide rand() instead (old behavior)
 
     bool test_mode;                  // Enables debugging and test features
     char rom_path[128];             // Path to the loaded ROM (for test logging)
+
+    const struct Platform *platform; // Host display/input/audio (see platform.h), NULL runs headless
+    struct Jit *jit;                 // JIT backend state (see jit.h), NULL when interpreting
+    const struct RecompProgram *recomp; // Ahead-of-time translated ROM (see recomp.h), or NULL
+    uint16_t recomp_dirty_lo;        // Memory written since recomp_attach: [lo, hi) is
+    uint16_t recomp_dirty_hi;        //   re-checked against the ROM before running a block
+
+    DecodedOp decoded[MEMORY_SIZE];  // Decode cache indexed by address; invalidated on writes
+    uint16_t decoded_lo;             // Entries outside [lo, hi) are known to be empty,
+    uint16_t decoded_hi;             //   so invalidating everything only clears that range
 } Chip8;
 
+// Result of running a batch of instructions with chip8_run()/chip8_run_frame()
+typedef struct {
+    uint32_t cycles;                 // Instructions actually executed
+    uint32_t skipped;                // Of those, instructions fast-forwarded in idle loops
+    uint32_t damage;                 // Rows that differ from the last present (see display_damage)
+    bool draw;                       // True if there is anything to present (damage != 0)
+    bool sound;                      // True if the beep is active after the timer tick
+    bool sound_edge;                 // True if the beep started or stopped this frame
+    bool waiting;                    // True if the VM is blocked in Fx0A waiting for a key
+} Chip8Frame;
+
 // Core functions
 
 void chip8_init(Chip8 *chip8);                       // Initialize a new CHIP-8 instance
+void chip8_reset(Chip8 *chip8);                      // Restore power-on state, keep configuration
 int chip8_load_rom(Chip8 *chip8, const char *filename); // Load a ROM into memory
-void chip8_cycle(Chip8 *chip8);                      // Execute one emulation cycle
+void chip8_seed(Chip8 *chip8, uint64_t seed);        // Seed Cxkk's generator (also used by later resets)
+void chip8_cycle(Chip8 *chip8);                      // Execute one instruction (no timer/input work)
+uint32_t chip8_execute(Chip8 *chip8, uint32_t cycles); // Execute up to `cycles` instructions (no timer/input work)
+Chip8Frame chip8_run(Chip8 *chip8, uint32_t cycles); // Execute one 60Hz frame of `cycles` instructions
+Chip8Frame chip8_run_frame(Chip8 *chip8);            // Execute up to the next 60Hz timer tick at cpu_hz
 
 #endif
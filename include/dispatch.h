@@ -3,15 +3,34 @@
 
 #include "chip8.h"
 
-// Function pointer type for opcode handlers
-typedef void (*OpcodeHandler)(Chip8 *chip8, uint16_t opcode);
+// Flat table: leaf handler for every 16-bit opcode (generated at build time)
+extern const OpcodeHandler dispatch_table[0x10000];
 
-// Initialize main dispatch table and subdispatch tables
-void opcode_dispatch_init(void);
+// Compact form for the decode cache: every leaf handler once (entry 0 is NULL) and each opcode's index there
+extern const OpcodeHandler dispatch_handlers[];
+extern const uint8_t dispatch_index[0x10000];
 
 // Decode and dispatch an opcode to the appropriate handler
 bool dispatch_opcode(Chip8 *chip8, uint16_t opcode);
 
+// Dispatch through the two-level tables (reference path for benchmarks)
+void dispatch_opcode_nested(Chip8 *chip8, uint16_t opcode);
+
+// Fault handler for undefined opcodes
+void op_unknown(Chip8 *chip8, uint16_t opcode);
+
+// Resolve an opcode straight to its leaf handler (never NULL)
+OpcodeHandler dispatch_resolve(uint16_t opcode);
+
+// Fill the decode cache entry for the instruction at `addr`
+DecodedOp *dispatch_decode(Chip8 *chip8, uint16_t addr);
+
+// Drop cached decodes overlapping memory[addr .. addr + len - 1] after a write
+void dispatch_invalidate(Chip8 *chip8, uint16_t addr, uint16_t len);
+
+// Drop every cached decode (e.g., after loading a ROM)
+void dispatch_invalidate_all(Chip8 *chip8);
+
 // Special-case dispatchers that need further decoding based on lower bits
 void op_0xxx(Chip8 *chip8, uint16_t opcode); // For opcodes starting with 0x0***
 void op_8xxx(Chip8 *chip8, uint16_t opcode); // For opcodes starting with 0x8***
@@ -13,10 +13,13 @@ int draw_sprite(Chip8 *chip8, uint8_t x, uint8_t y, uint8_t height, const uint8_
 // Clear all display pixels
 void clear_display(Chip8 *chip8);
 
-// Trigger screen update (only if draw_flag is set)
+// Rows whose pixels differ from the last present (bit y = row y), 0 if nothing changed
+uint32_t display_damage(const Chip8 *chip8);
+
+// Present the changed rows to the platform and mark the display as shown
 void update_display(Chip8 *chip8);
 
-// Shut down display-related resources
-void display_quit();
+// Expand packed framebuffer rows to one byte per pixel (64x32, 0 or 1)
+void display_unpack(const uint64_t *rows, uint8_t *pixels);
 
 #endif
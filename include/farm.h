@@ -0,0 +1,51 @@
+#ifndef FARM_H
+#define FARM_H
+
+#include <stddef.h>
+#include "chip8.h"
+
+// One run: a ROM from reset for `cycles` instructions, optionally with scripted keys
+typedef struct {
+    const char *rom;                 // ROM file
+    uint64_t cycles;                 // Emulated instructions to run (the last frame may overshoot)
+    const char *key_script;          // Key script for the null platform (see platform.h), or NULL
+    uint32_t seed;                   // Seed for the random numbers of Cxkk
+} FarmJob;
+
+// Outcome of one job
+typedef struct {
+    bool ok;                         // False if the ROM or key script could not be loaded
+    bool halted;                     // The VM stopped executing before `cycles` (PC ran off memory)
+    uint64_t state_hash;             // FNV-1a of memory, registers, stack, timers and clock
+    uint64_t display_hash;           // FNV-1a of the framebuffer
+    uint64_t cycles;                 // Instructions executed
+    uint64_t frames;                 // chip8_run_frame calls
+    double seconds;                  // Wall-clock time of the run (excluding ROM loading)
+    int worker;                      // Worker thread that ran it
+} FarmResult;
+
+// Options shared by every job
+typedef struct {
+    int threads;                     // Worker threads; 0 = one per online CPU
+    bool skip_idle;                  // As chip8->skip_idle
+    bool jit;                        // Enable the JIT on every worker's VM
+} FarmConfig;
+
+// Totals of a farm run
+typedef struct {
+    int threads;                     // Worker threads actually used
+    double seconds;                  // Wall-clock time of the whole run
+    uint64_t cycles;                 // Instructions executed by all jobs
+    uint64_t steals;                 // Job ranges taken from another worker's queue
+    int failed;                      // Jobs with ok == false
+} FarmStats;
+
+// Run `count` jobs on a work-stealing pool of reused VMs; results[i] belongs to jobs[i].
+// Returns false if the pool could not be started (stats may be NULL)
+bool farm_run(const FarmJob *jobs, size_t count, const FarmConfig *config, FarmResult *results, FarmStats *stats);
+
+// Hashes used in FarmResult, for comparing a single VM against a farm run
+uint64_t farm_state_hash(const Chip8 *chip8);
+uint64_t farm_display_hash(const Chip8 *chip8);
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef IDLE_H
+#define IDLE_H
+
+#include "chip8.h"
+
+// Instructions in one pass of a timer-wait loop (Fx07 ; 3xkk/4xkk ; 1nnn)
+#define IDLE_LOOP_LENGTH 3
+
+// True if a timer-wait loop that jumps back to itself starts at `addr`
+bool idle_match(const Chip8 *chip8, uint16_t addr);
+
+// True if PC is at a loop the interpreter fast-forwards (compiled backends stop there)
+bool idle_at(Chip8 *chip8);
+
+// Fast-forward whole passes of the loop at PC within `budget`; returns instructions skipped
+uint32_t idle_skip(Chip8 *chip8, uint16_t opcode, uint32_t budget);
+
+#endif
@@ -6,8 +6,11 @@
 // Set all keys to unpressed
 void keypad_init(Chip8 *chip8);
 
-// Scan physical key states and update CHIP-8 keypad
-void keypad_scan(Chip8 *chip8);
+// Read the platform's input for a frame of `cycles` instructions starting at chip8->cycles
+void keypad_scan(Chip8 *chip8, uint32_t cycles);
+
+// Apply the key events due by chip8->cycles; returns the cycle of the next one (at most `end`)
+uint64_t keypad_apply_events(Chip8 *chip8, uint64_t end);
 
 // Update the key state array for a specific key
 void keypad_map(Chip8 *chip8, uint8_t key, bool state);
@@ -15,4 +18,7 @@ void keypad_map(Chip8 *chip8, uint8_t key, bool state);
 // Check whether a key is currently pressed
 bool is_key_pressed(Chip8 *chip8, uint8_t key);
 
+// Check whether any key is currently pressed
+bool is_any_key_pressed(const Chip8 *chip8);
+
 #endif
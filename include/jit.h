@@ -0,0 +1,22 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include "chip8.h"
+
+// Default number of visits before an address is compiled into a native block
+#define JIT_HOT_THRESHOLD 16
+
+// Enable the x86-64 JIT backend for this instance (false if unsupported on this host)
+bool jit_enable(Chip8 *chip8, uint16_t hot_threshold);
+
+// Disable the JIT backend and release its code buffer
+void jit_disable(Chip8 *chip8);
+
+// Run compiled blocks starting at PC without exceeding `budget` instructions
+// Returns the number of instructions executed (0 if PC has no hot block yet)
+uint32_t jit_execute(Chip8 *chip8, uint32_t budget);
+
+// Drop compiled blocks covering memory[addr .. addr + len - 1] after a write
+void jit_invalidate(Chip8 *chip8, uint16_t addr, uint16_t len);
+
+#endif
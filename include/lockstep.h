@@ -0,0 +1,78 @@
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include "chip8.h"
+
+// Lane arrays are padded to a multiple of this (one AVX2 register of bytes)
+#define LOCKSTEP_BLOCK 32
+
+// Instruction set of the vector kernels
+typedef enum {
+    LOCKSTEP_SCALAR,                 // No vector kernels: lane-list loops only
+    LOCKSTEP_SSE2,                   // 16 lanes per register
+    LOCKSTEP_AVX2                    // 32 lanes per register
+} LockstepIsa;
+
+// Lanes at one PC in the current step: members[start .. start + count - 1]
+typedef struct {
+    uint16_t pc;
+    bool branched;                   // Ran a skip or handler: its lanes may be at different PCs now
+    uint32_t start;
+    uint32_t count;
+} LockstepGroup;
+
+// Many copies of one ROM executed in lockstep (see lockstep.c)
+typedef struct {
+    uint32_t lanes;                  // Number of VMs
+    uint32_t stride;                 // `lanes` rounded up to LOCKSTEP_BLOCK (length of every lane array)
+    Chip8 *vm;                       // Per-lane machine: memory, stack, timers, framebuffer, keypad
+    LockstepIsa isa;                 // Best one the host supports; may be lowered before lockstep_run
+
+    // Register file in structure-of-arrays form, authoritative only inside lockstep_run
+    uint8_t *V[REGISTER_COUNT];      // V[r][lane]
+    uint16_t *I;                     // I[lane]
+    uint16_t *pc;                    // pc[lane]
+    uint64_t *cycles;                // cycles[lane] when lockstep_run started
+    uint32_t *halted_at;             // Steps a lane ran before PC left memory (UINT32_MAX while live)
+
+    // Grouping of the current step; regrouping reads one buffer of each pair and writes the other
+    uint32_t *members;               // Lanes of every group, group after group
+    LockstepGroup *groups;           // Groups, one per PC
+    uint32_t group_count;            // Entries in groups
+    uint32_t live;                   // Lanes in all groups: those whose PC is still in memory
+    uint32_t *spare_members;
+    LockstepGroup *spare_groups;
+    uint32_t *group_of;              // Group index by PC, valid where seen[pc] == epoch
+    uint32_t *seen;                  // Regrouping stamp by PC
+    uint32_t epoch;                  // Stamp of the current regrouping
+
+    uint8_t image[MEMORY_SIZE];      // Memory image every lane starts from (the loaded ROM)
+    uint8_t code[MEMORY_SIZE];       // Memory every lane holds alike, where not dirty
+    uint8_t dirty[MEMORY_SIZE];      // May differ between lanes: opcodes there are compared per lane
+    uint8_t kernel[MEMORY_SIZE];     // Kernel of the opcode at each address of `code`, once classified
+
+    uint64_t simd_ops;               // Lane instructions executed by the SSE2/AVX2 kernels
+    uint64_t list_ops;               // Lane instructions executed by the lane-list kernels
+    uint64_t handler_ops;            // Lane instructions executed by the opcode handlers
+    uint64_t cycle_ops;              // Lane instructions executed by chip8_cycle once lanes diverged
+} Lockstep;
+
+// Allocate `lanes` VMs (chip8_init each) and the lane arrays; false if out of memory
+bool lockstep_init(Lockstep *ls, uint32_t lanes);
+
+// Free everything lockstep_init allocated
+void lockstep_free(Lockstep *ls);
+
+// Reset every lane and load a ROM into all of them; 0 on success, -1 on failure
+int lockstep_load_rom(Lockstep *ls, const char *filename);
+
+// Power-on reset of one lane with the loaded ROM back in memory
+void lockstep_reset_lane(Lockstep *ls, uint32_t lane);
+
+// Tell the engine the host wrote memory[addr .. addr + len - 1] of some lane
+void lockstep_invalidate(Lockstep *ls, uint16_t addr, uint16_t len);
+
+// Execute `cycles` instructions on every lane, as `cycles` chip8_cycle calls each; returns steps run
+uint32_t lockstep_run(Lockstep *ls, uint32_t cycles);
+
+#endif
@@ -3,6 +3,13 @@
 
 #include "chip8.h"
 
+// Macros for extracting components of an opcode
+#define OPCODE_NNN(op) ((op) & 0x0FFF)       // Lowest 12 bits
+#define OPCODE_X(op)   (((op) >> 8) & 0x0F)  // 2nd nibble
+#define OPCODE_Y(op)   (((op) >> 4) & 0x0F)  // 3rd nibble
+#define OPCODE_N(op)   ((op) & 0x000F)       // Lowest nibble
+#define OPCODE_KK(op)  ((op) & 0x00FF)       // Lowest byte
+
 // Top-level opcode handlers, mapped in the main dispatch table [0x0 - 0xF]
 void op_1nnn(Chip8 *chip8, uint16_t opcode); // Jump to address NNN
 void op_2nnn(Chip8 *chip8, uint16_t opcode); // Call subroutine at NNN
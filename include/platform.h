@@ -3,20 +3,123 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
-// Initialize SDL and related platform components
-void platform_init(void);
+#define PLATFORM_ALL_ROWS 0xFFFFFFFFu  // Damage mask covering all 32 display rows
 
-// Render the framebuffer to the window
-void platform_update_display(const uint8_t *pixels);  // 64x32 resolution
+// Key press or release read from the host, stamped with the host clock
+typedef struct {
+    uint64_t time_us;                // Host time of the event (same clock as read_input's `now_us`)
+    uint8_t key;                     // CHIP-8 key index 0x0-0xF
+    bool down;                       // Pressed (true) or released (false)
+} InputEvent;
 
-// Poll for input events and update the keypad
-void platform_poll_input(uint8_t *keypad);
+// Host backend: callbacks plus the backend state they receive as `ctx`.
+// Any callback may be NULL; a Chip8 with no platform runs headless.
+typedef struct Platform {
+    void *ctx;
 
-// Play a beep sound while sound_timer > 0
-void platform_play_beep(bool active);
+    // Render the framebuffer to the window (32 rows of 64 pixels, bit 63 = leftmost)
+    void (*update_display)(void *ctx, const uint64_t *rows);
 
-// Shut down and clean up platform-related resources
-void platform_quit(void);
+    // Render only the rows set in `damage` (bit y = row y); the others are unchanged
+    // since the previous call. Optional: update_display is used when NULL
+    void (*update_rows)(void *ctx, const uint64_t *rows, uint32_t damage);
+
+    // Poll for input events and update the keypad
+    void (*poll_input)(void *ctx, uint8_t *keypad);
+
+    // Read up to `max` key events since the previous call, oldest first, and the current host
+    // time in `now_us`; events that do not fit stay queued. Optional: poll_input is used when NULL
+    size_t (*read_input)(void *ctx, InputEvent *events, size_t max, uint64_t *now_us);
+
+    // Block until an input event arrives or `timeout_ms` passes (used while waiting for a key)
+    void (*wait_input)(void *ctx, uint32_t timeout_ms);
+
+    // Start or stop the beep
+    void (*play_beep)(void *ctx, bool active);
+
+    // Start or stop the beep at `time_us` on the emulated clock (microseconds since reset;
+    // it restarts from 0 after a reset). Optional: play_beep is used when NULL
+    void (*beep_edge)(void *ctx, bool active, uint64_t time_us);
+
+    // Shut down and release the backend state
+    void (*quit)(void *ctx);
+} Platform;
+
+// SDL2 backend (platform_sdl.c); opens a window and fills `platform`
+bool platform_sdl_init(Platform *platform);
+
+// Colors of unlit and lit pixels (0xRRGGBB) for an SDL platform; white on black by default.
+// Set them before starting the render thread
+void platform_sdl_set_palette(Platform *platform, uint32_t background, uint32_t foreground);
+
+// Counters of an SDL render thread
+typedef struct {
+    uint64_t published;              // Frames handed over by update_display/update_rows
+    uint64_t presented;              // Frames the render thread presented
+    uint64_t dropped;                // Frames replaced by a newer one before they were presented
+    double latency_avg_ms;           // Hand-over to present completed, averaged over presented frames
+    double latency_max_ms;
+} PlatformRenderStats;
+
+// Present from a dedicated render thread (triple-buffered); false keeps presenting in place
+bool platform_sdl_start_renderer(Platform *platform);
+
+// Join the render thread, present in place again, and report its counters (stats may be NULL)
+void platform_sdl_stop_renderer(Platform *platform, PlatformRenderStats *stats);
+
+// Headless backend (platform_null.c): no window or audio; keys replayed from a script
+// ("<ms> <key> down|up" per line) or none if `key_script` is NULL
+bool platform_null_init(Platform *platform, const char *key_script);
+
+// Framebuffer last presented to a null platform (32 rows, bit 63 = leftmost), NULL for other backends
+const uint64_t *platform_null_framebuffer(const Platform *platform);
+
+// Display updates and beep edges a null platform received (either pointer may be NULL)
+void platform_null_counters(const Platform *platform, uint64_t *presents, uint64_t *beep_edges);
+
+// Browser backend (platform_wasm.c)
+void platform_wasm_init(Platform *platform);
+
+static inline void platform_update_display(const Platform *platform, const uint64_t *rows) {
+    if (platform && platform->update_display) platform->update_display(platform->ctx, rows);
+}
+
+static inline void platform_update_rows(const Platform *platform, const uint64_t *rows, uint32_t damage) {
+    if (!platform) return;
+    if (platform->update_rows) platform->update_rows(platform->ctx, rows, damage);
+    else if (platform->update_display) platform->update_display(platform->ctx, rows);
+}
+
+static inline void platform_poll_input(const Platform *platform, uint8_t *keypad) {
+    if (platform && platform->poll_input) platform->poll_input(platform->ctx, keypad);
+}
+
+static inline size_t platform_read_input(const Platform *platform, InputEvent *events, size_t max,
+                                         uint64_t *now_us) {
+    if (!platform || !platform->read_input) return 0;
+    return platform->read_input(platform->ctx, events, max, now_us);
+}
+
+static inline void platform_wait_input(const Platform *platform, uint32_t timeout_ms) {
+    if (platform && platform->wait_input) platform->wait_input(platform->ctx, timeout_ms);
+}
+
+static inline void platform_play_beep(const Platform *platform, bool active) {
+    if (platform && platform->play_beep) platform->play_beep(platform->ctx, active);
+}
+
+static inline void platform_beep_edge(const Platform *platform, bool active, uint64_t time_us) {
+    if (!platform) return;
+    if (platform->beep_edge) platform->beep_edge(platform->ctx, active, time_us);
+    else if (platform->play_beep) platform->play_beep(platform->ctx, active);
+}
+
+static inline void platform_quit(Platform *platform) {
+    if (!platform) return;
+    if (platform->quit) platform->quit(platform->ctx);
+    *platform = (Platform){0};   // Headless from here on
+}
 
 #endif
@@ -0,0 +1,36 @@
+#ifndef RECOMP_H
+#define RECOMP_H
+
+#include "chip8.h"
+
+// Native translation of one basic block; executes it, leaves PC at the successor
+// and returns the number of instructions that ran
+typedef uint32_t (*RecompBlockFn)(Chip8 *chip8);
+
+// One basic block emitted by chip8-recomp
+typedef struct {
+    uint16_t addr;                   // Address of the first instruction
+    uint16_t size;                   // Bytes of ROM covered by the block
+    uint8_t length;                  // Most instructions executed per entry
+    RecompBlockFn fn;                // Generated C function
+} RecompBlock;
+
+// A whole ROM translated ahead of time (defined by the generated translation unit)
+typedef struct RecompProgram {
+    const char *name;                // ROM the program was generated from
+    const uint8_t *rom;              // Original ROM image (used to detect self-modified code)
+    uint16_t rom_size;               // Size of the ROM image in bytes
+    const RecompBlock *const *map;   // MEMORY_SIZE entries: block starting at each address, or NULL
+} RecompProgram;
+
+// Load the program's ROM image into memory and attach its native blocks
+void recomp_attach(Chip8 *chip8, const RecompProgram *program);
+
+// Run native blocks starting at PC without exceeding `budget` instructions
+// Returns the number of instructions executed (0 if PC is not a translated block)
+uint32_t recomp_execute(Chip8 *chip8, uint32_t budget);
+
+// Note a write to memory[addr .. addr + len - 1]; overlapping blocks are re-checked before running
+void recomp_invalidate(Chip8 *chip8, uint16_t addr, uint16_t len);
+
+#endif
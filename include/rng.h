@@ -0,0 +1,16 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include "chip8.h"
+#include <stdint.h>
+
+// Seed of a new instance (chip8_init)
+#define RNG_DEFAULT_SEED 1
+
+// Derive the generator state from `seed` (chip8_reset does this with chip8->seed)
+void rng_seed(Chip8 *chip8, uint64_t seed);
+
+// Next random byte for Cxkk: the instance's generator, or rand() with chip8->libc_rand
+uint8_t rng_byte(Chip8 *chip8);
+
+#endif
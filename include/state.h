@@ -0,0 +1,20 @@
+#ifndef STATE_H
+#define STATE_H
+
+#include <stddef.h>
+#include "chip8.h"
+
+// Snapshot format (see state.c): header, then the machine state, little-endian
+#define CHIP8_STATE_MAGIC "C8ST"
+#define CHIP8_STATE_VERSION 1
+#define CHIP8_STATE_HEADER 16        // Magic, version, flags, payload size, checksum
+#define CHIP8_STATE_PAYLOAD 4792     // Machine state of version 1 (a multiple of 8)
+#define CHIP8_STATE_SIZE (CHIP8_STATE_HEADER + CHIP8_STATE_PAYLOAD)
+
+// Serialize the machine state into `buffer`; returns the bytes written, 0 if it is too small
+size_t chip8_save_state(const Chip8 *chip8, uint8_t *buffer, size_t size);
+
+// Restore a state written by chip8_save_state (configuration is kept); 0 on success, -1 if invalid
+int chip8_load_state(Chip8 *chip8, const uint8_t *buffer, size_t size);
+
+#endif
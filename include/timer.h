@@ -7,20 +7,24 @@
 // Set delay and sound timers to 0
 void timer_init(Chip8 *chip8);
 
-// Decrement delay/sound timers at 60Hz (if > 0)
+// Report a beep that ran out to the platform (timers themselves never need ticking)
 void timer_update(Chip8 *chip8);
 
-// Accessor functions for the delay and sound timers
-uint8_t get_delay_timer(Chip8 *chip8);
-uint8_t get_sound_timer(Chip8 *chip8);
+// 60Hz ticks elapsed on the emulated clock after `cycle` instructions
+uint64_t timer_ticks(const Chip8 *chip8, uint64_t cycle);
 
-// Set the delay or sound timers manually
+// First cycle after `cycle` at which a new 60Hz tick starts
+uint64_t timer_next_tick(const Chip8 *chip8, uint64_t cycle);
+
+// Emulated time at `cycle`, in microseconds since reset (timestamps beep edges)
+uint64_t timer_cycle_us(const Chip8 *chip8, uint64_t cycle);
+
+// Accessor functions for the delay and sound timers (current value at chip8->cycles)
+uint8_t get_delay_timer(const Chip8 *chip8);
+uint8_t get_sound_timer(const Chip8 *chip8);
+
+// Set the delay or sound timers manually (timestamped with chip8->cycles)
 void set_delay_timer(Chip8 *chip8, uint8_t value);
 void set_sound_timer(Chip8 *chip8, uint8_t value);
 
-// SDL audio integration (optional)
-void audio_callback(void *userdata, uint8_t *stream, int len);
-void audio_init();    // Start audio engine
-void audio_quit();    // Stop audio engine
-
 #endif
@@ -0,0 +1,80 @@
+#ifndef VECENV_H
+#define VECENV_H
+
+#include <stddef.h>
+#include "chip8.h"
+
+// Reward terms per environment
+#define VECENV_MAX_REWARDS 4
+
+// Probe address of register Vr (reward and done probes read memory below MEMORY_SIZE)
+#define VECENV_REGISTER(r) (MEMORY_SIZE + (r))
+
+// Bits of the per-environment done flags
+#define VECENV_TERMINATED 0x01       // Done probe matched or PC left memory
+#define VECENV_TRUNCATED  0x02       // Episode reached max_frames
+
+// Observation format
+typedef enum {
+    VECENV_OBS_PACKED,               // Framebuffer rows as is: 32 uint64_t, bit 63 = leftmost pixel (256 bytes)
+    VECENV_OBS_PIXELS                // One byte per downsample x downsample block: share of lit pixels, 0-255
+} VecEnvObs;
+
+// Reward term: weight times the change of a byte since the previous step
+typedef struct {
+    uint16_t addr;                   // Memory address or VECENV_REGISTER(r)
+    float weight;                    // Reward per unit of change (the change is a signed 8-bit difference)
+} VecEnvReward;
+
+// Environment description shared by every copy
+typedef struct {
+    const char *rom;                 // ROM file
+    uint32_t count;                  // Number of environments
+    VecEnvObs obs;                   // Observation format
+    uint32_t downsample;             // VECENV_OBS_PIXELS block size: 1, 2, 4 or 8
+    bool flicker;                    // OR the last two frames of a step into the observation
+    VecEnvReward rewards[VECENV_MAX_REWARDS];
+    uint32_t reward_count;           // Reward terms used
+    uint16_t done_addr;              // Probe address of the terminal condition (0 = none)
+    uint8_t done_value;              // Episode terminates when the probe reads this value
+    uint32_t max_frames;             // Episodes are truncated after this many frames (0 = never)
+    uint32_t noop_max;               // Up to this many keyless frames after a reset, picked by the seed
+    bool skip_idle;                  // As chip8->skip_idle
+} VecEnvConfig;
+
+// N copies of one ROM stepped together (see vecenv.c)
+typedef struct {
+    VecEnvConfig config;             // Copy of the configuration (`rom` is not kept)
+    uint32_t count;                  // Number of environments
+    size_t obs_size;                 // Bytes of one environment's observation
+    Chip8 *vm;                       // One machine per environment
+    uint8_t image[MEMORY_SIZE];      // Memory after loading the ROM: every episode starts from it
+    uint16_t spread[256];            // Lit pixels per block of a framebuffer byte, one bit field per block
+    uint8_t *pixels;                 // Observation bytes of a framebuffer byte's summed fields
+    uint8_t *probes;                 // Reward probe values at the previous step, [env][term]
+    uint32_t *frames;                // Frames run in each environment's current episode
+    uint32_t *seeds;                 // Seed of each environment's current episode
+    uint64_t total_frames;           // Frames run by all environments (no-op starts included)
+} VecEnv;
+
+// Allocate and load the environments (not reset yet); false on bad configuration or out of memory
+bool vecenv_init(VecEnv *env, const VecEnvConfig *config);
+
+// Free everything vecenv_init allocated
+void vecenv_free(VecEnv *env);
+
+// Heap-allocated environment for language bindings; NULL on failure
+VecEnv *vecenv_create(const VecEnvConfig *config);
+void vecenv_destroy(VecEnv *env);
+
+// Bytes of one environment's observation
+size_t vecenv_obs_size(const VecEnv *env);
+
+// Start a new episode in every environment; `seeds` may be NULL (seed = index); obs may be NULL
+void vecenv_reset(VecEnv *env, const uint32_t *seeds, uint8_t *obs);
+
+// Hold actions[i] (bit k = key k) for `frame_skip` frames in every environment, reset finished ones
+void vecenv_step(VecEnv *env, const uint16_t *actions, uint32_t frame_skip, uint8_t *obs, float *rewards,
+                 uint8_t *dones);
+
+#endif
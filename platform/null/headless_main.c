@@ -0,0 +1,156 @@
+/**
+ * headless_main.c
+ *
+ * Entry point of `chip8-headless`, the emulator built without SDL for
+ * batch servers and containers. Runs on the null platform: nothing is
+ * displayed or played, keys come from an optional script, and frames run
+ * back to back as fast as the host allows (no 60Hz pacing).
+ *
+ * After the run, the instruction rate is reported and, with --dump-display,
+ * the last presented framebuffer is printed ('#' lit, '.' unlit).
+ *
+ * --test behaves like `chip8 --test` (10 instructions per frame, dump on
+ * RET), so the Python suite can run against this binary (CHIP8_EXE).
+ *
+ * --seed and --libc-rand pick the random numbers of Cxkk as in `chip8`.
+ *
+ * Usage:
+ *     chip8-headless <ROM file> [--frames N] [--keys FILE] [--dump-display]
+ *                    [--test] [--jit] [--no-skip-idle] [--seed N] [--libc-rand]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "chip8.h"
+#include "jit.h"
+#include "platform.h"
+#include "display.h"
+#include "rng.h"
+
+#define DEFAULT_FRAMES 600               // Ten emulated seconds
+#define TEST_CYCLES_PER_FRAME 10         // Same budget as `chip8 --test`
+#define TEST_FRAMES 10
+
+static const char usage[] =
+    "Usage: %s <ROM file> [--frames N] [--keys FILE] [--dump-display] [--test] [--jit] [--no-skip-idle]\n"
+    "       [--seed N] [--libc-rand]\n";
+
+/**
+ * Prints a packed framebuffer as text, one line per row.
+ */
+static void dump_display(const uint64_t *rows) {
+    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+        char line[DISPLAY_WIDTH + 1];
+        for (int x = 0; x < DISPLAY_WIDTH; x++) {
+            line[x] = (rows[y] >> (63 - x)) & 1 ? '#' : '.';
+        }
+        line[DISPLAY_WIDTH] = '\0';
+        puts(line);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    long frames = DEFAULT_FRAMES;
+    const char *keys = NULL;
+    bool dump = false;
+    bool test_mode = false;
+    bool use_jit = false;
+    bool skip_idle = true;
+    bool libc_rand = false;
+    uint64_t seed = RNG_DEFAULT_SEED;
+
+    if (argc < 2) {
+        fprintf(stderr, usage, argv[0]);
+        return EXIT_FAILURE;
+    }
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = strtol(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--keys") == 0 && i + 1 < argc) {
+            keys = argv[++i];
+        } else if (strcmp(argv[i], "--dump-display") == 0) {
+            dump = true;
+        } else if (strcmp(argv[i], "--test") == 0) {
+            test_mode = true;
+        } else if (strcmp(argv[i], "--jit") == 0) {
+            use_jit = true;
+        } else if (strcmp(argv[i], "--no-skip-idle") == 0) {
+            skip_idle = false;
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--libc-rand") == 0) {
+            libc_rand = true;
+        } else {
+            fprintf(stderr, usage, argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (frames <= 0) {
+        fprintf(stderr, usage, argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    static Chip8 chip8;
+    Platform platform;
+
+    chip8_init(&chip8);
+    if (!platform_null_init(&platform, keys)) return EXIT_FAILURE;
+
+    // Test mode stays fully headless, exactly like `chip8 --test`
+    if (test_mode) {
+        chip8.test_mode = true;
+        chip8.cpu_hz = TEST_CYCLES_PER_FRAME * TIMER_FREQUENCY;
+    } else {
+        chip8.platform = &platform;
+    }
+
+    chip8.skip_idle = skip_idle;
+    chip8.libc_rand = libc_rand;
+    chip8_seed(&chip8, seed);
+
+    // Store ROM path (used for dumping results in test mode)
+    strncpy(chip8.rom_path, argv[1], sizeof(chip8.rom_path) - 1);
+    chip8.rom_path[sizeof(chip8.rom_path) - 1] = '\0';
+
+    if (chip8_load_rom(&chip8, argv[1])) {
+        fprintf(stderr, "Failed to load ROM: %s\n", argv[1]);
+        platform_quit(&platform);
+        return EXIT_FAILURE;
+    }
+
+    if (use_jit) {
+        jit_enable(&chip8, test_mode ? 1 : JIT_HOT_THRESHOLD);
+    }
+
+    // Test mode: RET calls test_halt(), which writes the dump and exits
+    if (test_mode) {
+        for (int frame = 0; frame < TEST_FRAMES; frame++) {
+            chip8_run(&chip8, TEST_CYCLES_PER_FRAME);
+        }
+        platform_quit(&platform);
+        return EXIT_SUCCESS;
+    }
+
+    clock_t start = clock();
+    for (long frame = 0; frame < frames; frame++) {
+        Chip8Frame result = chip8_run_frame(&chip8);
+        if (result.draw) update_display(&chip8);
+    }
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    uint64_t presents = 0, beep_edges = 0;
+    platform_null_counters(&platform, &presents, &beep_edges);
+
+    printf("%ld frames, %llu instructions (%llu fast-forwarded) in %.3f s: %.1f M instructions/s\n",
+           frames, (unsigned long long)chip8.cycles, (unsigned long long)chip8.idle_skipped, seconds,
+           seconds > 0 ? (double)chip8.cycles / seconds / 1e6 : 0.0);
+    printf("%llu presents, %llu beep edges\n", (unsigned long long)presents, (unsigned long long)beep_edges);
+
+    if (dump) dump_display(platform_null_framebuffer(&platform));
+
+    platform_quit(&platform);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,223 @@
+/**
+ * platform_null.c
+ *
+ * Headless backend for batch hosts and containers: no window, no audio
+ * device, and no dependency beyond the C library.
+ *
+ * - Video: presented rows are copied into a framebuffer that the host can
+ *   read back with `platform_null_framebuffer` (for checks and dumps).
+ * - Audio: beep edges are counted and otherwise ignored.
+ * - Input: key presses and releases are replayed from a script, on a
+ *   virtual clock that advances by one 60Hz frame per read. Runs are
+ *   therefore deterministic and independent of how fast the host is.
+ *
+ * Key script format, one event per line (blank lines and '#' comments are
+ * ignored), times in milliseconds from the start of the run:
+ *
+ *     # time  key  state
+ *     500     5    down
+ *     650     5    up
+ */
+
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DISPLAY_HEIGHT 32
+#define KEYPAD_SIZE 16
+
+#define NULL_FRAME_US (1000000 / 60)   // Virtual time per input read (one 60Hz frame)
+#define SCRIPT_LINE_MAX 128
+
+// Backend state shared by all callbacks through `ctx`
+typedef struct {
+    uint64_t rows[DISPLAY_HEIGHT]; // Last presented framebuffer
+    uint64_t presents;            // update_display/update_rows calls
+    uint64_t beep_edges;          // Beep starts and stops reported by the core
+
+    InputEvent *script;           // Scripted key events, in time order
+    size_t script_count;
+    size_t script_next;           // Next event to deliver
+    uint64_t now_us;              // Virtual host clock (advanced by each read)
+} NullPlatform;
+
+static void null_update_display(void *ctx, const uint64_t *rows);
+static void null_update_rows(void *ctx, const uint64_t *rows, uint32_t damage);
+static size_t null_read_input(void *ctx, InputEvent *events, size_t max, uint64_t *now_us);
+static void null_beep_edge(void *ctx, bool active, uint64_t time_us);
+static void null_quit(void *ctx);
+
+/**
+ * Parse a key script into `null->script`.
+ *
+ * @return true on success; on failure an error naming the line is printed.
+ */
+static bool load_script(NullPlatform *null, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "[NULL] Cannot open key script: %s\n", path);
+        return false;
+    }
+
+    char line[SCRIPT_LINE_MAX];
+    size_t capacity = 0;
+    int line_number = 0;
+    bool ok = true;
+
+    while (ok && fgets(line, sizeof(line), file)) {
+        line_number++;
+
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+
+        unsigned long long time_ms;
+        unsigned int key;
+        char state[8];
+        char extra;
+        int fields = sscanf(line, "%llu %x %7s %c", &time_ms, &key, state, &extra);
+
+        if (fields <= 0) continue;  // Blank or comment-only line
+
+        bool down = strcmp(state, "down") == 0;
+        uint64_t time_us = (uint64_t)time_ms * 1000;
+
+        if (fields != 3 || key >= KEYPAD_SIZE || (!down && strcmp(state, "up") != 0)) {
+            fprintf(stderr, "[NULL] %s:%d: expected '<ms> <key 0-F> down|up'\n", path, line_number);
+            ok = false;
+        } else if (null->script_count && time_us < null->script[null->script_count - 1].time_us) {
+            fprintf(stderr, "[NULL] %s:%d: events must be in time order\n", path, line_number);
+            ok = false;
+        } else {
+            if (null->script_count == capacity) {
+                capacity = capacity ? capacity * 2 : 64;
+                InputEvent *grown = realloc(null->script, capacity * sizeof(InputEvent));
+                if (!grown) {
+                    fprintf(stderr, "[NULL] Out of memory reading %s\n", path);
+                    ok = false;
+                    break;
+                }
+                null->script = grown;
+            }
+            null->script[null->script_count++] = (InputEvent){ .time_us = time_us, .key = (uint8_t)key, .down = down };
+        }
+    }
+
+    fclose(file);
+    return ok;
+}
+
+/**
+ * Initialize the headless backend.
+ *
+ * @param platform   Filled in with the null backend's callbacks.
+ * @param key_script Path of a key script to replay, or NULL for no input.
+ * @return           true on success, false if the script cannot be read.
+ */
+bool platform_null_init(Platform *platform, const char *key_script) {
+    *platform = (Platform){0};
+
+    NullPlatform *null = calloc(1, sizeof(NullPlatform));
+    if (!null) {
+        fprintf(stderr, "[NULL] Out of memory\n");
+        return false;
+    }
+
+    if (key_script && !load_script(null, key_script)) {
+        free(null->script);
+        free(null);
+        return false;
+    }
+
+    *platform = (Platform){
+        .ctx = null,
+        .update_display = null_update_display,
+        .update_rows = null_update_rows,
+        .read_input = null_read_input,
+        .beep_edge = null_beep_edge,
+        .quit = null_quit,
+    };
+    return true;
+}
+
+/**
+ * Framebuffer as last presented to a null platform (all rows clear before
+ * the first present).
+ *
+ * @return 32 packed rows (bit 63 = leftmost pixel), or NULL if `platform`
+ *         is not a null backend.
+ */
+const uint64_t *platform_null_framebuffer(const Platform *platform) {
+    if (!platform || platform->quit != null_quit) return NULL;
+    return ((const NullPlatform *)platform->ctx)->rows;
+}
+
+/**
+ * Present and beep counters of a null platform.
+ *
+ * @param presents   Receives the number of display updates (may be NULL).
+ * @param beep_edges Receives the number of beep starts and stops (may be NULL).
+ */
+void platform_null_counters(const Platform *platform, uint64_t *presents, uint64_t *beep_edges) {
+    if (!platform || platform->quit != null_quit) return;
+
+    const NullPlatform *null = platform->ctx;
+    if (presents) *presents = null->presents;
+    if (beep_edges) *beep_edges = null->beep_edges;
+}
+
+/**
+ * Keep a copy of the whole framebuffer.
+ */
+static void null_update_display(void *ctx, const uint64_t *rows) {
+    null_update_rows(ctx, rows, PLATFORM_ALL_ROWS);
+}
+
+/**
+ * Keep a copy of the damaged rows; the others are unchanged.
+ */
+static void null_update_rows(void *ctx, const uint64_t *rows, uint32_t damage) {
+    NullPlatform *null = ctx;
+
+    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+        if (damage & (1u << y)) null->rows[y] = rows[y];
+    }
+    null->presents++;
+}
+
+/**
+ * Advance the virtual clock by one frame and deliver the scripted events
+ * that fall in it (at most `max`; the rest wait for the next read).
+ */
+static size_t null_read_input(void *ctx, InputEvent *events, size_t max, uint64_t *now_us) {
+    NullPlatform *null = ctx;
+
+    null->now_us += NULL_FRAME_US;
+    *now_us = null->now_us;
+
+    size_t count = 0;
+    while (count < max && null->script_next < null->script_count &&
+           null->script[null->script_next].time_us <= null->now_us) {
+        events[count++] = null->script[null->script_next++];
+    }
+    return count;
+}
+
+/**
+ * Count a beep start or stop; there is no audio output.
+ */
+static void null_beep_edge(void *ctx, bool active, uint64_t time_us) {
+    NullPlatform *null = ctx;
+    (void)active;
+    (void)time_us;
+    null->beep_edges++;
+}
+
+/**
+ * Free the backend state.
+ */
+static void null_quit(void *ctx) {
+    NullPlatform *null = ctx;
+    free(null->script);
+    free(null);
+}
@@ -2,6 +2,7 @@
 #include <SDL.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -11,13 +12,74 @@
 #define SCALE 10
 #define KEYPAD_SIZE 16
 
-// SDL objects for window and rendering
-static SDL_Window* window = NULL;
-static SDL_Renderer* renderer = NULL;
+#define DEFAULT_BACKGROUND 0x000000   // Unlit pixels (0xRRGGBB)
+#define DEFAULT_FOREGROUND 0xFFFFFF   // Lit pixels (0xRRGGBB)
 
-// Audio playback objects
-static SDL_AudioDeviceID audio_device = 0;
-static bool audio_initialized = false;
+#define AUDIO_RATE 44100             // Output sample rate (unsigned 8-bit mono)
+#define AUDIO_BUFFER 512              // Samples per audio callback
+#define TONE_PERIOD (AUDIO_RATE / 440)  // Square wave period in samples (440Hz)
+#define AUDIO_LATENCY 2048            // Samples between an edge's emulated time and its playback
+#define AUDIO_MAX_LEAD (AUDIO_RATE / 4) // Edges further ahead than this re-anchor the timeline
+#define BEEP_RING_SIZE 256            // Beep edges in flight (power of two)
+
+#define RENDER_SLOTS 3                // Triple buffer: one slot each for writer, reader and hand-over
+#define SLOT_FRESH 4                  // Set in the hand-over index while it holds an untaken frame
+#define RENDER_WAIT_MS 100            // Longest render thread sleep before re-checking for stop
+
+// A beep start/stop handed from the emulator thread to the audio callback
+typedef struct {
+    uint64_t time_us;             // Emulated time of the edge
+    bool active;
+} BeepEdge;
+
+// A framebuffer handed from the emulator thread to the render thread
+typedef struct {
+    uint64_t rows[DISPLAY_HEIGHT];
+    Uint64 published;             // SDL_GetPerformanceCounter() when it was handed over
+} RenderSlot;
+
+// Backend state, owned by the Platform that platform_sdl_init fills in
+typedef struct {
+    // SDL objects for window and rendering
+    SDL_Window* window;
+    SDL_Renderer* renderer;
+    SDL_Texture* screen;          // 64x32 ARGB streaming texture, scaled to the window on present
+
+    // Framebuffer expansion (1 bit per pixel -> ARGB8888)
+    uint32_t expand[256][8];      // Row byte -> its 8 pixels in the current palette
+    uint32_t pixels[DISPLAY_WIDTH * DISPLAY_HEIGHT];  // Expanded framebuffer
+    uint64_t rows[DISPLAY_HEIGHT];  // Packed rows last received, re-expanded on palette change
+
+    // Render thread (platform_sdl_start_renderer); NULL while presenting on the caller's thread
+    SDL_Thread* render_thread;
+    SDL_sem* render_wake;         // Posted on every published frame and on stop
+    SDL_sem* render_ready;        // Posted once the render thread has (or failed to get) a renderer
+    SDL_atomic_t render_stop;
+    bool render_ok;               // The render thread created its renderer
+    RenderSlot slots[RENDER_SLOTS];
+    SDL_atomic_t handover;        // Slot between the threads, | SLOT_FRESH when not yet taken
+    int back;                     // Slot the emulator thread fills next (emulator thread only)
+    int front;                    // Slot being presented (render thread only)
+    PlatformRenderStats stats;    // published/dropped: emulator thread; the rest: render thread
+    double latency_total_ms;
+
+    // Audio playback objects
+    SDL_AudioDeviceID audio_device;
+    bool audio_initialized;
+
+    // Beep edges: single-producer (emulator thread) single-consumer (audio callback) ring
+    BeepEdge beep_ring[BEEP_RING_SIZE];
+    SDL_atomic_t beep_head;       // Next edge to play (written by the audio callback)
+    SDL_atomic_t beep_tail;       // Next free entry (written by the emulator thread)
+    uint64_t beep_overflows;      // Edges dropped because the ring was full (emulator thread)
+
+    // Tone synthesis, touched only by the audio callback
+    bool tone_on;
+    bool timeline_anchored;       // play_sample is tied to the emulated clock
+    int phase;                    // Square wave position
+    int64_t play_sample;          // Emulated time of the next output sample, in samples
+    int64_t last_edge_sample;     // Emulated time of the last edge played
+} SdlPlatform;
 
 // Mapping modern keyboard keys to CHIP-8 keypad layout
 static const SDL_Scancode keymap[KEYPAD_SIZE] = {
@@ -39,58 +101,180 @@ static const SDL_Scancode keymap[KEYPAD_SIZE] = {
     SDL_SCANCODE_V     // F
 };
 
+static void sdl_update_display(void *ctx, const uint64_t *rows);
+static void sdl_update_rows(void *ctx, const uint64_t *rows, uint32_t damage);
+static size_t sdl_read_input(void *ctx, InputEvent *events, size_t max, uint64_t *now_us);
+static void sdl_wait_input(void *ctx, uint32_t timeout_ms);
+static void sdl_beep_edge(void *ctx, bool active, uint64_t time_us);
+static void sdl_quit(void *ctx);
+static void stop_render_thread(SdlPlatform *sdl);
+
+/**
+ * Create the renderer and the screen texture on the calling thread.
+ *
+ * SDL expects a renderer to be used only from the thread that created it,
+ * so the render thread creates its own.
+ *
+ * @return true on success; on failure nothing is left allocated.
+ */
+static bool create_renderer(SdlPlatform *sdl) {
+    sdl->renderer = SDL_CreateRenderer(sdl->window, -1,
+                                       SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    if (!sdl->renderer) {
+        fprintf(stderr, "[SDL] Failed to create renderer: %s\n", SDL_GetError());
+        return false;
+    }
+
+    // One texel per CHIP-8 pixel; scaled up to the window (nearest neighbour) when presented
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");
+    sdl->screen = SDL_CreateTexture(sdl->renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+                                    DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    if (!sdl->screen) {
+        fprintf(stderr, "[SDL] Failed to create screen texture: %s\n", SDL_GetError());
+        SDL_DestroyRenderer(sdl->renderer);
+        sdl->renderer = NULL;
+        return false;
+    }
+
+    return true;
+}
+
 /**
- * Initialize SDL subsystems and create window/renderer.
+ * Release the renderer and the screen texture (on the thread that created them).
  */
-void platform_init(void) {
-    SDL_setenv("SDL_AUDIODRIVER", "directsound", 1);  // Force DirectSound
+static void destroy_renderer(SdlPlatform *sdl) {
+    if (sdl->screen) SDL_DestroyTexture(sdl->screen);
+    if (sdl->renderer) SDL_DestroyRenderer(sdl->renderer);
+    sdl->screen = NULL;
+    sdl->renderer = NULL;
+}
+
+/**
+ * Initialize SDL subsystems, create the window/renderer, and fill in `platform`.
+ *
+ * SDL video is process-wide, so a process should hold one SDL platform; any
+ * number of Chip8 instances may reference it.
+ *
+ * @param platform Backend to fill in.
+ * @return         true on success, false if SDL or the window failed to start.
+ */
+bool platform_sdl_init(Platform *platform) {
+    if (!platform) {
+        fprintf(stderr, "[SDL] platform_sdl_init called with null platform\n");
+        return false;
+    }
+
+    SdlPlatform *sdl = calloc(1, sizeof(SdlPlatform));
+    if (!sdl) {
+        fprintf(stderr, "[SDL] Out of memory\n");
+        return false;
+    }
+
+    *platform = (Platform){
+        .ctx = sdl,
+        .update_display = sdl_update_display,
+        .update_rows = sdl_update_rows,
+        .read_input = sdl_read_input,
+        .wait_input = sdl_wait_input,
+        .beep_edge = sdl_beep_edge,
+        .quit = sdl_quit,
+    };
+
+    SDL_setenv("SDL_AUDIODRIVER", "directsound", 0);  // DirectSound unless a driver was picked
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
         fprintf(stderr, "[SDL] Initialization failed: %s\n", SDL_GetError());
-        exit(1);
+        platform_quit(platform);
+        return false;
     }
 
-    window = SDL_CreateWindow("CHIP-8 Emulator",
+    sdl->window = SDL_CreateWindow("CHIP-8 Emulator",
                               SDL_WINDOWPOS_CENTERED,
                               SDL_WINDOWPOS_CENTERED,
                               DISPLAY_WIDTH * SCALE,
                               DISPLAY_HEIGHT * SCALE,
                               SDL_WINDOW_SHOWN);
-    if (!window) {
+    if (!sdl->window) {
         fprintf(stderr, "[SDL] Failed to create window: %s\n", SDL_GetError());
-        exit(1);
+        platform_quit(platform);
+        return false;
     }
 
-    renderer = SDL_CreateRenderer(window, -1,
-                                  SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
-    if (!renderer) {
-        fprintf(stderr, "[SDL] Failed to create renderer: %s\n", SDL_GetError());
-        exit(1);
+    if (!create_renderer(sdl)) {
+        platform_quit(platform);
+        return false;
     }
 
+    platform_sdl_set_palette(platform, DEFAULT_BACKGROUND, DEFAULT_FOREGROUND);
+
     // Optional: audio is initialized lazily
+    return true;
+}
+
+/**
+ * Emulated time of a beep edge, in output samples.
+ */
+static inline int64_t edge_sample(const BeepEdge *edge) {
+    return (int64_t)(edge->time_us * AUDIO_RATE / 1000000);
 }
 
 /**
- * SDL audio callback to generate a simple square wave tone.
+ * SDL audio callback: render the beep from the timestamped edges.
+ *
+ * Output samples are placed on the emulated clock: `play_sample` is the
+ * emulated time of the next sample, anchored AUDIO_LATENCY samples behind
+ * the first edge, so each edge takes effect on the exact sample it was
+ * stamped with. The tone restarts at phase 0 on every start edge.
+ *
+ * The timeline is re-anchored (to AUDIO_LATENCY before an edge) when an
+ * edge goes back in time (the VM was reset), arrives more than
+ * AUDIO_LATENCY late, or is more than AUDIO_MAX_LEAD ahead; this absorbs
+ * drift between the host's frame pacing and the audio clock.
+ *
+ * @param userdata The owning SdlPlatform (holds the ring and the wave state).
  */
 static void audio_callback(void *userdata, uint8_t *stream, int len) {
-    static int phase = 0;
-    const int sample_rate = 44100;
-    const int tone_freq = 440;
-    const int period = sample_rate / tone_freq;
-    const int half_period = period / 2;
+    SdlPlatform *sdl = userdata;
+    const int half_period = TONE_PERIOD / 2;
+
+    int head = SDL_AtomicGet(&sdl->beep_head);
+    int tail = SDL_AtomicGet(&sdl->beep_tail);
 
     for (int i = 0; i < len; ++i) {
-        stream[i] = (phase < half_period) ? 128 + 64 : 128 - 64;  // Centered square wave
-        phase = (phase + 1) % period;
+        // Apply every edge due at or before this sample
+        while (head != tail) {
+            const BeepEdge *edge = &sdl->beep_ring[head & (BEEP_RING_SIZE - 1)];
+            int64_t at = edge_sample(edge);
+
+            if (!sdl->timeline_anchored || at < sdl->last_edge_sample ||
+                at + AUDIO_LATENCY < sdl->play_sample || at > sdl->play_sample + AUDIO_MAX_LEAD) {
+                sdl->play_sample = at - AUDIO_LATENCY;
+                sdl->timeline_anchored = true;
+            }
+            if (at > sdl->play_sample) break;
+
+            if (edge->active && !sdl->tone_on) sdl->phase = 0;
+            sdl->tone_on = edge->active;
+            sdl->last_edge_sample = at;
+            head++;
+        }
+
+        if (sdl->tone_on) {
+            stream[i] = (sdl->phase < half_period) ? 128 + 64 : 128 - 64;  // Centered square wave
+            sdl->phase = (sdl->phase + 1) % TONE_PERIOD;
+        } else {
+            stream[i] = 128;  // Silence
+        }
+        sdl->play_sample++;
     }
+
+    SDL_AtomicSet(&sdl->beep_head, head);
 }
 
 /**
  * Set up SDL audio playback if not already initialized.
  */
-static void init_audio() {
-    if (audio_initialized) return;
+static void init_audio(SdlPlatform *sdl) {
+    if (sdl->audio_initialized) return;
 
     if (!(SDL_WasInit(SDL_INIT_AUDIO) & SDL_INIT_AUDIO)) {
         fprintf(stderr, "[SDL] Audio not initialized. Skipping.\n");
@@ -98,104 +282,423 @@ static void init_audio() {
     }
 
     SDL_AudioSpec desired_spec = {0};
-    desired_spec.freq = 44100;
+    desired_spec.freq = AUDIO_RATE;
     desired_spec.format = AUDIO_U8;
     desired_spec.channels = 1;
-    desired_spec.samples = 512;
+    desired_spec.samples = AUDIO_BUFFER;
     desired_spec.callback = audio_callback;
+    desired_spec.userdata = sdl;
 
     // Try first available audio device, fallback to default
     const char *device_name = SDL_GetAudioDeviceName(0, 0);
     if (device_name) {
-        audio_device = SDL_OpenAudioDevice(device_name, 0, &desired_spec, NULL, 0);
+        sdl->audio_device = SDL_OpenAudioDevice(device_name, 0, &desired_spec, NULL, 0);
     }
-    if (!audio_device && SDL_GetError()[0]) {
-        fprintf(stderr, "[SDL] Named device failed: %s. Trying NULL...\n", SDL_GetError());
-        audio_device = SDL_OpenAudioDevice(NULL, 0, &desired_spec, NULL, 0);
+    if (!sdl->audio_device) {
+        if (device_name) fprintf(stderr, "[SDL] Named device failed: %s. Trying NULL...\n", SDL_GetError());
+        sdl->audio_device = SDL_OpenAudioDevice(NULL, 0, &desired_spec, NULL, 0);
     }
 
-    if (!audio_device) {
+    if (!sdl->audio_device) {
         fprintf(stderr, "[SDL] Audio device init failed: %s\n", SDL_GetError());
     } else {
-        SDL_PauseAudioDevice(audio_device, 1);  // Start paused
-        audio_initialized = true;
+        SDL_PauseAudioDevice(sdl->audio_device, 0);  // Runs from now on; silence between beeps
+        sdl->audio_initialized = true;
     }
 }
 
 /**
- * Render the CHIP-8 framebuffer to the SDL window.
+ * Render the whole CHIP-8 framebuffer to the SDL window.
  *
- * @param pixels  Pointer to 64x32 framebuffer (values should be 0 or 1)
+ * @param rows  Packed 64x32 framebuffer (one word per row, bit 63 = leftmost pixel)
  */
-void platform_update_display(const uint8_t *pixels) {
-    if (!renderer) {
-        fprintf(stderr, "[SDL] platform_update_display called before renderer was initialized\n");
-        return;
+static void sdl_update_display(void *ctx, const uint64_t *rows) {
+    sdl_update_rows(ctx, rows, PLATFORM_ALL_ROWS);
+}
+
+/**
+ * Expand one packed row to 64 ARGB pixels.
+ *
+ * Each byte of the row (leftmost pixels in the top byte) selects a
+ * precomputed run of 8 pixels, so a row costs 8 table lookups and copies
+ * instead of 64 bit tests.
+ */
+static inline void expand_row(const SdlPlatform *sdl, uint64_t row, uint32_t *out) {
+    for (int byte = 0; byte < 8; byte++) {
+        memcpy(out + 8 * byte, sdl->expand[(row >> (56 - 8 * byte)) & 0xFF], sizeof(sdl->expand[0]));
     }
+}
 
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255); // Clear to black
-    SDL_RenderClear(renderer);
+/**
+ * Expand the damaged rows, upload them to the screen texture and present it
+ * (on the thread that owns the renderer).
+ *
+ * Only the band of texture rows from the first to the last damaged row is
+ * locked; the locked pixels are write-only, so the whole band is copied from
+ * the expanded framebuffer. The window back buffer is not preserved across
+ * presents, so the texture is always copied in full (a single scaled blit).
+ *
+ * @param rows   Packed 64x32 framebuffer (one word per row, bit 63 = leftmost pixel)
+ * @param damage Rows to redraw (bit y = row y)
+ */
+static void render_rows(SdlPlatform *sdl, const uint64_t *rows, uint32_t damage) {
+    SDL_Renderer *renderer = sdl->renderer;
 
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255); // White for pixels
+    if (!renderer || !sdl->screen) {
+        fprintf(stderr, "[SDL] render_rows called before renderer was initialized\n");
+        return;
+    }
 
-    // Draw each pixel as a filled rectangle
+    int first = DISPLAY_HEIGHT, last = -1;
     for (int y = 0; y < DISPLAY_HEIGHT; y++) {
-        for (int x = 0; x < DISPLAY_WIDTH; x++) {
-            if (pixels[y * DISPLAY_WIDTH + x]) {
-                SDL_Rect pixel = {
-                    .x = x * SCALE,
-                    .y = y * SCALE,
-                    .w = SCALE,
-                    .h = SCALE
-                };
-                SDL_RenderFillRect(renderer, &pixel);
+        if (!((damage >> y) & 1)) continue;
+
+        sdl->rows[y] = rows[y];
+        expand_row(sdl, rows[y], &sdl->pixels[y * DISPLAY_WIDTH]);
+        if (first > y) first = y;
+        last = y;
+    }
+
+    if (last >= 0) {
+        SDL_Rect band = { .x = 0, .y = first, .w = DISPLAY_WIDTH, .h = last - first + 1 };
+        void *texels;
+        int pitch;
+
+        if (SDL_LockTexture(sdl->screen, &band, &texels, &pitch) == 0) {
+            for (int y = first; y <= last; y++) {
+                memcpy((uint8_t *)texels + (size_t)(y - first) * (size_t)pitch,
+                       &sdl->pixels[y * DISPLAY_WIDTH], DISPLAY_WIDTH * sizeof(uint32_t));
             }
+            SDL_UnlockTexture(sdl->screen);
+        } else {
+            fprintf(stderr, "[SDL] Failed to lock screen texture: %s\n", SDL_GetError());
         }
     }
 
+    SDL_RenderCopy(renderer, sdl->screen, NULL, NULL);  // Scale to the window
     SDL_RenderPresent(renderer);  // Show the updated frame
 }
 
 /**
- * Start or stop the system beep depending on `play`.
+ * Hand a finished framebuffer to the render thread (emulator thread side).
+ *
+ * Lock-free triple buffer: the frame is written to the private back slot,
+ * which is then swapped with the hand-over slot in one atomic exchange. If
+ * the render thread had not taken the previous frame yet, that frame is
+ * dropped (counted) and its slot becomes the new back slot. Never blocks.
+ */
+static void publish_rows(SdlPlatform *sdl, const uint64_t *rows) {
+    RenderSlot *slot = &sdl->slots[sdl->back];
+    memcpy(slot->rows, rows, sizeof(slot->rows));
+    slot->published = SDL_GetPerformanceCounter();
+
+    int previous = SDL_AtomicSet(&sdl->handover, sdl->back | SLOT_FRESH);
+    sdl->back = previous & ~SLOT_FRESH;
+
+    sdl->stats.published++;
+    if (previous & SLOT_FRESH) sdl->stats.dropped++;
+
+    SDL_SemPost(sdl->render_wake);
+}
+
+/**
+ * Render thread: presents the newest published frame whenever one arrives.
+ *
+ * Owns the renderer, so vsync waits and slow presents block only this
+ * thread. Damage is recomputed against the last presented rows, since
+ * frames in between may have been dropped.
+ */
+static int render_thread_main(void *data) {
+    SdlPlatform *sdl = data;
+
+    sdl->render_ok = create_renderer(sdl);
+    SDL_SemPost(sdl->render_ready);
+    if (!sdl->render_ok) return 1;
+
+    const double ms_per_tick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+    bool full = true;  // The new texture holds nothing yet
+
+    while (!SDL_AtomicGet(&sdl->render_stop)) {
+        SDL_SemWaitTimeout(sdl->render_wake, RENDER_WAIT_MS);
+        if (!(SDL_AtomicGet(&sdl->handover) & SLOT_FRESH)) continue;
+
+        // Take the fresh frame, leaving the slot just presented for the emulator thread
+        sdl->front = SDL_AtomicSet(&sdl->handover, sdl->front) & ~SLOT_FRESH;
+        const RenderSlot *slot = &sdl->slots[sdl->front];
+
+        uint32_t damage = full ? PLATFORM_ALL_ROWS : 0;
+        for (int y = 0; y < DISPLAY_HEIGHT && !full; y++) {
+            if (slot->rows[y] != sdl->rows[y]) damage |= 1u << y;
+        }
+        full = false;
+
+        render_rows(sdl, slot->rows, damage);
+
+        double latency = (double)(SDL_GetPerformanceCounter() - slot->published) * ms_per_tick;
+        sdl->stats.presented++;
+        sdl->latency_total_ms += latency;
+        if (latency > sdl->stats.latency_max_ms) sdl->stats.latency_max_ms = latency;
+    }
+
+    destroy_renderer(sdl);
+    return 0;
+}
+
+/**
+ * Stop and join the render thread, if any. The renderer is left destroyed.
  */
-void platform_play_beep(bool play) {
-    if (!audio_initialized) {
-        init_audio();
+static void stop_render_thread(SdlPlatform *sdl) {
+    if (sdl->render_thread) {
+        SDL_AtomicSet(&sdl->render_stop, 1);
+        SDL_SemPost(sdl->render_wake);
+        SDL_WaitThread(sdl->render_thread, NULL);
+        sdl->render_thread = NULL;
     }
 
-    if (audio_device) {
-        SDL_PauseAudioDevice(audio_device, play ? 0 : 1);
+    if (sdl->render_wake) SDL_DestroySemaphore(sdl->render_wake);
+    if (sdl->render_ready) SDL_DestroySemaphore(sdl->render_ready);
+    sdl->render_wake = NULL;
+    sdl->render_ready = NULL;
+}
+
+/**
+ * Present the damaged rows: directly, or through the render thread if running.
+ */
+static void sdl_update_rows(void *ctx, const uint64_t *rows, uint32_t damage) {
+    SdlPlatform *sdl = ctx;
+
+    if (sdl->render_thread) {
+        publish_rows(sdl, rows);
+    } else {
+        render_rows(sdl, rows, damage);
     }
 }
 
 /**
- * Poll the current keyboard state and update the CHIP-8 keypad.
+ * Move presentation to a dedicated render thread.
+ *
+ * From here on `update_display`/`update_rows` only copy the framebuffer into
+ * a triple buffer, so vsync and present latency no longer stall the thread
+ * running the emulator. The window stays on the calling thread, which must
+ * keep pumping events (read_input/wait_input).
  *
- * @param keypad Pointer to CHIP-8's 16-key state array (0 or 1 per key)
+ * @param platform Backend filled in by `platform_sdl_init`.
+ * @return         true if the render thread is running; false if it could not
+ *                 start, in which case frames are still presented directly.
  */
-void platform_poll_input(uint8_t *keypad) {
-    SDL_PumpEvents();  // Update SDL internal input state
+bool platform_sdl_start_renderer(Platform *platform) {
+    if (!platform || !platform->ctx) {
+        fprintf(stderr, "[SDL] platform_sdl_start_renderer called without an SDL platform\n");
+        return false;
+    }
+
+    SdlPlatform *sdl = platform->ctx;
+    if (sdl->render_thread) return true;
+
+    // The render thread creates its own renderer
+    destroy_renderer(sdl);
 
-    const Uint8 *keystate = SDL_GetKeyboardState(NULL);
-    if (!keystate) return;
+    memset(&sdl->stats, 0, sizeof(sdl->stats));
+    sdl->latency_total_ms = 0;
+    sdl->back = 0;
+    sdl->front = 1;
+    SDL_AtomicSet(&sdl->handover, 2);
+    SDL_AtomicSet(&sdl->render_stop, 0);
 
-    for (int i = 0; i < KEYPAD_SIZE; i++) {
-        keypad[i] = keystate[keymap[i]] ? 1 : 0;
+    sdl->render_wake = SDL_CreateSemaphore(0);
+    sdl->render_ready = SDL_CreateSemaphore(0);
+    if (sdl->render_wake && sdl->render_ready) {
+        sdl->render_thread = SDL_CreateThread(render_thread_main, "chip8-render", sdl);
+    }
+
+    if (sdl->render_thread) {
+        SDL_SemWait(sdl->render_ready);
+        if (sdl->render_ok) return true;
+    } else {
+        fprintf(stderr, "[SDL] Failed to start render thread: %s\n", SDL_GetError());
     }
+
+    // Fall back to presenting on this thread
+    stop_render_thread(sdl);
+    if (create_renderer(sdl)) render_rows(sdl, sdl->rows, PLATFORM_ALL_ROWS);
+    return false;
 }
 
 /**
- * Clean up all SDL resources.
+ * Stop the render thread and present on the calling thread again.
+ *
+ * @param platform Backend filled in by `platform_sdl_init`.
+ * @param stats    Filled with the render thread's counters if not NULL (all
+ *                 zero if it never ran).
  */
-void platform_quit(void) {
-    if (renderer) SDL_DestroyRenderer(renderer);
-    if (window) SDL_DestroyWindow(window);
+void platform_sdl_stop_renderer(Platform *platform, PlatformRenderStats *stats) {
+    if (!platform || !platform->ctx) {
+        fprintf(stderr, "[SDL] platform_sdl_stop_renderer called without an SDL platform\n");
+        return;
+    }
 
-    SDL_Quit();
+    SdlPlatform *sdl = platform->ctx;
+    if (sdl->render_thread) {
+        stop_render_thread(sdl);
 
-    if (audio_initialized) {
-        SDL_CloseAudioDevice(audio_device);
-        audio_initialized = false;
+        // Show the newest frame, even if the render thread had not taken it yet
+        int handover = SDL_AtomicGet(&sdl->handover);
+        const uint64_t *latest = (handover & SLOT_FRESH) ? sdl->slots[handover & ~SLOT_FRESH].rows : sdl->rows;
+        if (create_renderer(sdl)) render_rows(sdl, latest, PLATFORM_ALL_ROWS);
     }
+
+    if (stats) {
+        *stats = sdl->stats;
+        stats->latency_avg_ms = sdl->stats.presented ? sdl->latency_total_ms / (double)sdl->stats.presented : 0;
+    }
+}
+
+/**
+ * Set the colors of unlit and lit pixels and redraw the window with them.
+ *
+ * @param platform   Backend filled in by `platform_sdl_init`.
+ * @param background Unlit pixel color, 0xRRGGBB.
+ * @param foreground Lit pixel color, 0xRRGGBB.
+ */
+void platform_sdl_set_palette(Platform *platform, uint32_t background, uint32_t foreground) {
+    if (!platform || !platform->ctx) {
+        fprintf(stderr, "[SDL] platform_sdl_set_palette called without an SDL platform\n");
+        return;
+    }
+
+    SdlPlatform *sdl = platform->ctx;
+    if (sdl->render_thread) {
+        fprintf(stderr, "[SDL] platform_sdl_set_palette called while the render thread is running\n");
+        return;
+    }
+
+    uint32_t palette[2] = { 0xFF000000u | background, 0xFF000000u | foreground };
+
+    for (int byte = 0; byte < 256; byte++) {
+        for (int bit = 0; bit < 8; bit++) {
+            sdl->expand[byte][bit] = palette[(byte >> (7 - bit)) & 1];
+        }
+    }
+
+    if (sdl->renderer && sdl->screen) render_rows(sdl, sdl->rows, PLATFORM_ALL_ROWS);
+}
+
+/**
+ * Queue a beep start/stop for the audio callback.
+ *
+ * Opens the audio device on the first edge; after that the device keeps
+ * running and is never paused, and this only appends to the lock-free
+ * ring. Edges are dropped (and counted) if the ring is full.
+ *
+ * @param active  Whether the beep starts (true) or stops (false).
+ * @param time_us Emulated time of the edge, in microseconds since reset.
+ */
+static void sdl_beep_edge(void *ctx, bool active, uint64_t time_us) {
+    SdlPlatform *sdl = ctx;
+
+    int tail = SDL_AtomicGet(&sdl->beep_tail);
+    if (tail - SDL_AtomicGet(&sdl->beep_head) >= BEEP_RING_SIZE) {
+        sdl->beep_overflows++;
+        return;
+    }
+
+    sdl->beep_ring[tail & (BEEP_RING_SIZE - 1)] = (BeepEdge){ .time_us = time_us, .active = active };
+    SDL_AtomicSet(&sdl->beep_tail, tail + 1);  // Publishes the entry to the callback
+
+    if (!sdl->audio_initialized) init_audio(sdl);
+}
+
+/**
+ * Drop every queued event that is not a key press or release.
+ *
+ * Nothing consumes window, mouse or other events (quitting goes through
+ * the signal handler), and left queued they fill SDL's event queue until
+ * it starts discarding new key events.
+ */
+static void flush_non_key_events(void) {
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_KEYDOWN - 1);
+    SDL_FlushEvents(SDL_KEYUP + 1, SDL_LASTEVENT);
+}
+
+/**
+ * Take the keypad presses and releases off SDL's event queue.
+ *
+ * Called once per frame by the core. Keyboard events are removed oldest
+ * first and at most `max` (the rest stay queued for the next frame); all
+ * other events are dropped. Key repeats and keys outside the keypad map
+ * are skipped.
+ * Timestamps are SDL event times, converted to microseconds on the same
+ * clock as `now_us`.
+ *
+ * @param events Receives the keypad events
+ * @param max    Capacity of `events`
+ * @param now_us Receives the current host time
+ * @return       Number of events stored
+ */
+static size_t sdl_read_input(void *ctx, InputEvent *events, size_t max, uint64_t *now_us) {
+    (void)ctx;  // The event queue is global to SDL
+
+    SDL_PumpEvents();  // Move pending OS input into SDL's queue
+    flush_non_key_events();
+    *now_us = (uint64_t)SDL_GetTicks() * 1000;
+
+    size_t count = 0;
+    SDL_Event event;
+
+    while (count < max && SDL_PeepEvents(&event, 1, SDL_GETEVENT, SDL_KEYDOWN, SDL_KEYUP) == 1) {
+        if (event.key.repeat) continue;
+
+        for (uint8_t key = 0; key < KEYPAD_SIZE; key++) {
+            if (event.key.keysym.scancode != keymap[key]) continue;
+
+            events[count++] = (InputEvent){
+                .time_us = (uint64_t)event.key.timestamp * 1000,
+                .key = key,
+                .down = event.type == SDL_KEYDOWN,
+            };
+            break;
+        }
+    }
+    return count;
+}
+
+/**
+ * Sleep until SDL has a new event or `timeout_ms` passes.
+ *
+ * Returns at once if key events are already queued (they are the next
+ * frame's input). Other events are dropped first; otherwise the wait
+ * would return immediately. The event
+ * that ends the wait stays queued and is picked up by the next
+ * `sdl_read_input`.
+ *
+ * @param timeout_ms Longest time to sleep, in milliseconds
+ */
+static void sdl_wait_input(void *ctx, uint32_t timeout_ms) {
+    (void)ctx;  // The event queue is global to SDL
+
+    SDL_PumpEvents();
+    if (SDL_HasEvents(SDL_KEYDOWN, SDL_KEYUP)) return;
+
+    flush_non_key_events();
+    SDL_WaitEventTimeout(NULL, (int)timeout_ms);
+}
+
+/**
+ * Clean up all SDL resources and free the backend state.
+ */
+static void sdl_quit(void *ctx) {
+    SdlPlatform *sdl = ctx;
+
+    // Close audio first so the callback stops before its userdata is freed
+    if (sdl->audio_initialized) {
+        SDL_CloseAudioDevice(sdl->audio_device);
+        sdl->audio_initialized = false;
+    }
+
+    stop_render_thread(sdl);
+    destroy_renderer(sdl);
+    if (sdl->window) SDL_DestroyWindow(sdl->window);
+
+    SDL_Quit();
+    free(sdl);
 }
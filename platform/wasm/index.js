@@ -8,8 +8,10 @@
  * - Maps physical keyboard input to CHIP-8 keypad state
  * - Renders the emulator's 64x32 framebuffer to an HTML canvas
  * - Loads ROMs via file picker or HTTP from /roms/
- * - Bridges WebAssembly exports (`wasm_init`, `wasm_cycle`, `wasm_load_rom`)
- * - Runs a frame-locked main emulation loop (approx. 700Hz)
+ * - Bridges WebAssembly exports (`wasm_init`, `wasm_cycle`, `wasm_waiting`,
+ *   `wasm_load_rom`) on the instance handle returned by `wasm_init`
+ * - Runs a frame-locked main emulation loop (approx. 700Hz) that sleeps
+ *   while the ROM waits for a key
  *
  * This is the entry point for the browser version of the emulator.
  */
@@ -60,8 +62,10 @@ document.addEventListener("touchstart", initAudio, { once: true });
 
 // Load and initialize the WebAssembly module (via Emscripten glue)
 Chip8Emulator().then((Module) => {
+  const vm = Module.ccall("wasm_init", "number");   // Emulator instance handle
+
   // === Platform Hooks ===
-  Module.keyState = new Array(16).fill(0);     // CHIP-8 keypad state (16 keys)
+  Module.keyEvents = [];                       // Key presses/releases not yet read by the core
   Module.toggleBeep = toggleBeep;              // Hook into CHIP-8 sound logic
 
   // === Keyboard Mapping ===
@@ -72,31 +76,34 @@ Chip8Emulator().then((Module) => {
     '4': 0xC, 'r': 0xD, 'f': 0xE, 'v': 0xF
   };
 
-  // Update key state on keydown
-  document.addEventListener("keydown", (e) => {
+  // Queue presses and releases with their time (microseconds); the core reads them once per frame
+  function queueKey(e, down) {
     const key = e.key.toLowerCase();
-    if (key in keyMap) Module.keyState[keyMap[key]] = 1;
-  });
+    if (!(key in keyMap) || e.repeat) return;
+    Module.keyEvents.push({ time: Math.floor(e.timeStamp * 1000), key: keyMap[key], down: down ? 1 : 0 });
+  }
 
-  // Reset key state on keyup
-  document.addEventListener("keyup", (e) => {
-    const key = e.key.toLowerCase();
-    if (key in keyMap) Module.keyState[keyMap[key]] = 0;
-  });
+  document.addEventListener("keydown", (e) => queueKey(e, true));
+  document.addEventListener("keyup", (e) => queueKey(e, false));
 
   // === Canvas Renderer ===
-  Module.renderToCanvas = function(pixels) {
+  // `rows` holds 32 little-endian 64-bit rows; the leftmost pixel is bit 63,
+  // i.e. the top bit of the last byte of each row. Only the rows set in
+  // `damage` are redrawn; the canvas keeps the rest from earlier frames.
+  Module.renderToCanvas = function(rows, damage) {
     const canvas = document.getElementById("screen");
     const ctx = canvas.getContext("2d");
     const scale = 10;
 
-    ctx.fillStyle = "black";
-    ctx.fillRect(0, 0, canvas.width, canvas.height);
-
-    ctx.fillStyle = "white";
     for (let y = 0; y < 32; y++) {
+      if (!((damage >>> y) & 1)) continue;
+
+      ctx.fillStyle = "black";
+      ctx.fillRect(0, y * scale, canvas.width, scale);
+
+      ctx.fillStyle = "white";
       for (let x = 0; x < 64; x++) {
-        if (pixels[y * 64 + x]) {
+        if ((rows[y * 8 + 7 - (x >> 3)] >> (7 - (x & 7))) & 1) {
           ctx.fillRect(x * scale, y * scale, scale, scale);
         }
       }
@@ -107,9 +114,10 @@ Chip8Emulator().then((Module) => {
   function loadROM(rom) {
     const ptr = Module._malloc(rom.length);  // Allocate memory in WASM heap
     Module.HEAPU8.set(rom, ptr);             // Copy ROM into WASM memory
-    const result = Module.ccall('wasm_load_rom', 'number', ['number', 'number'], [ptr, rom.length]);
+    const result = Module.ccall('wasm_load_rom', 'number', ['number', 'number', 'number'], [vm, ptr, rom.length]);
     Module._free(ptr);
     if (result !== 0) alert("ROM failed to load.");
+    wake();                                  // The new ROM is not waiting for a key
   }
 
   // === ROM Loader from URL ===
@@ -158,26 +166,46 @@ Chip8Emulator().then((Module) => {
 
   // === Main Emulation Loop ===
   let lastTime = performance.now();
-  const targetHz = 700;                  // Approximate CPU frequency
-  const msPerCycle = 1000 / targetHz;
+  const frameHz = 60;                    // Timer/input rate (one wasm_cycle call per frame)
+  const msPerFrame = 1000 / frameHz;
+  const maxBacklogMs = 250;              // Drop backlog after the tab was hidden
+  const keyWaitTimeoutMs = 100;          // Longest sleep while the ROM waits for a key
   let accumulator = 0;
+  let sleepTimer = null;
 
   function runLoop(now) {
     let delta = now - lastTime;
     lastTime = now;
-    accumulator += delta;
+    accumulator = Math.min(accumulator + delta, maxBacklogMs);
+
+    // Run one batched 60Hz frame per elapsed frame slice
+    let ran = false;
+    while (accumulator >= msPerFrame) {
+      Module.ccall("wasm_cycle", "number", ["number"], [vm]);
+      accumulator -= msPerFrame;
+      ran = true;
+    }
 
-    // Run as many cycles as needed to keep up with wall-clock time
-    while (accumulator >= msPerCycle) {
-      Module.ccall("wasm_cycle", null, ["number"], [1]);
-      accumulator -= msPerCycle;
+    // Blocked on a key wait (Fx0A): sleep until a key or the timeout instead of every frame
+    if (ran && Module.ccall("wasm_waiting", "number", ["number"], [vm])) {
+      sleepTimer = setTimeout(wake, keyWaitTimeoutMs);
+      document.addEventListener("keydown", wake, { once: true });
+      return;
     }
 
     requestAnimationFrame(runLoop);
   }
 
+  // Resume the loop after a key-wait sleep (no-op if it is running)
+  function wake() {
+    if (sleepTimer === null) return;
+    clearTimeout(sleepTimer);
+    document.removeEventListener("keydown", wake);
+    sleepTimer = null;
+    requestAnimationFrame(runLoop);
+  }
+
   // === Startup Sequence ===
-  Module.ccall("wasm_init");     // Initialize CHIP-8 state in WASM
   populateROMButtons();          // Load available ROM list from roms/index.json
   requestAnimationFrame(runLoop); // Begin emulation loop
 });
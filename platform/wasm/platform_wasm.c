@@ -5,23 +5,42 @@
 /**
  * JavaScript binding to render the CHIP-8 display buffer to a canvas.
  *
- * @param pixels Pointer to a 64x32 uint8_t buffer in WASM memory.
- *               Each pixel should be either 0 (off) or 1 (on).
+ * @param rows   Pointer to the 32 packed uint64_t rows in WASM memory
+ *               (256 bytes, little endian, bit 63 = leftmost pixel).
+ * @param damage Rows to redraw (bit y = row y); the canvas keeps the others.
  */
-EM_JS(void, js_update_display, (const uint8_t *pixels), {
-  const display = new Uint8Array(Module.HEAPU8.buffer, pixels, 64 * 32);
-  Module.renderToCanvas(display);
+EM_JS(void, js_update_display, (const uint64_t *rows, uint32_t damage), {
+  const display = new Uint8Array(Module.HEAPU8.buffer, rows, 32 * 8);
+  Module.renderToCanvas(display, damage >>> 0);
 });
 
 /**
- * JavaScript binding to read the current key state from the browser.
+ * JavaScript binding to take the queued key events from the browser.
  *
- * @param keypad Pointer to a 16-byte array to receive key states (1 = pressed).
+ * @param events Array of InputEvent to fill (time_us at offset 0, key at 8, down at 9).
+ * @param max    Capacity of `events`; later events stay queued.
+ * @param now_us Receives the current time (performance.now(), in microseconds).
+ * @param stride sizeof(InputEvent).
+ * @return       Number of events stored.
  */
-EM_JS(void, js_poll_input, (uint8_t *keypad), {
-  for (let i = 0; i < 16; i++) {
-    Module.HEAPU8[keypad + i] = Module.keyState[i];
+EM_JS(int, js_read_input, (InputEvent *events, int max, uint64_t *now_us, int stride), {
+  const writeU64 = (ptr, value) => {
+    Module.HEAPU32[ptr >> 2] = value % 4294967296;
+    Module.HEAPU32[(ptr >> 2) + 1] = Math.floor(value / 4294967296);
+  };
+
+  const queue = Module.keyEvents || [];
+  const count = Math.min(queue.length, max);
+  for (let i = 0; i < count; i++) {
+    const ptr = events + i * stride;
+    writeU64(ptr, queue[i].time);
+    Module.HEAPU8[ptr + 8] = queue[i].key;
+    Module.HEAPU8[ptr + 9] = queue[i].down;
   }
+  queue.splice(0, count);
+
+  writeU64(now_us, Math.floor(performance.now() * 1000));
+  return count;
 });
 
 /**
@@ -36,34 +55,46 @@ EM_JS(void, js_beep, (bool active), {
 });
 
 /**
- * Platform initialization stub for WebAssembly.
- * No-op because the browser handles canvas and input setup.
+ * Render the CHIP-8 display to the browser using the JavaScript binding.
  */
-void platform_init(void) {}
+static void wasm_update_display(void *ctx, const uint64_t *rows) {
+  js_update_display(rows, PLATFORM_ALL_ROWS);
+}
 
 /**
- * Render the CHIP-8 display to the browser using the JavaScript binding.
+ * Redraw only the damaged rows of the canvas.
  */
-void platform_update_display(const uint8_t *pixels) {
-  js_update_display(pixels);
+static void wasm_update_rows(void *ctx, const uint64_t *rows, uint32_t damage) {
+  js_update_display(rows, damage);
 }
 
 /**
- * Poll the current key state and update the CHIP-8 keypad array.
+ * Take the key presses and releases recorded by the page since the last call.
  */
-void platform_poll_input(uint8_t *keypad) {
-  js_poll_input(keypad);
+static size_t wasm_read_input(void *ctx, InputEvent *events, size_t max, uint64_t *now_us) {
+  return (size_t)js_read_input(events, (int)max, now_us, (int)sizeof(InputEvent));
 }
 
 /**
  * Play or stop the sound using the browser's audio system.
  */
-void platform_play_beep(bool active) {
+static void wasm_play_beep(void *ctx, bool active) {
   js_beep(active);
 }
 
 /**
- * Platform cleanup stub for WebAssembly.
- * No resources to release in this implementation.
+ * Fill in the browser backend.
+ *
+ * The page owns the canvas, key event queue and audio, so there is no backend
+ * state and nothing to release on quit.
  */
-void platform_quit(void) {}
+void platform_wasm_init(Platform *platform) {
+  *platform = (Platform){
+    .ctx = NULL,
+    .update_display = wasm_update_display,
+    .update_rows = wasm_update_rows,
+    .read_input = wasm_read_input,
+    .play_beep = wasm_play_beep,
+    .quit = NULL,
+  };
+}
@@ -1,39 +1,99 @@
 #include <emscripten.h>
+#include <stdlib.h>
 #include "chip8.h"
+#include "display.h"
 #include "platform.h"
 #include "utils.h"
 
-// Global CHIP-8 instance used by the browser
-static Chip8 chip8;
+// One emulator instance as seen from JavaScript (the handle is its address)
+typedef struct {
+    Chip8 chip8;
+    Platform platform;
+} WasmInstance;
 
 /**
- * Exposed to JavaScript: Initialize the CHIP-8 system.
- * 
- * Clears memory, resets state, and prepares display, timers, and input.
+ * Exposed to JavaScript: Create and initialize a CHIP-8 instance.
+ *
+ * Clears memory, resets state, and attaches the browser platform.
  * Equivalent to calling `chip8_init` during native execution.
+ *
+ * @return Handle passed to the other wasm_* functions, or 0 on failure
+ */
+EMSCRIPTEN_KEEPALIVE
+WasmInstance *wasm_init() {
+    WasmInstance *vm = calloc(1, sizeof(WasmInstance));
+    if (!vm) return NULL;
+
+    platform_wasm_init(&vm->platform);
+    chip8_init(&vm->chip8);
+    vm->chip8.platform = &vm->platform;
+    return vm;
+}
+
+/**
+ * Exposed to JavaScript: Release an instance created by `wasm_init`.
+ */
+EMSCRIPTEN_KEEPALIVE
+void wasm_destroy(WasmInstance *vm) {
+    if (!vm) return;
+
+    platform_quit(&vm->platform);
+    free(vm);
+}
+
+/**
+ * Exposed to JavaScript: Execute one 60Hz frame.
+ *
+ * @param vm Handle returned by `wasm_init`
+ * @return Number of instructions actually executed
+ *
+ * Runs `chip8_run_frame`: the instructions up to the next 60Hz timer tick
+ * at `cpu_hz` (11 or 12 at 700Hz), with input polled once. The browser
+ * should call this at 60Hz so the timers run in real time.
+ * Only the canvas rows the frame changed are redrawn, and nothing when a
+ * frame's sprite draws cancel out.
  */
 EMSCRIPTEN_KEEPALIVE
-void wasm_init() {
-    chip8_init(&chip8);
+int wasm_cycle(WasmInstance *vm) {
+    Chip8 *chip8 = &vm->chip8;
+    Chip8Frame frame = chip8_run_frame(chip8);
+
+    if (frame.draw) update_display(chip8);
+
+    return (int)frame.cycles;
 }
 
 /**
- * Exposed to JavaScript: Execute N cycles of the emulator.
+ * Exposed to JavaScript: Whether the page can stop calling `wasm_cycle`.
  *
- * @param cycles Number of emulation cycles to execute
+ * @param vm Handle returned by `wasm_init`
+ * @return 1 if the ROM is blocked waiting for a key (Fx0A) and no beep is
+ *         playing, 0 otherwise
+ *
+ * While waiting, frames only advance the emulated clock, so the page may
+ * sleep until a key event (or a timeout) instead of running every
+ * animation frame.
+ */
+EMSCRIPTEN_KEEPALIVE
+int wasm_waiting(WasmInstance *vm) {
+    return vm->chip8.key_wait && !vm->chip8.sound_active;
+}
+
+/**
+ * Exposed to JavaScript: Seed the random numbers of Cxkk.
  *
- * This lets the browser control pacing (e.g., run 10–20 cycles per animation frame).
+ * @param vm   Handle returned by `wasm_init`
+ * @param seed Seed kept for this and every later `wasm_load_rom` (default 1)
  */
 EMSCRIPTEN_KEEPALIVE
-void wasm_cycle(int cycles) {
-    for (int i = 0; i < cycles; i++) {
-        chip8_cycle(&chip8);
-    }
+void wasm_seed(WasmInstance *vm, uint32_t seed) {
+    chip8_seed(&vm->chip8, seed);
 }
 
 /**
  * Exposed to JavaScript: Load a ROM into the CHIP-8 memory.
  *
+ * @param vm   Handle returned by `wasm_init`
  * @param data Pointer to a buffer containing ROM bytes
  * @param size Number of bytes to copy (max is MEMORY_SIZE - 0x200)
  * @return 0 on success, -1 on error (e.g., too large)
@@ -41,15 +101,16 @@ void wasm_cycle(int cycles) {
  * Automatically resets state before loading.
  */
 EMSCRIPTEN_KEEPALIVE
-int wasm_load_rom(uint8_t *data, int size) {
+int wasm_load_rom(WasmInstance *vm, uint8_t *data, int size) {
     if (size > (MEMORY_SIZE - 0x200)) return -1;
 
-    chip8_init(&chip8);  // Reset emulator state
+    Chip8 *chip8 = &vm->chip8;
+    chip8_reset(chip8);  // Power-on state; the platform stays attached
 
-    memory_copy(&chip8.memory[0x200], data, size);  // Load ROM into memory
-    chip8.pc = 0x200;  // Reset program counter
+    memory_copy(&chip8->memory[0x200], data, size);  // Load ROM into memory
+    chip8->pc = 0x200;  // Reset program counter
 
-    platform_update_display(chip8.display);  // Optional: trigger screen redraw
+    update_display(chip8);  // Full redraw: the reset requested one
 
     return 0;
 }
@@ -5,17 +5,24 @@
  * This module handles:
  * - Memory and register setup
  * - Fontset loading
- * - Subsystem initialization (display, timers, input)
+ * - Power-on reset (independent of the host platform)
  * - ROM loading
  * - Fetch-decode-execute cycle
+ * - Frame-batched execution (timers and input once per 60Hz frame)
  */
 
 #include "chip8.h"
 #include "dispatch.h"
+#include "idle.h"
+#include "jit.h"
+#include "recomp.h"
 #include "input.h"
 #include "display.h"
+#include "rng.h"
 #include "timer.h"
 #include "utils.h"
+#include "platform.h"
+#include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -45,18 +52,61 @@ static const uint8_t fontset[80] = {
 
 /**
  * Initializes a CHIP-8 instance.
- * Clears memory, resets registers and timers, and prepares subsystems.
+ * Clears the whole structure, sets the default configuration and performs
+ * a power-on reset. No platform is attached (the instance runs headless
+ * until the host sets `chip8->platform`).
  *
  * @param chip8 Pointer to the Chip8 structure to initialize.
  */
 void chip8_init(Chip8 *chip8) {
-    // Zero the entire structure (including memory, registers, etc.)
+    // Zero the entire structure (including memory, registers, attachments, etc.)
     memset(chip8, 0, sizeof(Chip8));
 
+    chip8->cpu_hz = CPU_FREQUENCY;
+    chip8->skip_idle = true;
+    chip8->seed = RNG_DEFAULT_SEED;
+
+    // Every decode cache entry is empty after the memset
+    chip8->decoded_lo = MEMORY_SIZE;
+
+    chip8_reset(chip8);
+}
+
+/**
+ * Restores the power-on state of a CHIP-8 instance.
+ *
+ * Clears memory, registers, the emulated clock, stack, timers, display and
+ * keypad, reloads the fontset, sets PC to 0x200 and restarts the Cxkk
+ * generator from `chip8->seed`. Configuration and host attachments
+ * (platform, JIT, recompiled program, `cpu_hz`, `skip_idle`, `seed`)
+ * are kept, and the platform is only told to stop a beep that was
+ * playing. Cached decodes and compiled code are dropped.
+ *
+ * Cheap enough to call once per run in fuzzing and batch workloads
+ * (see bench/bench_reset.c).
+ *
+ * @param chip8 Pointer to the emulator state.
+ */
+void chip8_reset(Chip8 *chip8) {
+    if (!chip8) {
+        fprintf(stderr, "chip8_reset called on null Chip8 pointer\n");
+        return;
+    }
+
+    if (chip8->sound_active) {
+        platform_beep_edge(chip8->platform, false, timer_cycle_us(chip8, chip8->cycles));
+    }
+
+    // Power-on state is the prefix of the struct (see chip8.h)
+    memset(chip8, 0, offsetof(Chip8, cpu_hz));
+
     // CHIP-8 programs start at memory address 0x200
     chip8->pc = 0x200;
 
-    // Initialize display, timers, and keypad subsystems
+    // Same seed, same random sequence after every reset
+    rng_seed(chip8, chip8->seed);
+
+    // Display, timers and keypad subsystems (display_init requests the initial redraw)
     display_init(chip8);
     timer_init(chip8);
     keypad_init(chip8);
@@ -64,8 +114,8 @@ void chip8_init(Chip8 *chip8) {
     // Load the fontset into the beginning of memory (0x000–0x04F)
     memcpy(chip8->memory, fontset, FONTSET_SIZE);
 
-    // Set up opcode dispatch table for instruction decoding
-    opcode_dispatch_init();
+    // Dispatch tables are const; only the per-instance decode cache needs resetting
+    dispatch_invalidate_all(chip8);
 }
 
 /**
@@ -77,19 +127,88 @@ void chip8_init(Chip8 *chip8) {
  * @return         0 on success, -1 on failure.
  */
 int chip8_load_rom(Chip8 *chip8, const char *filename) {
-    return load_rom(filename, chip8->memory + 0x200, MEMORY_SIZE);
+    int result = load_rom(filename, chip8->memory + 0x200, MEMORY_SIZE);
+
+    // Program memory changed underneath any cached decodes
+    dispatch_invalidate_all(chip8);
+    return result;
+}
+
+/**
+ * Seeds the generator Cxkk draws from.
+ *
+ * The seed is configuration: it restarts the generator now and on every
+ * later `chip8_reset`, so runs with the same seed and input are identical
+ * on any thread. It has no effect on `rand()` (see `chip8->libc_rand`).
+ *
+ * @param chip8 Pointer to the emulator state.
+ * @param seed  Any 64-bit value.
+ */
+void chip8_seed(Chip8 *chip8, uint64_t seed) {
+    if (!chip8) {
+        fprintf(stderr, "chip8_seed called on null Chip8 pointer\n");
+        return;
+    }
+
+    chip8->seed = seed;
+    rng_seed(chip8, seed);
+}
+
+/**
+ * Fetches, decodes and executes the instruction at PC.
+ *
+ * The decoded handler comes from the decode cache; the opcode is only
+ * fetched and resolved the first time an address is executed (or after
+ * it was overwritten). If a timer-wait loop starts at PC, the passes that
+ * cannot leave it are fast-forwarded (see idle.c). Shared by `chip8_cycle`
+ * and the tight loop in `chip8_run`. Performs no timer or input work; handlers see
+ * `chip8->cycles` as the index of the instruction they execute, and the
+ * emulated clock advances afterwards.
+ *
+ * @param chip8  Pointer to the emulator state.
+ * @param budget Most instructions that may be executed (at least 1).
+ * @return       Instructions executed, 0 if PC is out of bounds.
+ */
+static inline uint32_t chip8_step(Chip8 *chip8, uint32_t budget) {
+    if (chip8->pc >= MEMORY_SIZE - 1) {
+        DEBUG_PRINT(chip8, "PC out of bounds: 0x%04X\n", chip8->pc);
+        return 0;
+    }
+
+    // Fetch + decode only on a cache miss
+    DecodedOp *op = &chip8->decoded[chip8->pc];
+    if (!op->handler) {
+        op = dispatch_decode(chip8, chip8->pc);
+    }
+
+    // Spinning on the delay timer: advance the clock instead of executing passes
+    if (op->idle && budget >= IDLE_LOOP_LENGTH) {
+        uint32_t skipped = idle_skip(chip8, op->opcode, budget);
+        if (skipped) return skipped;
+    }
+
+    DEBUG_PRINT_STDOUT(chip8, "[DEBUG] PC=0x%04X  Executing: 0x%04X\n", chip8->pc, op->opcode);
+
+    // Advance PC before executing (some handlers may override it)
+    chip8->pc += 2;
+
+    // Execute the resolved leaf handler directly
+    dispatch_handlers[op->handler](chip8, op->opcode);
+    chip8->cycles++;
+
+    return 1;
 }
 
 /**
- * Executes a single emulation cycle of the CHIP-8 virtual machine.
+ * Executes a single CHIP-8 instruction.
  *
  * This cycle performs the following steps:
  * - Fetch: Reads the next 2-byte instruction from memory.
  * - Decode + Execute: Uses the dispatch table to invoke the opcode handler.
- * - Update: Advances timers and polls input.
  *
  * Increments the program counter before execution.
- * Updates to the display are flagged via `chip8->draw_flag` and handled externally.
+ * Timers and input are not touched; they advance once per frame in `chip8_run`.
+ * Display writes are tracked in `chip8->dirty_rows` and presented by the host.
  *
  * @param chip8 Pointer to the emulator state.
  */
@@ -99,27 +218,133 @@ void chip8_cycle(Chip8 *chip8) {
         return;
     }
 
-    if (chip8->pc >= MEMORY_SIZE - 1) {
-        DEBUG_PRINT(chip8, "PC out of bounds: 0x%04X\n", chip8->pc);
-        return;
+    chip8_step(chip8, 1);
+}
+
+/**
+ * Executes up to `cycles` instructions in the tight fetch/dispatch loop.
+ *
+ * Leaves the VM in the state as many `chip8_cycle` calls would, but idle
+ * loops are fast-forwarded. Timers and input are not touched, as in
+ * `chip8_cycle`.
+ *
+ * @param chip8  Pointer to the emulator state.
+ * @param cycles Most instructions to execute.
+ * @return       Instructions executed (fewer if PC left memory).
+ */
+uint32_t chip8_execute(Chip8 *chip8, uint32_t cycles) {
+    if (!chip8) {
+        fprintf(stderr, "chip8_execute called on null Chip8 pointer\n");
+        return 0;
     }
 
-    // Fetch 16-bit instruction (big-endian)
-    uint16_t opcode = (chip8->memory[chip8->pc] << 8) | chip8->memory[chip8->pc + 1];
+    uint32_t executed = 0;
+    while (executed < cycles) {
+        uint32_t n = chip8_step(chip8, cycles - executed);
+        if (!n) break;
+        executed += n;
+    }
+    return executed;
+}
 
-    DEBUG_PRINT_STDOUT(chip8, "[DEBUG] PC=0x%04X  Executing: 0x%04X\n", chip8->pc, opcode);
+/**
+ * Executes one 60Hz frame of the CHIP-8 virtual machine.
+ *
+ * - Input: Reads the platform once, before the batch (see `keypad_scan`).
+ *   Timestamped key events are applied at their emulated cycle: the batch
+ *   is split there. A key wait (Fx0A) ends when a key is down at the start
+ *   of a batch; otherwise the clock is fast-forwarded to the next key event
+ *   or the end of the frame, since re-executing Fx0A cannot change anything
+ *   before then.
+ * - Execute: Runs exactly `cycles` instructions in a tight fetch/dispatch loop
+ *   (or through native blocks when the JIT backend is enabled or an
+ *   ahead-of-time recompiled program is attached). Idle-loop passes skipped
+ *   by the interpreter count towards it.
+ * - Update: Reports a beep that ran out to the platform. Timers need no work;
+ *   they follow the emulated clock (`chip8->cycles`), which every backend
+ *   advances as it executes.
+ *
+ * Stops early if the program counter leaves memory.
+ *
+ * @param chip8  Pointer to the emulator state.
+ * @param cycles Number of instructions to execute in this frame.
+ * @return       Summary of the frame (cycles executed, draw and sound state).
+ */
+Chip8Frame chip8_run(Chip8 *chip8, uint32_t cycles) {
+    Chip8Frame frame = {0};
 
-    // Advance PC before executing (some handlers may override it)
-    chip8->pc += 2;
+    if (!chip8) {
+        fprintf(stderr, "chip8_run called on null Chip8 pointer\n");
+        return frame;
+    }
+
+    bool was_sounding = chip8->sound_active;
+    uint64_t start = chip8->cycles;
+    uint64_t idle_start = chip8->idle_skipped;
+    uint64_t end = start + cycles;
+
+    keypad_scan(chip8, cycles);
+    uint64_t limit = keypad_apply_events(chip8, end);
+    if (chip8->key_wait && is_any_key_pressed(chip8)) chip8->key_wait = false;
+
+    while (chip8->cycles < end) {
+        // Batches stop at the next key event, which then applies before its instruction
+        if (chip8->cycles >= limit) {
+            limit = keypad_apply_events(chip8, end);
+            if (chip8->key_wait && is_any_key_pressed(chip8)) chip8->key_wait = false;
+        }
+
+        // Blocked in Fx0A: the clock (and so the timers) still advances
+        if (chip8->key_wait) {
+            chip8->idle_skipped += limit - chip8->cycles;
+            chip8->cycles = limit;
+            continue;
+        }
+
+        // Compiled blocks first; the interpreter covers cold code and block tails
+        if (chip8->recomp) {
+            recomp_execute(chip8, (uint32_t)(limit - chip8->cycles));
+            if (chip8->cycles >= limit) continue;
+        }
+
+        if (chip8->jit) {
+            jit_execute(chip8, (uint32_t)(limit - chip8->cycles));
+            if (chip8->cycles >= limit) continue;
+        }
 
-    // Decode and execute instruction
-    if (!dispatch_opcode(chip8, opcode)) {
-        DEBUG_PRINT(chip8, "Registers after unknown opcode:\n");
+        if (!chip8_step(chip8, (uint32_t)(limit - chip8->cycles))) break;
     }
 
-    // Timers and input are updated after each instruction
+    frame.cycles = (uint32_t)(chip8->cycles - start);
+    frame.skipped = (uint32_t)(chip8->idle_skipped - idle_start);
     timer_update(chip8);
-    keypad_scan(chip8);
 
-    // draw_flag is checked and acted on externally in the main loop
+    // Nothing is marked as shown here; the host presents with update_display()
+    frame.damage = display_damage(chip8);
+    frame.draw = frame.damage != 0;
+    frame.sound = chip8->sound_active;
+    frame.sound_edge = chip8->sound_active != was_sounding;
+    frame.waiting = chip8->key_wait;
+    return frame;
+}
+
+/**
+ * Executes one 60Hz frame at the instance's configured `cpu_hz`.
+ *
+ * Runs until the emulated clock reaches the next 60Hz timer tick, so frames
+ * alternate between 11 and 12 instructions at 700Hz and one second of frames
+ * executes exactly `cpu_hz` instructions.
+ *
+ * @param chip8 Pointer to the emulator state.
+ * @return      Summary of the frame (see `chip8_run`).
+ */
+Chip8Frame chip8_run_frame(Chip8 *chip8) {
+    if (!chip8) {
+        Chip8Frame frame = {0};
+        fprintf(stderr, "chip8_run_frame called on null Chip8 pointer\n");
+        return frame;
+    }
+
+    uint64_t next = timer_next_tick(chip8, chip8->cycles);
+    return chip8_run(chip8, (uint32_t)(next - chip8->cycles));
 }
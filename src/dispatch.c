@@ -4,97 +4,113 @@
  * CHIP-8 opcode dispatch system.
  *
  * This module routes 16-bit CHIP-8 opcodes to the correct handler functions
- * using multi-level dispatch tables. It supports direct decoding of opcodes
- * and layered subdispatching for complex instruction groups (e.g., 0x8, 0xF).
+ * through a generated flat table indexed by the whole opcode. The original
+ * multi-level tables (layered subdispatching for groups such as 0x8, 0xF)
+ * remain as a reference path.
+ *
+ * It also maintains the per-instance decode cache: each memory address
+ * lazily caches the leaf handler resolved for the opcode stored there, so
+ * the execution loop skips the fetch and both table lookups.
  */
 
 #include "chip8.h"
 #include "dispatch.h"
+#include "idle.h"
+#include "jit.h"
+#include "recomp.h"
 #include "opcodes.h"
+#include "utils.h"
 #include <stdio.h>
 #include <string.h>
 
-/**
- * Typedef for opcode handler functions.
- * All opcode handlers take a Chip8 pointer and the 16-bit opcode.
+/* ------------------------------------------------------------
+ * Flat Dispatch Table
+ * ------------------------------------------------------------
+ * dispatch_table (generated at build time by tools/gen_dispatch_table.c)
+ * maps every 16-bit opcode straight to its leaf handler, so dispatching is
+ * one indexed load and one indirect call. Undefined opcodes map to
+ * op_unknown. The table is const data: no initialization is required.
  */
-typedef void (*OpcodeHandler)(Chip8 *chip8, uint16_t opcode);
 
 /* ------------------------------------------------------------
- * Primary Dispatch Tables
+ * Two-Level Dispatch Tables
  * ------------------------------------------------------------
  * main_table — routes based on top nibble (0x0 to 0xF)
  * table_0    — routes 0x00** opcodes (e.g., CLS, RET)
  * table_8    — routes 0x8xy* ALU instructions
  * table_E    — routes 0xEx** key input ops
  * table_F    — routes 0xFx** timers, memory, and I/O
+ *
+ * The original nested decoder, kept as the reference path for
+ * dispatch_opcode_nested() and the dispatch benchmark.
  */
 
-static OpcodeHandler main_table[0x10];
-static OpcodeHandler table_0[0x100];
-static OpcodeHandler table_8[0x10];
-static OpcodeHandler table_E[0x100];
-static OpcodeHandler table_F[0x100];
+static const OpcodeHandler main_table[0x10] = {
+    [0x0] = op_0xxx,
+    [0x1] = op_1nnn,
+    [0x2] = op_2nnn,
+    [0x3] = op_3xkk,
+    [0x4] = op_4xkk,
+    [0x5] = op_5xy0,
+    [0x6] = op_6xkk,
+    [0x7] = op_7xkk,
+    [0x8] = op_8xxx,
+    [0x9] = op_9xy0,
+    [0xA] = op_Annn,
+    [0xB] = op_Bnnn,
+    [0xC] = op_Cxkk,
+    [0xD] = op_Dxyn,
+    [0xE] = op_Exxx,
+    [0xF] = op_Fxxx,
+};
+
+// Subtable: 0x0***
+static const OpcodeHandler table_0[0x100] = {
+    [0xE0] = op_00E0, // CLS
+    [0xEE] = op_00EE, // RET
+};
+
+// Subtable: 0x8***
+static const OpcodeHandler table_8[0x10] = {
+    [0x0] = op_8xy0,
+    [0x1] = op_8xy1,
+    [0x2] = op_8xy2,
+    [0x3] = op_8xy3,
+    [0x4] = op_8xy4,
+    [0x5] = op_8xy5,
+    [0x6] = op_8xy6,
+    [0x7] = op_8xy7,
+    [0xE] = op_8xyE,
+};
+
+// Subtable: 0xE***
+static const OpcodeHandler table_E[0x100] = {
+    [0x9E] = op_Ex9E, // SKP Vx
+    [0xA1] = op_ExA1, // SKNP Vx
+};
+
+// Subtable: 0xF***
+static const OpcodeHandler table_F[0x100] = {
+    [0x07] = op_Fx07,
+    [0x0A] = op_Fx0A,
+    [0x15] = op_Fx15,
+    [0x18] = op_Fx18,
+    [0x1E] = op_Fx1E,
+    [0x29] = op_Fx29,
+    [0x33] = op_Fx33,
+    [0x55] = op_Fx55,
+    [0x65] = op_Fx65,
+};
 
 /**
- * Initializes the opcode dispatch tables.
- * Maps each opcode group to its corresponding handler.
- */
-void opcode_dispatch_init(void) {
-    // Clear all dispatch tables
-    memset(main_table, 0, sizeof(main_table));
-    memset(table_0, 0, sizeof(table_0));
-    memset(table_8, 0, sizeof(table_8));
-    memset(table_E, 0, sizeof(table_E));
-    memset(table_F, 0, sizeof(table_F));
-
-    // Main table — top nibble (0x0 to 0xF)
-    main_table[0x0] = op_0xxx;
-    main_table[0x1] = op_1nnn;
-    main_table[0x2] = op_2nnn;
-    main_table[0x3] = op_3xkk;
-    main_table[0x4] = op_4xkk;
-    main_table[0x5] = op_5xy0;
-    main_table[0x6] = op_6xkk;
-    main_table[0x7] = op_7xkk;
-    main_table[0x8] = op_8xxx;
-    main_table[0x9] = op_9xy0;
-    main_table[0xA] = op_Annn;
-    main_table[0xB] = op_Bnnn;
-    main_table[0xC] = op_Cxkk;
-    main_table[0xD] = op_Dxyn;
-    main_table[0xE] = op_Exxx;
-    main_table[0xF] = op_Fxxx;
-
-    // Subtable: 0x0***
-    table_0[0xE0] = op_00E0; // CLS
-    table_0[0xEE] = op_00EE; // RET
-
-    // Subtable: 0x8***
-    table_8[0x0] = op_8xy0;
-    table_8[0x1] = op_8xy1;
-    table_8[0x2] = op_8xy2;
-    table_8[0x3] = op_8xy3;
-    table_8[0x4] = op_8xy4;
-    table_8[0x5] = op_8xy5;
-    table_8[0x6] = op_8xy6;
-    table_8[0x7] = op_8xy7;
-    table_8[0xE] = op_8xyE;
-
-    // Subtable: 0xE***
-    table_E[0x9E] = op_Ex9E; // SKP Vx
-    table_E[0xA1] = op_ExA1; // SKNP Vx
-
-    // Subtable: 0xF***
-    table_F[0x07] = op_Fx07;
-    table_F[0x0A] = op_Fx0A;
-    table_F[0x15] = op_Fx15;
-    table_F[0x18] = op_Fx18;
-    table_F[0x1E] = op_Fx1E;
-    table_F[0x29] = op_Fx29;
-    table_F[0x33] = op_Fx33;
-    table_F[0x55] = op_Fx55;
-    table_F[0x65] = op_Fx65;
+ * Fault handler for opcodes with no defined instruction.
+ * Every undefined opcode in both dispatch paths ends up here.
+ *
+ * @param chip8  Pointer to CHIP-8 state.
+ * @param opcode Full 16-bit opcode.
+ */
+void op_unknown(Chip8 *chip8, uint16_t opcode) {
+    DEBUG_PRINT(chip8, "Unknown Opcode: 0x%04X\n", opcode);
 }
 
 /**
@@ -110,16 +126,123 @@ bool dispatch_opcode(Chip8 *chip8, uint16_t opcode) {
         return false;
     }
 
-    // Use top nibble to find main group handler
-    uint8_t prefix = (opcode >> 12) & 0xF;
-    OpcodeHandler opcode_function = main_table[prefix];
+    OpcodeHandler handler = dispatch_table[opcode];
+    handler(chip8, opcode);
+    return handler != op_unknown;
+}
 
-    if (opcode_function) {
-        opcode_function(chip8, opcode);
-        return true;
-    } else {
-        fprintf(stderr, "Unknown Opcode: 0x%04X\n", opcode);
-        return false;
+/**
+ * Dispatches an opcode through the two-level tables (main table, then the
+ * group subdispatcher). Same behavior as `dispatch_opcode`, one extra
+ * dependent indirect call for grouped opcodes.
+ *
+ * @param chip8  Pointer to the CHIP-8 emulator state.
+ * @param opcode The 16-bit opcode to execute.
+ */
+void dispatch_opcode_nested(Chip8 *chip8, uint16_t opcode) {
+    main_table[opcode >> 12](chip8, opcode);
+}
+
+/* ------------------------------------------------------------
+ * Decode Cache
+ * ------------------------------------------------------------
+ * chip8->decoded[addr] caches the leaf handler for the opcode at addr, as
+ * its index in dispatch_handlers so an entry takes 4 bytes.
+ * Entries are filled on first execution and cleared whenever memory they
+ * were decoded from is written, so self-modifying ROMs stay correct.
+ */
+
+/**
+ * Resolves an opcode to its leaf handler.
+ *
+ * @param opcode The 16-bit opcode to resolve.
+ * @return       The leaf handler, or op_unknown for undefined opcodes.
+ */
+OpcodeHandler dispatch_resolve(uint16_t opcode) {
+    return dispatch_table[opcode];
+}
+
+/**
+ * Decodes the instruction at `addr` into the decode cache.
+ *
+ * @param chip8 Pointer to CHIP-8 state.
+ * @param addr  Address of the instruction (must be < MEMORY_SIZE - 1).
+ * @return      The filled cache entry.
+ */
+DecodedOp *dispatch_decode(Chip8 *chip8, uint16_t addr) {
+    DecodedOp *op = &chip8->decoded[addr];
+
+    op->opcode = (chip8->memory[addr] << 8) | chip8->memory[addr + 1];
+    op->handler = dispatch_index[op->opcode];
+
+    // Timer-wait loop starting here (idle fast-forward only)
+    op->idle = chip8->skip_idle && idle_match(chip8, addr);
+
+    // Track the filled range so dispatch_invalidate_all stays cheap
+    if (addr < chip8->decoded_lo) chip8->decoded_lo = addr;
+    if (addr >= chip8->decoded_hi) chip8->decoded_hi = addr + 1;
+    return op;
+}
+
+/**
+ * Invalidates cached decodes after memory[addr .. addr + len - 1] was written.
+ *
+ * An instruction spans two bytes and an idle loop 2 * IDLE_LOOP_LENGTH
+ * bytes, so entries starting that far before the written range are
+ * dropped as well.
+ *
+ * @param chip8 Pointer to CHIP-8 state.
+ * @param addr  First written address.
+ * @param len   Number of bytes written.
+ */
+void dispatch_invalidate(Chip8 *chip8, uint16_t addr, uint16_t len) {
+    uint32_t reach = 2 * IDLE_LOOP_LENGTH - 1;
+    uint32_t start = addr > reach ? addr - reach : 0u;
+    uint32_t end = (uint32_t)addr + len;
+
+    if (end > MEMORY_SIZE) {
+        end = MEMORY_SIZE;
+    }
+
+    // Entries outside the decoded range are empty already
+    if (start < chip8->decoded_lo) start = chip8->decoded_lo;
+    if (end > chip8->decoded_hi) end = chip8->decoded_hi;
+
+    for (uint32_t i = start; i < end; i++) {
+        chip8->decoded[i].handler = 0;
+    }
+
+    if (chip8->jit) {
+        jit_invalidate(chip8, addr, len);
+    }
+
+    if (chip8->recomp) {
+        recomp_invalidate(chip8, addr, len);
+    }
+}
+
+/**
+ * Invalidates the whole decode cache.
+ *
+ * Only the range that was ever decoded is cleared, so resets and ROM loads
+ * cost in proportion to the code actually executed.
+ *
+ * @param chip8 Pointer to CHIP-8 state.
+ */
+void dispatch_invalidate_all(Chip8 *chip8) {
+    if (chip8->decoded_lo < chip8->decoded_hi) {
+        memset(&chip8->decoded[chip8->decoded_lo], 0,
+               (size_t)(chip8->decoded_hi - chip8->decoded_lo) * sizeof(DecodedOp));
+    }
+    chip8->decoded_lo = MEMORY_SIZE;
+    chip8->decoded_hi = 0;
+
+    if (chip8->jit) {
+        jit_invalidate(chip8, 0, MEMORY_SIZE);
+    }
+
+    if (chip8->recomp) {
+        recomp_invalidate(chip8, 0, MEMORY_SIZE);
     }
 }
 
@@ -139,11 +262,7 @@ bool dispatch_opcode(Chip8 *chip8, uint16_t opcode) {
  */
 void op_0xxx(Chip8 *chip8, uint16_t opcode) {
     OpcodeHandler handler = table_0[opcode & 0x00FF];
-    if (handler) {
-        handler(chip8, opcode);
-    } else {
-        fprintf(stderr, "Unknown sub-opcode in 0x0 group: 0x%04X\n", opcode);
-    }
+    (handler ? handler : op_unknown)(chip8, opcode);
 }
 
 /**
@@ -155,11 +274,7 @@ void op_0xxx(Chip8 *chip8, uint16_t opcode) {
  */
 void op_8xxx(Chip8 *chip8, uint16_t opcode) {
     OpcodeHandler handler = table_8[opcode & 0x000F];
-    if (handler) {
-        handler(chip8, opcode);
-    } else {
-        fprintf(stderr, "Unknown sub-opcode in 0x8 group: 0x%04X\n", opcode);
-    }
+    (handler ? handler : op_unknown)(chip8, opcode);
 }
 
 /**
@@ -171,11 +286,7 @@ void op_8xxx(Chip8 *chip8, uint16_t opcode) {
  */
 void op_Exxx(Chip8 *chip8, uint16_t opcode) {
     OpcodeHandler handler = table_E[opcode & 0x00FF];
-    if (handler) {
-        handler(chip8, opcode);
-    } else {
-        fprintf(stderr, "Unknown sub-opcode in 0xE group: 0x%04X\n", opcode);
-    }
+    (handler ? handler : op_unknown)(chip8, opcode);
 }
 
 /**
@@ -187,9 +298,5 @@ void op_Exxx(Chip8 *chip8, uint16_t opcode) {
  */
 void op_Fxxx(Chip8 *chip8, uint16_t opcode) {
     OpcodeHandler handler = table_F[opcode & 0x00FF];
-    if (handler) {
-        handler(chip8, opcode);
-    } else {
-        fprintf(stderr, "Unknown sub-opcode in 0xF group: 0x%04X\n", opcode);
-    }
+    (handler ? handler : op_unknown)(chip8, opcode);
 }
@@ -6,6 +6,17 @@
  * Handles the virtual framebuffer, drawing operations, and display backend
  * integration (SDL or WebAssembly). Implements the rendering behavior
  * of CHIP-8 as specified in the instruction set.
+ *
+ * The framebuffer is bit-packed: `chip8->display[y]` holds row y, with the
+ * leftmost pixel in bit 63. The screen is exactly 64 pixels wide, so a
+ * sprite row wraps around horizontally by rotating it into place, and is
+ * drawn with one XOR (plus one AND for collision detection).
+ *
+ * Presentation is damage-based: drawing and clearing mark the rows they touch
+ * in `chip8->dirty_rows`, and `update_display` sends the platform only the
+ * dirty rows that actually differ from `chip8->shown`, the copy taken at the
+ * previous present. A frame whose draws cancel out (erase, then redraw in
+ * place) has no damage and is not presented at all.
  */
 
 #include "display.h"
@@ -15,12 +26,29 @@
 
 #define SCALE 10  // Used internally for resolution scaling (e.g., SDL)
 
+#if DISPLAY_WIDTH != 64
+#error "display rows are packed into one uint64_t each"
+#endif
+
+#if DISPLAY_HEIGHT != 32
+#error "damage masks hold one bit per display row in a uint32_t"
+#endif
+
+/**
+ * Rotate a 64-bit word right (compiles to a single rotate instruction).
+ */
+static inline uint64_t rotr64(uint64_t word, unsigned shift) {
+    return (word >> (shift & 63)) | (word << ((64 - shift) & 63));
+}
+
  /**
   * Initialize the display system.
   *
   * - Clears the framebuffer.
-  * - Sets the draw flag to force a redraw.
-  * - Initializes platform-specific rendering backend (SDL, WASM, etc.).
+  * - Sets the draw flag to force a full redraw (what the host shows is unknown).
+  *
+  * The rendering backend (SDL, WASM, etc.) is created by the host and
+  * attached through `chip8->platform`.
   *
   * @param chip8 Pointer to the CHIP-8 emulator instance.
   */
@@ -31,16 +59,15 @@ void display_init(Chip8 *chip8) {
     }
 
     memset(chip8->display, 0, sizeof(chip8->display));  // Clear framebuffer
+    chip8->dirty_rows = 0;
     chip8->draw_flag = true;                            // Flag for initial redraw
-
-    platform_init();  // Initialize SDL/WASM rendering backend
 }
 
 /**
  * Clear the display.
  *
  * - Resets all pixels in the framebuffer.
- * - Sets the draw flag so the display updates on the next frame.
+ * - Marks the rows that had lit pixels as dirty.
  *
  * Typically invoked by opcode 0x00E0 (CLS).
  *
@@ -52,8 +79,10 @@ void clear_display(Chip8 *chip8) {
         return;
     }
 
-    memset(chip8->display, 0, sizeof(chip8->display));  // Set all pixels to 0
-    chip8->draw_flag = true;                            // Request display refresh
+    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+        if (chip8->display[y]) chip8->dirty_rows |= 1u << y;  // Only lit rows change
+        chip8->display[y] = 0;
+    }
 }
 
 /**
@@ -64,6 +93,7 @@ void clear_display(Chip8 *chip8) {
  * Otherwise, returns 0.
  *
  * Wrapping occurs automatically if the sprite exceeds screen boundaries.
+ * Rows with any sprite pixel set are marked dirty.
  *
  * @param chip8  Pointer to the CHIP-8 emulator instance.
  * @param x      Horizontal position (Vx).
@@ -83,34 +113,53 @@ int draw_sprite(Chip8 *chip8, uint8_t x, uint8_t y, uint8_t height, const uint8_
         return 0;
     }
 
-    int collision = 0;
+    uint64_t erased = 0;
 
     for (uint8_t row = 0; row < height; ++row) {
-        uint8_t sprite_byte = sprite[row];
-
-        for (uint8_t col = 0; col < 8; ++col) {
-            // Check if this bit should be drawn
-            if ((sprite_byte & (0x80 >> col)) != 0) {
-                uint8_t px = (x + col) % DISPLAY_WIDTH;
-                uint8_t py = (y + row) % DISPLAY_HEIGHT;
-                uint16_t index = py * DISPLAY_WIDTH + px;
+        // Sprite byte at columns x..x+7, wrapping past the right edge
+        uint64_t bits = rotr64((uint64_t)sprite[row] << 56, x);
+        uint8_t line_y = (y + row) % DISPLAY_HEIGHT;
+        uint64_t *line = &chip8->display[line_y];
+
+        erased |= *line & bits;  // Pixels turned off by this row (collision)
+        *line ^= bits;           // Toggle pixels using XOR
+        if (bits) chip8->dirty_rows |= 1u << line_y;
+    }
 
-                if (chip8->display[index] == 1)
-                    collision = 1;  // Erasing an existing pixel
+    return erased != 0;
+}
 
-                chip8->display[index] ^= 1;  // Toggle pixel using XOR
-            }
-        }
+/**
+ * Compute which rows must be presented.
+ *
+ * A row is damaged if it was written since the last present and its pixels
+ * now differ from what was presented; every row is damaged while a full
+ * redraw is pending (`draw_flag`).
+ *
+ * @param chip8 Pointer to the CHIP-8 emulator instance.
+ * @return      Damage mask (bit y = row y), 0 if the screen is unchanged.
+ */
+uint32_t display_damage(const Chip8 *chip8) {
+    if (!chip8) {
+        DEBUG_PRINT(chip8, "display_damage called on null Chip8 pointer\n");
+        return 0;
     }
 
-    return collision;
+    if (chip8->draw_flag) return PLATFORM_ALL_ROWS;
+
+    uint32_t damage = 0;
+    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+        if (((chip8->dirty_rows >> y) & 1) && chip8->display[y] != chip8->shown[y])
+            damage |= 1u << y;
+    }
+    return damage;
 }
 
 /**
  * Update the physical display.
  *
- * Delegates to platform-specific rendering to copy the framebuffer
- * contents to the screen. Should only be called when draw_flag is set.
+ * Sends the damaged rows to the platform (nothing if there are none), then
+ * records the framebuffer as shown and clears the dirty rows and draw flag.
  *
  * @param chip8 Pointer to the CHIP-8 emulator instance.
  */
@@ -120,14 +169,27 @@ void update_display(Chip8 *chip8) {
         return;
     }
 
-    platform_update_display(chip8->display);  // Delegate to SDL or Web backend
+    uint32_t damage = display_damage(chip8);
+    if (damage) platform_update_rows(chip8->platform, chip8->display, damage);  // Delegate to SDL or Web backend
+
+    memcpy(chip8->shown, chip8->display, sizeof(chip8->shown));
+    chip8->dirty_rows = 0;
+    chip8->draw_flag = false;
 }
 
 /**
- * Shutdown and clean up display resources.
+ * Expand a packed framebuffer to one byte per pixel.
  *
- * Destroys SDL window and renderer or equivalent platform components.
+ * Compatibility helper for code written against the old layout (tools,
+ * backends that upload a byte or RGBA texture).
+ *
+ * @param rows   DISPLAY_HEIGHT packed rows (e.g., `chip8->display`).
+ * @param pixels Output, DISPLAY_WIDTH * DISPLAY_HEIGHT bytes (0 or 1), row-major.
  */
-void display_quit() {
-    platform_quit();  // Cleanup handled by platform backend
+void display_unpack(const uint64_t *rows, uint8_t *pixels) {
+    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+        for (int x = 0; x < DISPLAY_WIDTH; x++) {
+            pixels[y * DISPLAY_WIDTH + x] = (uint8_t)((rows[y] >> (63 - x)) & 1);
+        }
+    }
 }
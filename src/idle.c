@@ -0,0 +1,110 @@
+/**
+ * idle.c
+ *
+ * Idle-loop detection and fast-forward.
+ *
+ * Most games wait for the delay timer in a three-instruction spin:
+ *
+ *     loop: LD Vx, DT      (Fx07)
+ *           SE Vx, kk      (3xkk, or SNE Vx, kk: 4xkk)
+ *           JP loop        (1nnn back to the Fx07)
+ *
+ * Each pass only reads the delay timer into Vx, and the keypad is polled
+ * once per frame, so nothing but the timer can end the loop within a frame.
+ * The timer is a function of the emulated clock (see timer.c), so every
+ * pass up to the next 60Hz tick reads the same value. Instead of executing
+ * those passes, `idle_skip` advances `chip8->cycles` by whole passes and
+ * stores the value the last one would have read. The pass that leaves the
+ * loop, and any pass that does not fit in the frame's budget, run normally,
+ * so the machine state after every frame is identical to plain execution.
+ */
+
+#include "idle.h"
+#include "dispatch.h"
+#include "opcodes.h"
+#include "timer.h"
+
+/**
+ * Reads the big-endian opcode at `addr`.
+ */
+static inline uint16_t fetch(const Chip8 *chip8, uint16_t addr) {
+    return (uint16_t)((chip8->memory[addr] << 8) | chip8->memory[addr + 1]);
+}
+
+/**
+ * Checks whether a timer-wait loop starts at `addr`.
+ *
+ * @param chip8 Pointer to the emulator state.
+ * @param addr  Address of the candidate Fx07.
+ * @return      true for Fx07 ; 3xkk/4xkk ; 1nnn with nnn == addr.
+ */
+bool idle_match(const Chip8 *chip8, uint16_t addr) {
+    if (addr > MEMORY_SIZE - 2 * IDLE_LOOP_LENGTH) return false;
+
+    uint16_t read = fetch(chip8, addr);
+    uint16_t skip = fetch(chip8, addr + 2);
+    uint16_t jump = fetch(chip8, addr + 4);
+
+    return (read & 0xF0FF) == 0xF007 &&
+           ((skip >> 12) == 0x3 || (skip >> 12) == 0x4) &&
+           jump == (0x1000 | addr);
+}
+
+/**
+ * Checks whether PC is at a timer-wait loop that `chip8_step` fast-forwards
+ * (`skip_idle` on). The JIT and recompiled programs stop before such a
+ * loop, so its passes are skipped instead of run as native blocks.
+ *
+ * @param chip8 Pointer to the emulator state.
+ * @return      true if the decode cache marks PC as an idle loop.
+ */
+bool idle_at(Chip8 *chip8) {
+    if (!chip8->skip_idle || chip8->pc >= MEMORY_SIZE - 1) return false;
+
+    const DecodedOp *op = &chip8->decoded[chip8->pc];
+    if (!op->handler) op = dispatch_decode(chip8, chip8->pc);
+    return op->idle;
+}
+
+/**
+ * Skips passes of the timer-wait loop at PC that cannot leave it.
+ *
+ * Walks the emulated clock one delay-timer value at a time: while the value
+ * keeps the loop spinning, all passes that start before the next tick are
+ * skipped at once. Stops at the first pass that would take the exit, or
+ * when no further whole pass fits in `budget`.
+ *
+ * @param chip8  Pointer to the emulator state (PC at the loop's Fx07).
+ * @param opcode The Fx07 opcode at PC.
+ * @param budget Most instructions that may be executed.
+ * @return       Instructions skipped (a multiple of IDLE_LOOP_LENGTH), 0 if none.
+ */
+uint32_t idle_skip(Chip8 *chip8, uint16_t opcode, uint32_t budget) {
+    uint16_t skip = fetch(chip8, chip8->pc + 2);
+    uint8_t x = OPCODE_X(opcode);
+    uint8_t y = OPCODE_X(skip);
+    bool exit_on_equal = (skip >> 12) == 0x3;
+
+    uint64_t start = chip8->cycles;
+    uint64_t limit = start + budget - budget % IDLE_LOOP_LENGTH;
+
+    while (chip8->cycles < limit) {
+        uint8_t delay = get_delay_timer(chip8);
+
+        // The skip tests the value just loaded unless it names another register
+        uint8_t tested = y == x ? delay : chip8->V[y];
+        if ((tested == OPCODE_KK(skip)) == exit_on_equal) break;
+
+        // Every pass that starts before the timer next changes reads `delay`
+        uint64_t change = delay ? timer_next_tick(chip8, chip8->cycles) : limit;
+        uint64_t passes = (change - chip8->cycles + IDLE_LOOP_LENGTH - 1) / IDLE_LOOP_LENGTH;
+        uint64_t room = (limit - chip8->cycles) / IDLE_LOOP_LENGTH;
+
+        chip8->V[x] = delay;
+        chip8->cycles += (passes < room ? passes : room) * IDLE_LOOP_LENGTH;
+    }
+
+    uint32_t skipped = (uint32_t)(chip8->cycles - start);
+    chip8->idle_skipped += skipped;
+    return skipped;
+}
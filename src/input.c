@@ -6,7 +6,7 @@
  * Handles input from the platform's physical or virtual keyboard.
  * Provides abstractions for:
  * - Initializing the keypad state
- * - Polling for input
+ * - Polling for input, or queueing timestamped key events at emulated cycles
  * - Setting and querying individual key states
  */
 
@@ -32,20 +32,100 @@ void keypad_init(Chip8 *chip8) {
 }
 
 /**
- * Poll current key states from the platform layer.
+ * Read the platform's input for the next frame.
  *
- * Updates the internal `chip8->keypad` array with the status of each key.
- * Delegates to `platform_poll_input` which handles SDL or WASM input.
+ * Platforms with `read_input` deliver key presses and releases stamped
+ * with the host clock. They are queued in `chip8->key_events` and spread
+ * over the frame's `cycles` instructions in proportion to when they
+ * happened between the previous read and this one, so presses and releases
+ * land at the matching point of the emulated frame and a tap shorter than
+ * a frame is still seen by the program. `chip8_run` applies each event
+ * just before the instruction at its cycle (see `keypad_apply_events`).
  *
- * @param chip8 Pointer to the CHIP-8 emulator state.
+ * Other platforms are polled for the whole keypad state, which applies at
+ * once; keys are left unchanged when running headless.
+ *
+ * @param chip8  Pointer to the CHIP-8 emulator state.
+ * @param cycles Instructions in the frame about to run.
  */
-void keypad_scan(Chip8 *chip8) {
+void keypad_scan(Chip8 *chip8, uint32_t cycles) {
     if (!chip8) {
         DEBUG_PRINT(chip8, "keypad_scan: chip8 pointer is null\n");
         return;
     }
 
-    platform_poll_input(chip8->keypad);  // Platform-specific polling
+    // Events of a frame that stopped early still take effect, in order
+    while (chip8->key_event_next < chip8->key_event_count) {
+        const KeyEvent *event = &chip8->key_events[chip8->key_event_next++];
+        chip8->keypad[event->key] = event->down;
+    }
+    chip8->key_event_count = chip8->key_event_next = 0;
+
+    const Platform *platform = chip8->platform;
+    if (!platform || !platform->read_input) {
+        platform_poll_input(platform, chip8->keypad);  // Platform-specific polling
+        return;
+    }
+
+    InputEvent events[KEY_EVENT_QUEUE];
+    uint64_t now = 0;
+    size_t count = platform_read_input(platform, events, KEY_EVENT_QUEUE, &now);
+
+    // Host window the events were collected in; the first read has none
+    uint64_t since = chip8->input_read_us;
+    uint64_t window = (since && now > since) ? now - since : 0;
+    chip8->input_read_us = now;
+
+    uint64_t start = chip8->cycles;
+    uint64_t at = start;
+
+    for (size_t i = 0; i < count; i++) {
+        if (events[i].key >= KEYPAD_SIZE) {
+            DEBUG_PRINT(chip8, "Invalid key index in input event: %d\n", events[i].key);
+            continue;
+        }
+
+        if (window && cycles && events[i].time_us > since) {
+            uint64_t offset = events[i].time_us - since;
+            if (offset >= window) offset = window - 1;
+
+            uint64_t cycle = start + offset * cycles / window;
+            if (cycle > at) at = cycle;  // Host order is kept even if timestamps are not monotonic
+        }
+
+        chip8->key_events[chip8->key_event_count++] = (KeyEvent){
+            .cycle = at,
+            .key = events[i].key,
+            .down = events[i].down,
+        };
+    }
+}
+
+/**
+ * Apply the queued key events that are due.
+ *
+ * Every event scheduled at or before `chip8->cycles` updates the keypad.
+ * Called by `chip8_run` between instruction batches; the next batch must
+ * stop at the returned cycle so the following event lands exactly there.
+ *
+ * @param chip8 Pointer to the CHIP-8 emulator state.
+ * @param end   End of the current batch.
+ * @return      Cycle of the next pending event, or `end` if it is later or none is left.
+ */
+uint64_t keypad_apply_events(Chip8 *chip8, uint64_t end) {
+    if (!chip8) {
+        DEBUG_PRINT(chip8, "keypad_apply_events called on null Chip8 pointer\n");
+        return end;
+    }
+
+    while (chip8->key_event_next < chip8->key_event_count) {
+        const KeyEvent *event = &chip8->key_events[chip8->key_event_next];
+        if (event->cycle > chip8->cycles) return event->cycle < end ? event->cycle : end;
+
+        chip8->keypad[event->key] = event->down;
+        chip8->key_event_next++;
+    }
+    return end;
 }
 
 /**
@@ -93,3 +173,23 @@ bool is_key_pressed(Chip8 *chip8, uint8_t key) {
     DEBUG_PRINT(chip8, "Invalid key index: %d\n", key);
     return false;
 }
+
+/**
+ * Query whether any CHIP-8 key is currently pressed.
+ *
+ * Used by `chip8_run` to end a key wait (Fx0A).
+ *
+ * @param chip8 Pointer to the CHIP-8 emulator state.
+ * @return      true if at least one key is pressed; false otherwise.
+ */
+bool is_any_key_pressed(const Chip8 *chip8) {
+    if (!chip8) {
+        DEBUG_PRINT(chip8, "is_any_key_pressed called on null Chip8 pointer\n");
+        return false;
+    }
+
+    for (uint8_t key = 0; key < KEYPAD_SIZE; key++) {
+        if (chip8->keypad[key]) return true;
+    }
+    return false;
+}
@@ -0,0 +1,636 @@
+/**
+ * jit.c
+ *
+ * Optional x86-64 basic-block JIT backend for the CHIP-8 CPU core.
+ *
+ * Straight-line runs of instructions are translated into native code once
+ * their start address has been visited `hot_threshold` times. Within a block:
+ * - The Chip8 pointer lives in rbx
+ * - Up to four of the most used V registers are kept in r12d-r15d
+ * - ALU, load-immediate and I-register opcodes are emitted natively
+ * - Rare opcodes call the existing handlers in opcodes.c
+ *
+ * Blocks end at control flow (1nnn, 2nnn, 00EE, Bnnn, skips), Dxyn, Fx0A and
+ * memory stores. Every block executes a fixed number of instructions, so
+ * `chip8_run` can keep exact per-frame instruction budgets. The emulated
+ * clock (`chip8->cycles`) advances once per block, so timer opcodes
+ * (Fx07/Fx15/Fx18) only appear first in a block, where the clock is exact.
+ * Any memory write that touches compiled bytes flushes the whole code cache.
+ */
+
+#ifndef _WIN32
+#define _DEFAULT_SOURCE  // MAP_ANONYMOUS is hidden under -std=c99
+#endif
+
+#include "jit.h"
+#include "dispatch.h"
+#include "idle.h"
+#include "opcodes.h"
+#include "utils.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(_M_X64)) && !defined(__EMSCRIPTEN__)
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#define JIT_CODE_SIZE (1 << 20)            // Executable buffer shared by all blocks
+#define JIT_MAX_BLOCK_OPS 64               // Longest straight-line block
+#define JIT_MAX_OP_BYTES 128               // Worst-case native bytes per instruction
+#define JIT_MAX_BLOCK_BYTES (JIT_MAX_BLOCK_OPS * JIT_MAX_OP_BYTES + 128)
+#define JIT_CACHED_REGS 4                  // V registers pinned in r12d-r15d
+
+// Host register numbers (x86-64 encoding)
+#define EAX 0
+#define ECX 1
+#define EDX 2
+#define R12 12
+
+// Offsets of Chip8 fields addressed relative to rbx
+#define OFF_V(x) ((int32_t)(offsetof(Chip8, V) + (x)))
+#define OFF_I    ((int32_t)offsetof(Chip8, I))
+#define OFF_PC   ((int32_t)offsetof(Chip8, pc))
+
+typedef void (*JitBlockFn)(Chip8 *chip8);
+
+// A compiled block, indexed by its start address
+typedef struct {
+    JitBlockFn code;                       // Native entry point, NULL if not compiled
+    uint8_t length;                        // Instructions executed per entry
+} JitBlock;
+
+struct Jit {
+    uint8_t *code;                         // Executable code buffer
+    size_t used;                           // Bytes of `code` in use
+    uint16_t hot_threshold;                // Visits before compiling an address
+    uint16_t heat[MEMORY_SIZE];            // Hot-block counters per start address
+    bool covered[MEMORY_SIZE];             // Bytes translated into some block
+    JitBlock blocks[MEMORY_SIZE];
+};
+
+// Emission cursor for the block being compiled
+typedef struct {
+    uint8_t *p;
+    int8_t host[REGISTER_COUNT];           // V index -> pinned host register, or -1
+} Emitter;
+
+/* ------------------------------------------------------------
+ * Instruction Encoding
+ * ------------------------------------------------------------ */
+
+static void emit8(Emitter *e, uint8_t b) {
+    *e->p++ = b;
+}
+
+static void emit32(Emitter *e, uint32_t v) {
+    memcpy(e->p, &v, 4);
+    e->p += 4;
+}
+
+static void emit64(Emitter *e, uint64_t v) {
+    memcpy(e->p, &v, 8);
+    e->p += 8;
+}
+
+// ModRM for [rbx + disp32] with the given reg field
+static void emit_rbx_disp(Emitter *e, uint8_t reg, int32_t disp) {
+    emit8(e, 0x80 | (reg << 3) | 3);
+    emit32(e, (uint32_t)disp);
+}
+
+// scratch = zero-extended Vx
+static void emit_load_v(Emitter *e, uint8_t scratch, uint8_t x) {
+    if (e->host[x] >= 0) {
+        emit8(e, 0x41); emit8(e, 0x8B);                       // mov scratch, r1Xd
+        emit8(e, 0xC0 | (scratch << 3) | (e->host[x] & 7));
+    } else {
+        emit8(e, 0x0F); emit8(e, 0xB6);                       // movzx scratch, byte [rbx+V+x]
+        emit_rbx_disp(e, scratch, OFF_V(x));
+    }
+}
+
+// Vx = low byte of scratch
+static void emit_store_v(Emitter *e, uint8_t x, uint8_t scratch) {
+    if (e->host[x] >= 0) {
+        emit8(e, 0x44); emit8(e, 0x0F); emit8(e, 0xB6);       // movzx r1Xd, scratch8
+        emit8(e, 0xC0 | ((e->host[x] & 7) << 3) | scratch);
+    } else {
+        emit8(e, 0x88);                                       // mov byte [rbx+V+x], scratch8
+        emit_rbx_disp(e, scratch, OFF_V(x));
+    }
+}
+
+// Vx = imm8
+static void emit_store_v_imm(Emitter *e, uint8_t x, uint8_t imm) {
+    if (e->host[x] >= 0) {
+        emit8(e, 0x41); emit8(e, 0xB8 + (e->host[x] & 7));   // mov r1Xd, imm32
+        emit32(e, imm);
+    } else {
+        emit8(e, 0xC6);                                       // mov byte [rbx+V+x], imm8
+        emit_rbx_disp(e, 0, OFF_V(x));
+        emit8(e, imm);
+    }
+}
+
+// word field = imm16
+static void emit_store_word_imm(Emitter *e, int32_t disp, uint16_t imm) {
+    emit8(e, 0x66); emit8(e, 0xC7);
+    emit_rbx_disp(e, 0, disp);
+    emit8(e, imm & 0xFF); emit8(e, imm >> 8);
+}
+
+// word field = ax
+static void emit_store_word(Emitter *e, int32_t disp) {
+    emit8(e, 0x66); emit8(e, 0x89);
+    emit_rbx_disp(e, EAX, disp);
+}
+
+// Write pinned registers back to chip8->V
+static void emit_flush(Emitter *e) {
+    for (uint8_t x = 0; x < REGISTER_COUNT; x++) {
+        if (e->host[x] >= 0) {
+            emit8(e, 0x44); emit8(e, 0x88);                   // mov byte [rbx+V+x], r1Xb
+            emit_rbx_disp(e, e->host[x] & 7, OFF_V(x));
+        }
+    }
+}
+
+// Reload pinned registers from chip8->V
+static void emit_reload(Emitter *e) {
+    for (uint8_t x = 0; x < REGISTER_COUNT; x++) {
+        if (e->host[x] >= 0) {
+            emit8(e, 0x44); emit8(e, 0x0F); emit8(e, 0xB6);   // movzx r1Xd, byte [rbx+V+x]
+            emit_rbx_disp(e, e->host[x] & 7, OFF_V(x));
+        }
+    }
+}
+
+static void emit_prologue(Emitter *e) {
+    emit8(e, 0x53);                                           // push rbx
+    emit8(e, 0x41); emit8(e, 0x54);                           // push r12
+    emit8(e, 0x41); emit8(e, 0x55);                           // push r13
+    emit8(e, 0x41); emit8(e, 0x56);                           // push r14
+    emit8(e, 0x41); emit8(e, 0x57);                           // push r15
+    emit8(e, 0x48); emit8(e, 0x83); emit8(e, 0xEC); emit8(e, 0x20); // sub rsp, 32 (shadow space, keeps alignment)
+#ifdef _WIN32
+    emit8(e, 0x48); emit8(e, 0x89); emit8(e, 0xCB);           // mov rbx, rcx
+#else
+    emit8(e, 0x48); emit8(e, 0x89); emit8(e, 0xFB);           // mov rbx, rdi
+#endif
+    emit_reload(e);
+}
+
+static void emit_epilogue(Emitter *e) {
+    emit_flush(e);
+    emit8(e, 0x48); emit8(e, 0x83); emit8(e, 0xC4); emit8(e, 0x20); // add rsp, 32
+    emit8(e, 0x41); emit8(e, 0x5F);                           // pop r15
+    emit8(e, 0x41); emit8(e, 0x5E);                           // pop r14
+    emit8(e, 0x41); emit8(e, 0x5D);                           // pop r13
+    emit8(e, 0x41); emit8(e, 0x5C);                           // pop r12
+    emit8(e, 0x5B);                                           // pop rbx
+    emit8(e, 0xC3);                                           // ret
+}
+
+// Call an interpreter handler with PC already advanced past the instruction
+static void emit_fallback(Emitter *e, OpcodeHandler handler, uint16_t opcode, uint16_t addr) {
+    emit_flush(e);
+    emit_store_word_imm(e, OFF_PC, addr + 2);
+#ifdef _WIN32
+    emit8(e, 0x48); emit8(e, 0x89); emit8(e, 0xD9);           // mov rcx, rbx
+    emit8(e, 0xBA); emit32(e, opcode);                        // mov edx, opcode
+#else
+    emit8(e, 0x48); emit8(e, 0x89); emit8(e, 0xDF);           // mov rdi, rbx
+    emit8(e, 0xBE); emit32(e, opcode);                        // mov esi, opcode
+#endif
+    emit8(e, 0x48); emit8(e, 0xB8);                           // mov rax, handler
+    emit64(e, (uint64_t)(uintptr_t)handler);
+    emit8(e, 0xFF); emit8(e, 0xD0);                           // call rax
+    emit_reload(e);
+}
+
+// pc = condition ? addr + 4 : addr + 2, using flags set by the caller
+static void emit_skip(Emitter *e, uint16_t addr, bool skip_if_equal) {
+    emit8(e, 0xB8); emit32(e, addr + 2);                      // mov eax, addr + 2
+    emit8(e, 0xB9); emit32(e, addr + 4);                      // mov ecx, addr + 4
+    emit8(e, 0x0F); emit8(e, skip_if_equal ? 0x44 : 0x45);    // cmove/cmovne eax, ecx
+    emit8(e, 0xC1);
+    emit_store_word(e, OFF_PC);
+}
+
+/* ------------------------------------------------------------
+ * Block Translation
+ * ------------------------------------------------------------ */
+
+// How an opcode is translated
+typedef enum {
+    JIT_NATIVE,                            // Emitted inline, block continues
+    JIT_FALLBACK,                          // Handler call, block continues
+    JIT_FALLBACK_END,                      // Handler call, block ends (control flow or store)
+    JIT_BRANCH_END                         // Emitted inline, sets PC, block ends
+} JitKind;
+
+static JitKind jit_classify(uint16_t opcode) {
+    uint8_t n = opcode & 0x000F;
+    uint8_t kk = opcode & 0x00FF;
+
+    switch (opcode >> 12) {
+        case 0x0: return opcode == 0x00E0 ? JIT_FALLBACK : JIT_FALLBACK_END;
+        case 0x1: case 0x3: case 0x4: case 0x5: case 0x9: return JIT_BRANCH_END;
+        case 0x2: case 0xB: case 0xD: case 0xE: return JIT_FALLBACK_END;
+        case 0x6: case 0x7: case 0xA: return JIT_NATIVE;
+        case 0x8: return (n <= 0x7 || n == 0xE) ? JIT_NATIVE : JIT_FALLBACK;
+        case 0xC: return JIT_FALLBACK;
+        case 0xF:
+            switch (kk) {
+                case 0x1E: case 0x29: return JIT_NATIVE;
+                case 0x0A: case 0x33: case 0x55: return JIT_FALLBACK_END;
+                default: return JIT_FALLBACK;
+            }
+    }
+    return JIT_FALLBACK;
+}
+
+// Timer opcodes read or timestamp the emulated clock
+static bool jit_uses_clock(uint16_t opcode) {
+    uint8_t kk = opcode & 0x00FF;
+    return (opcode >> 12) == 0xF && (kk == 0x07 || kk == 0x15 || kk == 0x18);
+}
+
+// Emit an opcode classified as JIT_NATIVE
+static void jit_emit_native(Emitter *e, uint16_t opcode) {
+    uint8_t x = (opcode >> 8) & 0x0F;
+    uint8_t y = (opcode >> 4) & 0x0F;
+    uint8_t kk = opcode & 0x00FF;
+
+    switch (opcode >> 12) {
+        case 0x6:
+            emit_store_v_imm(e, x, kk);
+            return;
+        case 0x7:
+            emit_load_v(e, EAX, x);
+            emit8(e, 0x05); emit32(e, kk);                    // add eax, kk
+            emit_store_v(e, x, EAX);
+            return;
+        case 0xA:
+            emit_store_word_imm(e, OFF_I, opcode & 0x0FFF);
+            return;
+        case 0x8:
+            break;
+        case 0xF:
+            switch (kk) {
+                case 0x1E:
+                    emit_load_v(e, EAX, x);
+                    emit8(e, 0x66); emit8(e, 0x01);           // add word [rbx+I], ax
+                    emit_rbx_disp(e, EAX, OFF_I);
+                    return;
+                case 0x29:
+                    emit_load_v(e, EAX, x);
+                    emit8(e, 0x8D); emit8(e, 0x04); emit8(e, 0x80); // lea eax, [rax+rax*4]
+                    emit_store_word(e, OFF_I);
+                    return;
+            }
+            return;
+    }
+
+    // 8xy* ALU group; VF writes happen before the Vx write, as in opcodes.c
+    switch (opcode & 0x000F) {
+        case 0x0:
+            emit_load_v(e, EAX, y);
+            emit_store_v(e, x, EAX);
+            return;
+        case 0x1:
+        case 0x2:
+        case 0x3: {
+            static const uint8_t alu[] = { 0, 0x09, 0x21, 0x31 }; // or / and / xor eax, ecx
+            emit_load_v(e, EAX, x);
+            emit_load_v(e, ECX, y);
+            emit8(e, alu[opcode & 0x000F]); emit8(e, 0xC8);
+            emit_store_v(e, x, EAX);
+            return;
+        }
+        case 0x4:
+            emit_load_v(e, EAX, x);
+            emit_load_v(e, ECX, y);
+            emit8(e, 0x01); emit8(e, 0xC8);                   // add eax, ecx
+            emit8(e, 0x89); emit8(e, 0xC2);                   // mov edx, eax
+            emit8(e, 0xC1); emit8(e, 0xEA); emit8(e, 0x08);   // shr edx, 8
+            emit_store_v(e, 0xF, EDX);
+            emit_store_v(e, x, EAX);
+            return;
+        case 0x5:
+        case 0x7: {
+            uint8_t minuend = (opcode & 0x000F) == 0x5 ? x : y;
+            uint8_t subtrahend = (opcode & 0x000F) == 0x5 ? y : x;
+            emit_load_v(e, EAX, minuend);
+            emit_load_v(e, ECX, subtrahend);
+            emit8(e, 0x39); emit8(e, 0xC8);                   // cmp eax, ecx
+            emit8(e, 0x0F); emit8(e, 0x97); emit8(e, 0xC2);   // seta dl
+            emit_store_v(e, 0xF, EDX);
+            emit_load_v(e, EAX, minuend);                     // reload: VF may alias
+            emit_load_v(e, ECX, subtrahend);
+            emit8(e, 0x29); emit8(e, 0xC8);                   // sub eax, ecx
+            emit_store_v(e, x, EAX);
+            return;
+        }
+        case 0x6:
+            emit_load_v(e, EAX, x);
+            emit8(e, 0x25); emit32(e, 0x01);                  // and eax, 1
+            emit_store_v(e, 0xF, EAX);
+            emit_load_v(e, EAX, x);
+            emit8(e, 0xD1); emit8(e, 0xE8);                   // shr eax, 1
+            emit_store_v(e, x, EAX);
+            return;
+        case 0xE:
+            emit_load_v(e, EAX, x);
+            emit8(e, 0xC1); emit8(e, 0xE8); emit8(e, 0x07);   // shr eax, 7
+            emit_store_v(e, 0xF, EAX);
+            emit_load_v(e, EAX, x);
+            emit8(e, 0xD1); emit8(e, 0xE0);                   // shl eax, 1
+            emit_store_v(e, x, EAX);
+            return;
+    }
+}
+
+// Emit an opcode classified as JIT_BRANCH_END
+static void jit_emit_branch(Emitter *e, uint16_t opcode, uint16_t addr) {
+    uint8_t x = (opcode >> 8) & 0x0F;
+    uint8_t y = (opcode >> 4) & 0x0F;
+
+    switch (opcode >> 12) {
+        case 0x1:
+            emit_store_word_imm(e, OFF_PC, opcode & 0x0FFF);
+            return;
+        case 0x3:
+        case 0x4:
+            emit_load_v(e, EAX, x);
+            emit8(e, 0x3D); emit32(e, opcode & 0x00FF);       // cmp eax, kk
+            emit_skip(e, addr, (opcode >> 12) == 0x3);
+            return;
+        case 0x5:
+        case 0x9:
+            emit_load_v(e, EAX, x);
+            emit_load_v(e, ECX, y);
+            emit8(e, 0x39); emit8(e, 0xC8);                   // cmp eax, ecx
+            emit_skip(e, addr, (opcode >> 12) == 0x5);
+            return;
+    }
+}
+
+// Pick the most used V registers of the block to pin in r12d-r15d
+static void jit_assign_registers(Emitter *e, const uint8_t *memory, uint16_t start, uint16_t end) {
+    uint16_t uses[REGISTER_COUNT] = {0};
+
+    for (uint16_t addr = start; addr < end; addr += 2) {
+        uint16_t opcode = (memory[addr] << 8) | memory[addr + 1];
+        if (jit_classify(opcode) == JIT_FALLBACK || jit_classify(opcode) == JIT_FALLBACK_END)
+            continue;
+        uses[(opcode >> 8) & 0x0F]++;
+        if ((opcode >> 12) == 0x8 || (opcode >> 12) == 0x5 || (opcode >> 12) == 0x9) {
+            uses[(opcode >> 4) & 0x0F]++;
+            uses[0xF]++;
+        }
+    }
+
+    memset(e->host, -1, sizeof(e->host));
+    for (int slot = 0; slot < JIT_CACHED_REGS; slot++) {
+        int best = -1;
+        for (int x = 0; x < REGISTER_COUNT; x++) {
+            if (e->host[x] < 0 && uses[x] >= 2 && (best < 0 || uses[x] > uses[best]))
+                best = x;
+        }
+        if (best < 0) break;
+        e->host[best] = R12 + slot;
+    }
+}
+
+// Drop every compiled block
+static void jit_flush(struct Jit *jit) {
+    memset(jit->blocks, 0, sizeof(jit->blocks));
+    memset(jit->covered, 0, sizeof(jit->covered));
+    jit->used = 0;
+}
+
+/**
+ * Translates the straight-line block starting at `start`.
+ *
+ * @param jit   JIT state of the instance.
+ * @param chip8 Instance whose memory holds the code.
+ * @param start Address of the first instruction.
+ * @return      The compiled block, or NULL if nothing could be translated.
+ */
+static JitBlock *jit_compile(struct Jit *jit, Chip8 *chip8, uint16_t start) {
+    if (jit->used + JIT_MAX_BLOCK_BYTES > JIT_CODE_SIZE) {
+        jit_flush(jit);
+    }
+
+    // Find the block extent first so register pinning can see all of it
+    uint16_t end = start;
+    uint8_t length = 0;
+    while (length < JIT_MAX_BLOCK_OPS && end < MEMORY_SIZE - 1) {
+        uint16_t opcode = (chip8->memory[end] << 8) | chip8->memory[end + 1];
+        JitKind kind = jit_classify(opcode);
+
+        // The clock is only exact at block entry; start a new block here
+        if (length > 0 && jit_uses_clock(opcode)) break;
+
+        end += 2;
+        length++;
+        if (kind == JIT_FALLBACK_END || kind == JIT_BRANCH_END) break;
+    }
+    if (length == 0) return NULL;
+
+    Emitter e = { .p = jit->code + jit->used };
+    jit_assign_registers(&e, chip8->memory, start, end);
+
+    uint8_t *entry = e.p;
+    bool pc_set = false;
+    emit_prologue(&e);
+
+    for (uint16_t addr = start; addr < end; addr += 2) {
+        uint16_t opcode = (chip8->memory[addr] << 8) | chip8->memory[addr + 1];
+
+        switch (jit_classify(opcode)) {
+            case JIT_NATIVE:
+                jit_emit_native(&e, opcode);
+                break;
+            case JIT_FALLBACK:
+                emit_fallback(&e, dispatch_resolve(opcode), opcode, addr);
+                break;
+            case JIT_FALLBACK_END:
+                emit_fallback(&e, dispatch_resolve(opcode), opcode, addr);
+                pc_set = true;
+                break;
+            case JIT_BRANCH_END:
+                jit_emit_branch(&e, opcode, addr);
+                pc_set = true;
+                break;
+        }
+    }
+
+    // Block ran off its length limit: continue after the last instruction
+    if (!pc_set) {
+        emit_store_word_imm(&e, OFF_PC, end);
+    }
+    emit_epilogue(&e);
+
+    jit->used = e.p - jit->code;
+    memset(&jit->covered[start], 1, end - start);
+
+    JitBlock *block = &jit->blocks[start];
+    block->code = (JitBlockFn)(uintptr_t)entry;
+    block->length = length;
+    return block;
+}
+
+/* ------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------ */
+
+/**
+ * Enables the JIT backend for an instance.
+ *
+ * @param chip8         Pointer to the emulator state (after chip8_init).
+ * @param hot_threshold Visits before an address is compiled (1 = compile eagerly).
+ * @return              true if the JIT is active, false if allocation failed.
+ */
+bool jit_enable(Chip8 *chip8, uint16_t hot_threshold) {
+    if (!chip8) {
+        fprintf(stderr, "jit_enable called on null Chip8 pointer\n");
+        return false;
+    }
+    if (chip8->jit) {
+        chip8->jit->hot_threshold = hot_threshold;
+        return true;
+    }
+
+    struct Jit *jit = calloc(1, sizeof(struct Jit));
+    if (!jit) return false;
+
+#ifdef _WIN32
+    jit->code = VirtualAlloc(NULL, JIT_CODE_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+#else
+    jit->code = mmap(NULL, JIT_CODE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (jit->code == MAP_FAILED) jit->code = NULL;
+#endif
+    if (!jit->code) {
+        fprintf(stderr, "[JIT] Could not allocate executable memory; using interpreter\n");
+        free(jit);
+        return false;
+    }
+
+    jit->hot_threshold = hot_threshold;
+    chip8->jit = jit;
+    return true;
+}
+
+/**
+ * Disables the JIT backend and frees its resources.
+ *
+ * @param chip8 Pointer to the emulator state.
+ */
+void jit_disable(Chip8 *chip8) {
+    if (!chip8 || !chip8->jit) return;
+
+#ifdef _WIN32
+    VirtualFree(chip8->jit->code, 0, MEM_RELEASE);
+#else
+    munmap(chip8->jit->code, JIT_CODE_SIZE);
+#endif
+    free(chip8->jit);
+    chip8->jit = NULL;
+}
+
+/**
+ * Runs compiled blocks back to back, starting at the current PC.
+ *
+ * Stops when PC reaches an address that is not (yet) hot, a timer-wait
+ * loop the interpreter fast-forwards (see idle.c), when the next block
+ * would exceed the remaining instruction budget, or when the VM starts
+ * waiting for a key. Advances the emulated clock after each block.
+ *
+ * @param chip8  Pointer to the emulator state.
+ * @param budget Maximum number of instructions to execute.
+ * @return       Number of instructions executed.
+ */
+uint32_t jit_execute(Chip8 *chip8, uint32_t budget) {
+    struct Jit *jit = chip8->jit;
+    uint32_t executed = 0;
+
+    while (chip8->pc < MEMORY_SIZE - 1) {
+        uint16_t pc = chip8->pc;
+        JitBlock *block = &jit->blocks[pc];
+
+        // Timer-wait loops are fast-forwarded by the interpreter instead
+        if (idle_at(chip8)) break;
+
+        if (!block->code) {
+            if (jit->heat[pc] < jit->hot_threshold - 1) {
+                jit->heat[pc]++;
+                break;
+            }
+            block = jit_compile(jit, chip8, pc);
+            if (!block) break;
+        }
+
+        if (block->length > budget - executed) break;
+
+        // A store into translated bytes flushes the cache, block included
+        uint8_t length = block->length;
+        block->code(chip8);
+        executed += length;
+        chip8->cycles += length;
+
+        // Fx0A found no key: chip8_run idles out the frame
+        if (chip8->key_wait) break;
+    }
+
+    return executed;
+}
+
+/**
+ * Flushes the code cache if a write touched translated bytes.
+ *
+ * @param chip8 Pointer to the emulator state.
+ * @param addr  First written address.
+ * @param len   Number of bytes written.
+ */
+void jit_invalidate(Chip8 *chip8, uint16_t addr, uint16_t len) {
+    struct Jit *jit = chip8->jit;
+    uint32_t end = (uint32_t)addr + len;
+
+    if (end > MEMORY_SIZE) end = MEMORY_SIZE;
+
+    for (uint32_t i = addr; i < end; i++) {
+        if (jit->covered[i]) {
+            jit_flush(jit);
+            return;
+        }
+    }
+}
+
+#else
+
+/* ------------------------------------------------------------
+ * Unsupported hosts: the interpreter is always used
+ * ------------------------------------------------------------ */
+
+bool jit_enable(Chip8 *chip8, uint16_t hot_threshold) {
+    fprintf(stderr, "[JIT] Not supported on this host; using interpreter\n");
+    return false;
+}
+
+void jit_disable(Chip8 *chip8) {}
+
+uint32_t jit_execute(Chip8 *chip8, uint32_t budget) {
+    return 0;
+}
+
+void jit_invalidate(Chip8 *chip8, uint16_t addr, uint16_t len) {}
+
+#endif
@@ -0,0 +1,1139 @@
+/**
+ * lockstep.c
+ *
+ * Lockstep execution of many copies of one ROM (input search, RL rollouts).
+ *
+ * The register files of all lanes are kept in structure-of-arrays form,
+ * `V[r][lane]`, `I[lane]`, `pc[lane]`, for the whole of `lockstep_run`:
+ * they are gathered from the lanes' `Chip8`s once when it starts and
+ * scattered back once when it returns. Everything else a lane owns (memory,
+ * stack, timers, framebuffer, keypad) stays in its own `Chip8`.
+ *
+ * Lanes are grouped by PC into compact lane lists, which persist from step
+ * to step. Each step executes one instruction on every group:
+ * - Opcodes that only touch V, I, PC and the keypad (1nnn, skips, 6xkk,
+ *   7xkk, 8xy*, Annn, Fx1E, Fx29), and calls, returns, Fx07 and Fx65, run
+ *   as a loop over the group's list. A group of every lane (lanes that
+ *   never diverged) runs the register ones over the whole lane arrays with
+ *   SSE2/AVX2 operations instead.
+ * - Every other opcode is decoded once per group and its leaf handler is
+ *   called on each lane's `Chip8`, with only the registers it can access
+ *   copied in and back out.
+ * - Groups that ran a skip or a handler are split by PC, and groups that
+ *   arrive at the same PC are merged.
+ * Once the groups get too small to pay for themselves, each lane runs the
+ * rest of the run on its own, one lane after the other. Fewer lanes than a
+ * group needs never group at all.
+ *
+ * All lanes hold the same program, so opcodes are fetched and classified
+ * from one shared image. Fx33/Fx55 mark the bytes they write as dirty; at a
+ * dirty address the lanes' own memory is compared, and the address is
+ * shared again if every lane holds the same bytes there.
+ *
+ * Whichever path runs it, each lane ends in the same state as after the
+ * same number of `chip8_cycle` calls.
+ */
+
+#include "lockstep.h"
+#include "dispatch.h"
+#include "opcodes.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_LANE_AVX2 1
+#ifdef __SSE2__
+#define HAVE_LANE_SSE2 1
+#endif
+#endif
+
+// Fewer lanes per group than this on average, and grouping costs more than it saves
+#define MIN_GROUP_LANES 8
+
+// How a group executes its opcode (`ls->kernel`)
+typedef enum {
+    LANE_UNCLASSIFIED, // Not looked at yet
+    LANE_HANDLER,      // No kernel: the leaf handler on every lane's Chip8
+    LANE_JP,           // 1nnn
+    LANE_SE_BYTE,      // 3xkk
+    LANE_SNE_BYTE,     // 4xkk
+    LANE_SE_REG,       // 5xy0
+    LANE_LD_BYTE,      // 6xkk
+    LANE_ADD_BYTE,     // 7xkk
+    LANE_LD,           // 8xy0
+    LANE_OR,           // 8xy1
+    LANE_AND,          // 8xy2
+    LANE_XOR,          // 8xy3
+    LANE_ADD,          // 8xy4
+    LANE_SUB,          // 8xy5
+    LANE_SHR,          // 8xy6
+    LANE_SUBN,         // 8xy7
+    LANE_SHL,          // 8xyE
+    LANE_SNE_REG,      // 9xy0
+    LANE_LD_I,         // Annn
+    LANE_ADD_I,        // Fx1E
+    LANE_LD_F,         // Fx29
+    LANE_SKP,          // Ex9E: from here on, kernels read the lane's Chip8 (lane lists only)
+    LANE_SKNP,         // ExA1
+    LANE_CALL,         // 2nnn
+    LANE_RET,          // 00EE
+    LANE_LD_DT,        // Fx07
+    LANE_LD_BLOCK      // Fx65
+} LaneOp;
+
+// A leaf handler call and the registers it can access
+typedef struct {
+    OpcodeHandler handler;
+    uint16_t opcode;
+    uint8_t x, y;
+    uint8_t block;                   // V0..V(block - 1) for Fx55/Fx65, else 0: V0, Vx, Vy and VF
+    uint8_t stores;                  // Bytes written at I (Fx33/Fx55), else 0
+} HandlerCall;
+
+/**
+ * Reads the big-endian opcode at `addr`.
+ */
+static inline uint16_t fetch(const uint8_t *memory, uint16_t addr) {
+    return (uint16_t)((memory[addr] << 8) | memory[addr + 1]);
+}
+
+/**
+ * Picks the kernel for an opcode from the handler the interpreter would run,
+ * so both paths always agree on the decoding.
+ */
+static LaneOp classify(uint16_t opcode) {
+    static const struct {
+        OpcodeHandler handler;
+        LaneOp op;
+    } kernels[] = {
+        { op_1nnn, LANE_JP },      { op_3xkk, LANE_SE_BYTE }, { op_4xkk, LANE_SNE_BYTE },
+        { op_5xy0, LANE_SE_REG },  { op_6xkk, LANE_LD_BYTE }, { op_7xkk, LANE_ADD_BYTE },
+        { op_8xy0, LANE_LD },      { op_8xy1, LANE_OR },      { op_8xy2, LANE_AND },
+        { op_8xy3, LANE_XOR },     { op_8xy4, LANE_ADD },     { op_8xy5, LANE_SUB },
+        { op_8xy6, LANE_SHR },     { op_8xy7, LANE_SUBN },    { op_8xyE, LANE_SHL },
+        { op_9xy0, LANE_SNE_REG }, { op_Annn, LANE_LD_I },    { op_Ex9E, LANE_SKP },
+        { op_ExA1, LANE_SKNP },    { op_Fx1E, LANE_ADD_I },   { op_Fx29, LANE_LD_F },
+        { op_2nnn, LANE_CALL },    { op_00EE, LANE_RET },     { op_Fx07, LANE_LD_DT },
+        { op_Fx65, LANE_LD_BLOCK },
+    };
+
+    OpcodeHandler handler = dispatch_resolve(opcode);
+    for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+        if (kernels[i].handler == handler) return kernels[i].op;
+    }
+    return LANE_HANDLER;
+}
+
+/*
+ * Kernels. Each executes an opcode on a set of lanes: V, then PC (adding
+ * the skip) and I.
+ * - step_list: the lanes of a group's list, any host
+ * - step_sse2/step_avx2: every lane of the arrays at once, for a group of
+ *   all lanes; padding lanes compute garbage that is never read
+ *
+ * The V cases follow the statement order of their handlers in opcodes.c: VF
+ * is written first and Vx/Vy are reloaded where the handler reads them
+ * again, so x or y == F aliases exactly as in the interpreter. Bytes have
+ * no unsigned compare in SSE2/AVX2: a > b is max(a, b) == a && a != b.
+ */
+
+static void step_list(Lockstep *ls, LaneOp op, uint16_t opcode, const uint32_t *lanes, uint32_t count,
+                      uint32_t step) {
+    uint8_t *vx = ls->V[OPCODE_X(opcode)];
+    uint8_t *vy = ls->V[OPCODE_Y(opcode)];
+    uint8_t *vf = ls->V[0xF];
+    uint16_t *pc = ls->pc;
+    const uint8_t kk = OPCODE_KK(opcode);
+    const uint16_t nnn = OPCODE_NNN(opcode);
+    uint32_t k;
+
+    switch (op) {
+        case LANE_JP:
+            for (k = 0; k < count; k++) pc[lanes[k]] = nnn;
+            return;
+        case LANE_SE_BYTE:
+            for (k = 0; k < count; k++) pc[lanes[k]] += vx[lanes[k]] == kk ? 4 : 2;
+            return;
+        case LANE_SNE_BYTE:
+            for (k = 0; k < count; k++) pc[lanes[k]] += vx[lanes[k]] != kk ? 4 : 2;
+            return;
+        case LANE_SE_REG:
+            for (k = 0; k < count; k++) pc[lanes[k]] += vx[lanes[k]] == vy[lanes[k]] ? 4 : 2;
+            return;
+        case LANE_SNE_REG:
+            for (k = 0; k < count; k++) pc[lanes[k]] += vx[lanes[k]] != vy[lanes[k]] ? 4 : 2;
+            return;
+        case LANE_SKP:
+            for (k = 0; k < count; k++) {
+                uint32_t l = lanes[k];
+                pc[l] += vx[l] < KEYPAD_SIZE && ls->vm[l].keypad[vx[l]] ? 4 : 2;
+            }
+            return;
+        case LANE_SKNP:
+            for (k = 0; k < count; k++) {
+                uint32_t l = lanes[k];
+                pc[l] += vx[l] < KEYPAD_SIZE && ls->vm[l].keypad[vx[l]] ? 2 : 4;
+            }
+            return;
+        case LANE_CALL:
+            for (k = 0; k < count; k++) {
+                uint32_t l = lanes[k];
+                Chip8 *vm = &ls->vm[l];
+                if (vm->sp >= STACK_SIZE) {
+                    pc[l] += 2;
+                    continue;
+                }
+                vm->stack[vm->sp++] = pc[l] + 2;
+                pc[l] = nnn;
+            }
+            return;
+        case LANE_RET:
+            for (k = 0; k < count; k++) {
+                uint32_t l = lanes[k];
+                Chip8 *vm = &ls->vm[l];
+                pc[l] = vm->sp ? vm->stack[--vm->sp] : pc[l] + 2;
+            }
+            return;
+        case LANE_LD_DT:
+            for (k = 0; k < count; k++) {
+                uint32_t l = lanes[k];
+                ls->vm[l].cycles = ls->cycles[l] + step;
+                vx[l] = get_delay_timer(&ls->vm[l]);
+            }
+            break;
+        case LANE_LD_BLOCK:
+            for (k = 0; k < count; k++) {
+                uint32_t l = lanes[k];
+                for (int r = 0; r <= OPCODE_X(opcode); r++) ls->V[r][l] = ls->vm[l].memory[ls->I[l] + r];
+            }
+            break;
+        case LANE_LD_BYTE:
+            for (k = 0; k < count; k++) vx[lanes[k]] = kk;
+            break;
+        case LANE_ADD_BYTE:
+            for (k = 0; k < count; k++) vx[lanes[k]] += kk;
+            break;
+        case LANE_LD:
+            for (k = 0; k < count; k++) vx[lanes[k]] = vy[lanes[k]];
+            break;
+        case LANE_OR:
+            for (k = 0; k < count; k++) vx[lanes[k]] |= vy[lanes[k]];
+            break;
+        case LANE_AND:
+            for (k = 0; k < count; k++) vx[lanes[k]] &= vy[lanes[k]];
+            break;
+        case LANE_XOR:
+            for (k = 0; k < count; k++) vx[lanes[k]] ^= vy[lanes[k]];
+            break;
+        case LANE_ADD:
+            for (k = 0; k < count; k++) {
+                uint32_t l = lanes[k];
+                uint16_t sum = vx[l] + vy[l];
+                vf[l] = sum > 0xFF;
+                vx[l] = (uint8_t)sum;
+            }
+            break;
+        case LANE_SUB:
+            for (k = 0; k < count; k++) {
+                uint32_t l = lanes[k];
+                vf[l] = vx[l] > vy[l];
+                vx[l] -= vy[l];
+            }
+            break;
+        case LANE_SHR:
+            for (k = 0; k < count; k++) {
+                uint32_t l = lanes[k];
+                vf[l] = vx[l] & 0x1;
+                vx[l] >>= 1;
+            }
+            break;
+        case LANE_SUBN:
+            for (k = 0; k < count; k++) {
+                uint32_t l = lanes[k];
+                vf[l] = vy[l] > vx[l];
+                vx[l] = vy[l] - vx[l];
+            }
+            break;
+        case LANE_SHL:
+            for (k = 0; k < count; k++) {
+                uint32_t l = lanes[k];
+                vf[l] = (vx[l] & 0x80) >> 7;
+                vx[l] <<= 1;
+            }
+            break;
+        case LANE_LD_I:
+            for (k = 0; k < count; k++) ls->I[lanes[k]] = nnn;
+            break;
+        case LANE_ADD_I:
+            for (k = 0; k < count; k++) ls->I[lanes[k]] += vx[lanes[k]];
+            break;
+        case LANE_LD_F:
+            for (k = 0; k < count; k++) ls->I[lanes[k]] = vx[lanes[k]] * 5;
+            break;
+        default:
+            return;
+    }
+
+    // Everything but jumps and skips falls through
+    for (k = 0; k < count; k++) pc[lanes[k]] += 2;
+}
+
+#ifdef HAVE_LANE_SSE2
+
+static inline __m128i sse2_load(const void *p) {
+    return _mm_loadu_si128((const __m128i *)p);
+}
+
+static inline void sse2_store(void *p, __m128i v) {
+    _mm_storeu_si128((__m128i *)p, v);
+}
+
+static inline __m128i sse2_gt_u8(__m128i a, __m128i b) {
+    return _mm_andnot_si128(_mm_cmpeq_epi8(a, b), _mm_cmpeq_epi8(_mm_max_epu8(a, b), a));
+}
+
+static void step_sse2(Lockstep *ls, LaneOp op, uint16_t opcode) {
+    uint8_t *vx = ls->V[OPCODE_X(opcode)];
+    uint8_t *vy = ls->V[OPCODE_Y(opcode)];
+    uint8_t *vf = ls->V[0xF];
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi8(-1);
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i low7 = _mm_set1_epi8(0x7F);
+    const __m128i kk = _mm_set1_epi8((char)OPCODE_KK(opcode));
+    const __m128i nnn = _mm_set1_epi16((short)OPCODE_NNN(opcode));
+    const __m128i two = _mm_set1_epi16(2);
+
+    for (uint32_t j = 0; j < ls->stride; j += 16) {
+        __m128i a = sse2_load(vx + j);
+        __m128i b = sse2_load(vy + j);
+        __m128i skip = zero;
+
+        switch (op) {
+            case LANE_SE_BYTE:  skip = _mm_cmpeq_epi8(a, kk); break;
+            case LANE_SNE_BYTE: skip = _mm_andnot_si128(_mm_cmpeq_epi8(a, kk), ones); break;
+            case LANE_SE_REG:   skip = _mm_cmpeq_epi8(a, b); break;
+            case LANE_SNE_REG:  skip = _mm_andnot_si128(_mm_cmpeq_epi8(a, b), ones); break;
+            case LANE_LD_BYTE:  sse2_store(vx + j, kk); break;
+            case LANE_ADD_BYTE: sse2_store(vx + j, _mm_add_epi8(a, kk)); break;
+            case LANE_LD:       sse2_store(vx + j, b); break;
+            case LANE_OR:       sse2_store(vx + j, _mm_or_si128(a, b)); break;
+            case LANE_AND:      sse2_store(vx + j, _mm_and_si128(a, b)); break;
+            case LANE_XOR:      sse2_store(vx + j, _mm_xor_si128(a, b)); break;
+            case LANE_ADD: {
+                __m128i sum = _mm_add_epi8(a, b);
+                sse2_store(vf + j, _mm_and_si128(sse2_gt_u8(a, sum), one));
+                sse2_store(vx + j, sum);
+                break;
+            }
+            case LANE_SUB:
+                sse2_store(vf + j, _mm_and_si128(sse2_gt_u8(a, b), one));
+                a = sse2_load(vx + j);
+                b = sse2_load(vy + j);
+                sse2_store(vx + j, _mm_sub_epi8(a, b));
+                break;
+            case LANE_SHR:
+                sse2_store(vf + j, _mm_and_si128(a, one));
+                a = sse2_load(vx + j);
+                sse2_store(vx + j, _mm_and_si128(_mm_srli_epi16(a, 1), low7));
+                break;
+            case LANE_SUBN:
+                sse2_store(vf + j, _mm_and_si128(sse2_gt_u8(b, a), one));
+                a = sse2_load(vx + j);
+                b = sse2_load(vy + j);
+                sse2_store(vx + j, _mm_sub_epi8(b, a));
+                break;
+            case LANE_SHL:
+                sse2_store(vf + j, _mm_and_si128(_mm_srli_epi16(a, 7), one));
+                a = sse2_load(vx + j);
+                sse2_store(vx + j, _mm_add_epi8(a, a));
+                break;
+            default:
+                break;
+        }
+
+        // PC and I are 16-bit: each half of the block widens the skip mask
+        for (int h = 0; h < 2; h++) {
+            __m128i sw = h ? _mm_unpackhi_epi8(skip, skip) : _mm_unpacklo_epi8(skip, skip);
+            uint16_t *pc = ls->pc + j + 8 * h;
+
+            if (op == LANE_JP) {
+                sse2_store(pc, nnn);
+            } else {
+                sse2_store(pc, _mm_add_epi16(sse2_load(pc), _mm_add_epi16(two, _mm_and_si128(sw, two))));
+            }
+
+            __m128i v = h ? _mm_unpackhi_epi8(a, zero) : _mm_unpacklo_epi8(a, zero);
+            __m128i *i16 = (__m128i *)(ls->I + j + 8 * h);
+            if (op == LANE_LD_I) sse2_store(i16, nnn);
+            if (op == LANE_ADD_I) sse2_store(i16, _mm_add_epi16(sse2_load(i16), v));
+            if (op == LANE_LD_F) sse2_store(i16, _mm_add_epi16(_mm_slli_epi16(v, 2), v));
+        }
+    }
+}
+
+#endif
+
+#ifdef HAVE_LANE_AVX2
+
+#define AVX2 __attribute__((target("avx2")))
+
+AVX2 static inline __m256i avx2_load(const void *p) {
+    return _mm256_loadu_si256((const __m256i *)p);
+}
+
+AVX2 static inline void avx2_store(void *p, __m256i v) {
+    _mm256_storeu_si256((__m256i *)p, v);
+}
+
+AVX2 static inline __m256i avx2_gt_u8(__m256i a, __m256i b) {
+    return _mm256_andnot_si256(_mm256_cmpeq_epi8(a, b), _mm256_cmpeq_epi8(_mm256_max_epu8(a, b), a));
+}
+
+// Byte mask of lanes 16 * h .. 16 * h + 15 of a block, sign-extended to 16 bits
+AVX2 static inline __m256i avx2_widen(__m256i mask, int h) {
+    return _mm256_cvtepi8_epi16(h ? _mm256_extracti128_si256(mask, 1) : _mm256_castsi256_si128(mask));
+}
+
+AVX2 static void step_avx2(Lockstep *ls, LaneOp op, uint16_t opcode) {
+    uint8_t *vx = ls->V[OPCODE_X(opcode)];
+    uint8_t *vy = ls->V[OPCODE_Y(opcode)];
+    uint8_t *vf = ls->V[0xF];
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi8(-1);
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i low7 = _mm256_set1_epi8(0x7F);
+    const __m256i kk = _mm256_set1_epi8((char)OPCODE_KK(opcode));
+    const __m256i nnn = _mm256_set1_epi16((short)OPCODE_NNN(opcode));
+    const __m256i two = _mm256_set1_epi16(2);
+
+    for (uint32_t j = 0; j < ls->stride; j += 32) {
+        __m256i a = avx2_load(vx + j);
+        __m256i b = avx2_load(vy + j);
+        __m256i skip = zero;
+
+        switch (op) {
+            case LANE_SE_BYTE:  skip = _mm256_cmpeq_epi8(a, kk); break;
+            case LANE_SNE_BYTE: skip = _mm256_andnot_si256(_mm256_cmpeq_epi8(a, kk), ones); break;
+            case LANE_SE_REG:   skip = _mm256_cmpeq_epi8(a, b); break;
+            case LANE_SNE_REG:  skip = _mm256_andnot_si256(_mm256_cmpeq_epi8(a, b), ones); break;
+            case LANE_LD_BYTE:  avx2_store(vx + j, kk); break;
+            case LANE_ADD_BYTE: avx2_store(vx + j, _mm256_add_epi8(a, kk)); break;
+            case LANE_LD:       avx2_store(vx + j, b); break;
+            case LANE_OR:       avx2_store(vx + j, _mm256_or_si256(a, b)); break;
+            case LANE_AND:      avx2_store(vx + j, _mm256_and_si256(a, b)); break;
+            case LANE_XOR:      avx2_store(vx + j, _mm256_xor_si256(a, b)); break;
+            case LANE_ADD: {
+                __m256i sum = _mm256_add_epi8(a, b);
+                avx2_store(vf + j, _mm256_and_si256(avx2_gt_u8(a, sum), one));
+                avx2_store(vx + j, sum);
+                break;
+            }
+            case LANE_SUB:
+                avx2_store(vf + j, _mm256_and_si256(avx2_gt_u8(a, b), one));
+                a = avx2_load(vx + j);
+                b = avx2_load(vy + j);
+                avx2_store(vx + j, _mm256_sub_epi8(a, b));
+                break;
+            case LANE_SHR:
+                avx2_store(vf + j, _mm256_and_si256(a, one));
+                a = avx2_load(vx + j);
+                avx2_store(vx + j, _mm256_and_si256(_mm256_srli_epi16(a, 1), low7));
+                break;
+            case LANE_SUBN:
+                avx2_store(vf + j, _mm256_and_si256(avx2_gt_u8(b, a), one));
+                a = avx2_load(vx + j);
+                b = avx2_load(vy + j);
+                avx2_store(vx + j, _mm256_sub_epi8(b, a));
+                break;
+            case LANE_SHL:
+                avx2_store(vf + j, _mm256_and_si256(_mm256_srli_epi16(a, 7), one));
+                a = avx2_load(vx + j);
+                avx2_store(vx + j, _mm256_add_epi8(a, a));
+                break;
+            default:
+                break;
+        }
+
+        // PC and I are 16-bit: each half of the block widens the skip mask
+        for (int h = 0; h < 2; h++) {
+            uint16_t *pc = ls->pc + j + 16 * h;
+
+            if (op == LANE_JP) {
+                avx2_store(pc, nnn);
+            } else {
+                __m256i advance = _mm256_add_epi16(two, _mm256_and_si256(avx2_widen(skip, h), two));
+                avx2_store(pc, _mm256_add_epi16(avx2_load(pc), advance));
+            }
+
+            __m256i v = _mm256_cvtepu8_epi16(h ? _mm256_extracti128_si256(a, 1) : _mm256_castsi256_si128(a));
+            __m256i *i16 = (__m256i *)(ls->I + j + 16 * h);
+            if (op == LANE_LD_I) avx2_store(i16, nnn);
+            if (op == LANE_ADD_I) avx2_store(i16, _mm256_add_epi16(avx2_load(i16), v));
+            if (op == LANE_LD_F) avx2_store(i16, _mm256_add_epi16(_mm256_slli_epi16(v, 2), v));
+        }
+    }
+}
+
+#endif
+
+/**
+ * Marks memory[addr .. addr + len - 1] as possibly different between lanes.
+ */
+static void mark_dirty(Lockstep *ls, uint32_t addr, uint32_t len) {
+    uint32_t end = addr + len;
+    if (end > MEMORY_SIZE) end = MEMORY_SIZE;
+    if (addr < end) memset(&ls->dirty[addr], 1, end - addr);
+}
+
+/**
+ * Checks whether every lane holds the same two bytes at a dirty `pc`. If
+ * so, they become part of the shared image again.
+ *
+ * @return true if the opcode at `pc` can be fetched from `ls->code`.
+ */
+static bool reshare(Lockstep *ls, uint16_t pc) {
+    const uint8_t hi = ls->vm[0].memory[pc];
+    const uint8_t lo = ls->vm[0].memory[pc + 1];
+
+    for (uint32_t i = 1; i < ls->lanes; i++) {
+        if (ls->vm[i].memory[pc] != hi || ls->vm[i].memory[pc + 1] != lo) return false;
+    }
+
+    ls->code[pc] = hi;
+    ls->code[pc + 1] = lo;
+    ls->dirty[pc] = ls->dirty[pc + 1] = 0;
+
+    // Opcodes overlapping the two bytes are classified again
+    if (pc > 0) ls->kernel[pc - 1] = LANE_UNCLASSIFIED;
+    ls->kernel[pc] = ls->kernel[pc + 1] = LANE_UNCLASSIFIED;
+    return true;
+}
+
+/**
+ * Resolves an opcode's handler, the registers it can access (V0 for Bnnn,
+ * Vx, Vy, VF for flags and Dxyn, or V0..Vx for the block transfers
+ * Fx55/Fx65) and the memory it writes.
+ */
+static void prepare_call(HandlerCall *call, uint16_t opcode) {
+    call->handler = dispatch_resolve(opcode);
+    call->opcode = opcode;
+    call->x = OPCODE_X(opcode);
+    call->y = OPCODE_Y(opcode);
+    call->block = 0;
+    call->stores = 0;
+
+    switch (opcode & 0xF0FF) {
+        case 0xF033: call->stores = 3; break;
+        case 0xF055: call->block = call->stores = call->x + 1; break;
+        case 0xF065: call->block = call->x + 1; break;
+        default: break;
+    }
+}
+
+/**
+ * Executes one instruction of one lane through its leaf handler, as
+ * `chip8_cycle` would: PC is advanced first, and the handler sees the
+ * lane's clock (its clock at the start of the run plus the steps
+ * completed).
+ */
+static void run_handler(Lockstep *ls, const HandlerCall *call, uint32_t lane, uint32_t step) {
+    Chip8 *vm = &ls->vm[lane];
+
+    if (call->block) {
+        for (uint8_t r = 0; r < call->block; r++) vm->V[r] = ls->V[r][lane];
+    } else {
+        vm->V[0x0] = ls->V[0x0][lane];
+        vm->V[call->x] = ls->V[call->x][lane];
+        vm->V[call->y] = ls->V[call->y][lane];
+        vm->V[0xF] = ls->V[0xF][lane];
+    }
+    vm->I = ls->I[lane];
+    vm->pc = ls->pc[lane] + 2;
+    vm->cycles = ls->cycles[lane] + step;
+
+    // The only instructions that write memory; later fetches there are compared per lane
+    if (call->stores) mark_dirty(ls, vm->I, call->stores);
+
+    call->handler(vm, call->opcode);
+
+    if (call->block) {
+        for (uint8_t r = 0; r < call->block; r++) ls->V[r][lane] = vm->V[r];
+    } else {
+        ls->V[0x0][lane] = vm->V[0x0];
+        ls->V[call->x][lane] = vm->V[call->x];
+        ls->V[call->y][lane] = vm->V[call->y];
+        ls->V[0xF][lane] = vm->V[0xF];
+    }
+    ls->I[lane] = vm->I;
+    ls->pc[lane] = vm->pc;
+}
+
+/**
+ * Executes the instruction at the group's PC on each of its lanes.
+ *
+ * @param ls    Lockstep state.
+ * @param group The group; `branched` is set if its lanes may part.
+ * @param step  Steps completed in this lockstep_run call.
+ * @param all   The group holds every lane, so the vector kernels can run.
+ */
+static void run_group(Lockstep *ls, LockstepGroup *group, uint32_t step, bool all) {
+    const uint16_t pc = group->pc;
+    const uint32_t *lanes = ls->members + group->start;
+    const uint32_t count = group->count;
+    HandlerCall call;
+
+    // Lanes with different code here each run their own opcode
+    if ((ls->dirty[pc] || ls->dirty[pc + 1]) && !reshare(ls, pc)) {
+        for (uint32_t k = 0; k < count; k++) {
+            prepare_call(&call, fetch(ls->vm[lanes[k]].memory, pc));
+            run_handler(ls, &call, lanes[k], step);
+        }
+        ls->handler_ops += count;
+        group->branched = true;
+        return;
+    }
+
+    uint16_t opcode = fetch(ls->code, pc);
+    LaneOp op = (LaneOp)ls->kernel[pc];
+    if (op == LANE_UNCLASSIFIED) {
+        op = classify(opcode);
+        ls->kernel[pc] = (uint8_t)op;
+    }
+
+    group->branched = op == LANE_HANDLER || op == LANE_SE_BYTE || op == LANE_SNE_BYTE ||
+                      op == LANE_SE_REG || op == LANE_SNE_REG || op == LANE_SKP || op == LANE_SKNP ||
+                      op == LANE_CALL || op == LANE_RET;
+
+    if (op == LANE_HANDLER) {
+        prepare_call(&call, opcode);
+        for (uint32_t k = 0; k < count; k++) run_handler(ls, &call, lanes[k], step);
+        ls->handler_ops += count;
+        return;
+    }
+
+#ifdef HAVE_LANE_AVX2
+    if (all && op < LANE_SKP && ls->isa == LOCKSTEP_AVX2) {
+        step_avx2(ls, op, opcode);
+        ls->simd_ops += count;
+        return;
+    }
+#endif
+#ifdef HAVE_LANE_SSE2
+    if (all && op < LANE_SKP && ls->isa == LOCKSTEP_SSE2) {
+        step_sse2(ls, op, opcode);
+        ls->simd_ops += count;
+        return;
+    }
+#endif
+
+    step_list(ls, op, opcode, lanes, count, step);
+    ls->list_ops += count;
+}
+
+/**
+ * Moves the lanes of a group that are not at the PC of its first lane into
+ * new groups at the end of `ls->groups`, until every group holds one PC.
+ * Lanes keep their order.
+ */
+static void split_group(Lockstep *ls, uint32_t g) {
+    while (g < ls->group_count) {
+        LockstepGroup *group = &ls->groups[g];
+        uint32_t *lanes = ls->members + group->start;
+        uint16_t pc = ls->pc[lanes[0]];
+        uint32_t same = 0;
+        uint32_t other = 0;
+
+        for (uint32_t k = 0; k < group->count; k++) {
+            if (ls->pc[lanes[k]] == pc) {
+                lanes[same++] = lanes[k];
+            } else {
+                ls->spare_members[other++] = lanes[k];
+            }
+        }
+        group->pc = pc;
+        if (!other) return;
+
+        memcpy(lanes + same, ls->spare_members, other * sizeof(uint32_t));
+        group->count = same;
+        ls->groups[ls->group_count] = (LockstepGroup){
+            .pc = ls->pc[lanes[same]], .start = group->start + same, .count = other
+        };
+        g = ls->group_count++;
+    }
+}
+
+/**
+ * Merges the groups at the same PC.
+ *
+ * A counting sort over groups rather than lanes: one pass sums the lanes
+ * per PC (a stamp in `ls->seen` marks the PCs already met), the second
+ * copies each group's lanes into the range of its merged group. The merged
+ * groups are written to the spare buffers, which then swap in.
+ */
+static void regroup(Lockstep *ls) {
+    uint32_t epoch = ++ls->epoch;
+    if (epoch == 0) {
+        memset(ls->seen, 0, MEMORY_SIZE * sizeof(uint32_t));
+        epoch = ls->epoch = 1;
+    }
+
+    uint32_t merged = 0;
+    for (uint32_t g = 0; g < ls->group_count; g++) {
+        uint16_t pc = ls->groups[g].pc;
+        if (ls->seen[pc] != epoch) {
+            ls->seen[pc] = epoch;
+            ls->group_of[pc] = merged;
+            ls->spare_groups[merged++] = (LockstepGroup){ .pc = pc };
+        }
+        ls->spare_groups[ls->group_of[pc]].count += ls->groups[g].count;
+    }
+    if (merged == ls->group_count) return;
+
+    uint32_t start = 0;
+    for (uint32_t g = 0; g < merged; g++) {
+        ls->spare_groups[g].start = start;
+        start += ls->spare_groups[g].count;
+        ls->spare_groups[g].count = 0;
+    }
+
+    for (uint32_t g = 0; g < ls->group_count; g++) {
+        const LockstepGroup *group = &ls->groups[g];
+        LockstepGroup *into = &ls->spare_groups[ls->group_of[group->pc]];
+        memcpy(ls->spare_members + into->start + into->count, ls->members + group->start,
+               group->count * sizeof(uint32_t));
+        into->count += group->count;
+    }
+
+    uint32_t *members = ls->members;
+    LockstepGroup *groups = ls->groups;
+    ls->members = ls->spare_members;
+    ls->groups = ls->spare_groups;
+    ls->spare_members = members;
+    ls->spare_groups = groups;
+    ls->group_count = merged;
+}
+
+/**
+ * Regroups the lanes after a step: groups that branched are split by PC,
+ * groups whose PC left memory halt, and groups that met at a PC merge.
+ *
+ * @param ls   Lockstep state.
+ * @param step The step just executed.
+ */
+static void update_groups(Lockstep *ls, uint32_t step) {
+    const uint32_t executed = ls->group_count;
+    for (uint32_t g = 0; g < executed; g++) {
+        if (ls->groups[g].branched) split_group(ls, g);
+    }
+
+    uint32_t kept = 0;
+    for (uint32_t g = 0; g < ls->group_count; g++) {
+        LockstepGroup group = ls->groups[g];
+        group.pc = ls->pc[ls->members[group.start]];
+        group.branched = false;
+
+        if (group.pc >= MEMORY_SIZE - 1) {
+            for (uint32_t k = 0; k < group.count; k++) ls->halted_at[ls->members[group.start + k]] = step + 1;
+            ls->live -= group.count;
+            continue;
+        }
+        ls->groups[kept++] = group;
+    }
+    ls->group_count = kept;
+
+    regroup(ls);
+}
+
+#ifdef HAVE_LANE_SSE2
+
+/**
+ * Transposes a 16 x 16 byte matrix held as 16 rows: four rounds of
+ * interleaving row k with row k + 8.
+ */
+static inline void sse2_transpose(__m128i rows[16]) {
+    for (int round = 0; round < 4; round++) {
+        __m128i t[16];
+        for (int k = 0; k < 8; k++) {
+            t[2 * k] = _mm_unpacklo_epi8(rows[k], rows[k + 8]);
+            t[2 * k + 1] = _mm_unpackhi_epi8(rows[k], rows[k + 8]);
+        }
+        memcpy(rows, t, sizeof(t));
+    }
+}
+
+#endif
+
+/**
+ * Copies the V registers of lanes [first, lanes) between their Chip8s and
+ * the lane arrays, one lane at a time.
+ */
+static void copy_registers(Lockstep *ls, uint32_t first, bool to_lanes) {
+    for (uint32_t i = first; i < ls->lanes; i++) {
+        for (int r = 0; r < REGISTER_COUNT; r++) {
+            if (to_lanes) {
+                ls->V[r][i] = ls->vm[i].V[r];
+            } else {
+                ls->vm[i].V[r] = ls->V[r][i];
+            }
+        }
+    }
+}
+
+/**
+ * Copies every lane's registers and clock from its Chip8 into the lane
+ * arrays, and groups the live lanes by PC.
+ */
+static void gather(Lockstep *ls) {
+    uint32_t first = 0;
+
+#ifdef HAVE_LANE_SSE2
+    // V of 16 lanes is a 16 x 16 byte matrix: transposed, its rows are V[r]
+    for (; first + 16 <= ls->lanes; first += 16) {
+        __m128i rows[16];
+        for (int k = 0; k < 16; k++) rows[k] = sse2_load(ls->vm[first + k].V);
+        sse2_transpose(rows);
+        for (int r = 0; r < REGISTER_COUNT; r++) sse2_store(ls->V[r] + first, rows[r]);
+    }
+#endif
+    copy_registers(ls, first, true);
+
+    // Neighbouring lanes at one PC start out as one group
+    ls->live = 0;
+    ls->group_count = 0;
+    for (uint32_t i = 0; i < ls->lanes; i++) {
+        const Chip8 *vm = &ls->vm[i];
+        ls->I[i] = vm->I;
+        ls->pc[i] = vm->pc;
+        ls->cycles[i] = vm->cycles;
+
+        if (vm->pc >= MEMORY_SIZE - 1) {
+            ls->halted_at[i] = 0;
+            continue;
+        }
+
+        ls->halted_at[i] = UINT32_MAX;
+        if (ls->group_count && ls->groups[ls->group_count - 1].pc == vm->pc) {
+            ls->groups[ls->group_count - 1].count++;
+        } else {
+            ls->groups[ls->group_count++] = (LockstepGroup){ .pc = vm->pc, .start = ls->live, .count = 1 };
+        }
+        ls->members[ls->live++] = i;
+    }
+    regroup(ls);
+}
+
+/**
+ * Copies the lane arrays back into every lane's Chip8. Each lane executed
+ * one instruction per step until it halted.
+ */
+static void scatter(Lockstep *ls, uint32_t steps) {
+    uint32_t first = 0;
+
+#ifdef HAVE_LANE_SSE2
+    for (; first + 16 <= ls->lanes; first += 16) {
+        __m128i rows[16];
+        for (int r = 0; r < REGISTER_COUNT; r++) rows[r] = sse2_load(ls->V[r] + first);
+        sse2_transpose(rows);
+        for (int k = 0; k < 16; k++) sse2_store(ls->vm[first + k].V, rows[k]);
+    }
+#endif
+    copy_registers(ls, first, false);
+
+    for (uint32_t i = 0; i < ls->lanes; i++) {
+        Chip8 *vm = &ls->vm[i];
+        vm->I = ls->I[i];
+        vm->pc = ls->pc[i];
+        vm->cycles = ls->cycles[i] + (ls->halted_at[i] < steps ? ls->halted_at[i] : steps);
+    }
+}
+
+/**
+ * Executes the lanes listed in `ls->spare_members` from `step` to the end
+ * of the run, one lane after the other, so each lane's Chip8 stays in
+ * cache for the whole of its run.
+ *
+ * With `stores`, lanes go through `chip8_cycle` and their Fx33/Fx55 stores
+ * are marked dirty as `run_handler` does. Runs that never group lanes have
+ * no shared image to protect, so their lanes go through `chip8_execute`.
+ *
+ * @return Steps of the lane that ran longest.
+ */
+static uint32_t run_lanes(Lockstep *ls, uint32_t live, uint32_t step, uint32_t cycles, bool stores) {
+    uint32_t longest = step;
+
+    for (uint32_t k = 0; k < live; k++) {
+        Chip8 *vm = &ls->vm[ls->spare_members[k]];
+        uint32_t s = step;
+
+        if (!stores) {
+            s += chip8_execute(vm, cycles - step);
+        }
+        for (; stores && s < cycles && vm->pc < MEMORY_SIZE - 1; s++) {
+            const uint8_t *op = &vm->memory[vm->pc];
+            if ((op[1] == 0x33 || op[1] == 0x55) && (op[0] & 0xF0) == 0xF0) {
+                mark_dirty(ls, vm->I, op[1] == 0x33 ? 3u : (op[0] & 0x0Fu) + 1);
+            }
+            chip8_cycle(vm);
+        }
+        ls->cycle_ops += s - step;
+        if (s > longest) longest = s;
+    }
+    return longest;
+}
+
+/**
+ * Whether every lane is at the same PC, so the lanes most likely run the
+ * same code for the whole run.
+ */
+static bool together(const Lockstep *ls) {
+    for (uint32_t i = 1; i < ls->lanes; i++) {
+        if (ls->vm[i].pc != ls->vm[0].pc) return false;
+    }
+    return true;
+}
+
+/**
+ * Executes every lane through `chip8_cycle`, one step across all lanes at
+ * a time. Lanes that run the same code make each dispatch repeat the one
+ * before, which the host CPU predicts; apart, lanes go through `run_lanes`.
+ *
+ * @return Steps of the lane that ran longest.
+ */
+static uint32_t interleave_lanes(Lockstep *ls, uint32_t cycles) {
+    uint32_t longest = 0;
+
+    for (uint32_t i = 0; i < ls->lanes; i++) ls->cycles[i] = ls->vm[i].cycles;
+    Chip8 *vm = ls->vm;
+    const uint32_t lanes = ls->lanes;
+    for (uint32_t step = 0; step < cycles; step++) {
+        for (uint32_t i = 0; i < lanes; i++) chip8_cycle(&vm[i]);
+    }
+
+    // A lane's clock stops when its PC leaves memory
+    for (uint32_t i = 0; i < ls->lanes; i++) {
+        uint32_t ran = (uint32_t)(ls->vm[i].cycles - ls->cycles[i]);
+        ls->cycle_ops += ran;
+        if (ran > longest) longest = ran;
+    }
+    return longest;
+}
+
+/**
+ * Ends a run whose lanes diverged too far to group: after the scatter, the
+ * live lanes execute the rest of the run one after the other (`run_lanes`).
+ *
+ * @return Steps of the lane that ran longest.
+ */
+static uint32_t finish_lanes(Lockstep *ls, uint32_t steps, uint32_t cycles) {
+    uint32_t live = 0;
+
+    // Before the first step the Chip8s are up to date already
+    if (steps) scatter(ls, steps);
+
+    for (uint32_t g = 0; g < ls->group_count; g++) {
+        const LockstepGroup *group = &ls->groups[g];
+        memcpy(ls->spare_members + live, ls->members + group->start, group->count * sizeof(uint32_t));
+        live += group->count;
+    }
+    return run_lanes(ls, live, steps, cycles, true);
+}
+
+/**
+ * Allocates `lanes` VMs and the lane arrays.
+ *
+ * Every VM is set up with `chip8_init` (headless, default configuration).
+ * Padding lanes up to `stride` never execute.
+ *
+ * @param ls    Lockstep state to initialize.
+ * @param lanes Number of VMs (at least 1).
+ * @return      false if out of memory (nothing is left allocated).
+ */
+bool lockstep_init(Lockstep *ls, uint32_t lanes) {
+    if (!ls || lanes == 0) {
+        fprintf(stderr, "lockstep_init called with null pointer or no lanes\n");
+        return false;
+    }
+
+    memset(ls, 0, sizeof(Lockstep));
+    ls->lanes = lanes;
+    ls->stride = (lanes + LOCKSTEP_BLOCK - 1) / LOCKSTEP_BLOCK * LOCKSTEP_BLOCK;
+
+    bool ok = (ls->vm = malloc(lanes * sizeof(Chip8))) != NULL;
+    for (int r = 0; r < REGISTER_COUNT; r++) {
+        ok = ok && (ls->V[r] = calloc(ls->stride, 1)) != NULL;
+    }
+    ok = ok && (ls->I = calloc(ls->stride, sizeof(uint16_t))) != NULL;
+    ok = ok && (ls->pc = calloc(ls->stride, sizeof(uint16_t))) != NULL;
+    ok = ok && (ls->cycles = calloc(ls->stride, sizeof(uint64_t))) != NULL;
+    ok = ok && (ls->halted_at = calloc(ls->stride, sizeof(uint32_t))) != NULL;
+    ok = ok && (ls->members = calloc(lanes, sizeof(uint32_t))) != NULL;
+    ok = ok && (ls->groups = calloc(lanes, sizeof(LockstepGroup))) != NULL;
+    ok = ok && (ls->spare_members = calloc(lanes, sizeof(uint32_t))) != NULL;
+    ok = ok && (ls->spare_groups = calloc(lanes, sizeof(LockstepGroup))) != NULL;
+    ok = ok && (ls->group_of = calloc(MEMORY_SIZE, sizeof(uint32_t))) != NULL;
+    ok = ok && (ls->seen = calloc(MEMORY_SIZE, sizeof(uint32_t))) != NULL;
+
+    if (!ok) {
+        fprintf(stderr, "[LOCKSTEP] Out of memory for %u lanes\n", lanes);
+        lockstep_free(ls);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < lanes; i++) chip8_init(&ls->vm[i]);
+    memcpy(ls->image, ls->vm[0].memory, MEMORY_SIZE);
+    memcpy(ls->code, ls->vm[0].memory, MEMORY_SIZE);
+
+#ifdef HAVE_LANE_SSE2
+    ls->isa = LOCKSTEP_SSE2;
+#endif
+#ifdef HAVE_LANE_AVX2
+    if (__builtin_cpu_supports("avx2")) ls->isa = LOCKSTEP_AVX2;
+#endif
+    return true;
+}
+
+/**
+ * Frees the VMs and lane arrays of a lockstep state.
+ *
+ * @param ls Lockstep state (may be partially initialized).
+ */
+void lockstep_free(Lockstep *ls) {
+    if (!ls) return;
+
+    free(ls->vm);
+    for (int r = 0; r < REGISTER_COUNT; r++) free(ls->V[r]);
+    free(ls->I);
+    free(ls->pc);
+    free(ls->cycles);
+    free(ls->halted_at);
+    free(ls->members);
+    free(ls->groups);
+    free(ls->spare_members);
+    free(ls->spare_groups);
+    free(ls->group_of);
+    free(ls->seen);
+    memset(ls, 0, sizeof(Lockstep));
+}
+
+/**
+ * Resets every lane to power-on state and loads a ROM into all of them.
+ *
+ * The ROM is read once (into lane 0) and its memory image becomes the
+ * shared program every lane starts from.
+ *
+ * @param ls       Lockstep state.
+ * @param filename Path to the ROM file.
+ * @return         0 on success, -1 on failure.
+ */
+int lockstep_load_rom(Lockstep *ls, const char *filename) {
+    if (!ls || !ls->vm || !filename) {
+        fprintf(stderr, "lockstep_load_rom called with null pointer\n");
+        return -1;
+    }
+
+    chip8_reset(&ls->vm[0]);
+    if (chip8_load_rom(&ls->vm[0], filename)) return -1;
+
+    memcpy(ls->image, ls->vm[0].memory, MEMORY_SIZE);
+    memcpy(ls->code, ls->vm[0].memory, MEMORY_SIZE);
+    memset(ls->dirty, 0, MEMORY_SIZE);
+    memset(ls->kernel, LANE_UNCLASSIFIED, MEMORY_SIZE);
+
+    for (uint32_t i = 1; i < ls->lanes; i++) lockstep_reset_lane(ls, i);
+    return 0;
+}
+
+/**
+ * Power-on reset of one lane, with the loaded ROM back in its memory.
+ *
+ * Configuration kept by `chip8_reset` (platform, flags) is left alone.
+ * Where the other lanes rewrote their code since the ROM was loaded, the
+ * shared image no longer matches this lane, so those bytes become dirty.
+ *
+ * @param ls   Lockstep state.
+ * @param lane Lane index.
+ */
+void lockstep_reset_lane(Lockstep *ls, uint32_t lane) {
+    if (!ls || !ls->vm || lane >= ls->lanes) {
+        fprintf(stderr, "lockstep_reset_lane called with null pointer or bad lane\n");
+        return;
+    }
+
+    Chip8 *vm = &ls->vm[lane];
+    chip8_reset(vm);
+    memcpy(vm->memory, ls->image, MEMORY_SIZE);
+    dispatch_invalidate_all(vm);
+
+    if (memcmp(ls->code, ls->image, MEMORY_SIZE) != 0) {
+        for (uint32_t addr = 0; addr < MEMORY_SIZE; addr++) {
+            if (ls->code[addr] != ls->image[addr]) ls->dirty[addr] = 1;
+        }
+    }
+}
+
+/**
+ * Records that the host changed memory[addr .. addr + len - 1] of one or
+ * more lanes outside `lockstep_run`, so opcodes fetched there are compared
+ * between the lanes before the shared image is used again.
+ *
+ * @param ls   Lockstep state.
+ * @param addr First byte written.
+ * @param len  Number of bytes written.
+ */
+void lockstep_invalidate(Lockstep *ls, uint16_t addr, uint16_t len) {
+    if (!ls) {
+        fprintf(stderr, "lockstep_invalidate called with null pointer\n");
+        return;
+    }
+    mark_dirty(ls, addr, len);
+}
+
+/**
+ * Executes `cycles` instructions on every lane.
+ *
+ * Each lane ends in the state `cycles` calls of `chip8_cycle` would leave
+ * it in: no timer, input or display work is done (the host handles those
+ * per frame, as around `chip8_cycle`). Lanes whose PC left memory stay
+ * halted. Cxkk draws from each lane's own generator, so the order in which
+ * lanes run within a step does not matter.
+ *
+ * Registers live in the lane arrays during the call and are written back
+ * to each lane's Chip8 before it returns.
+ *
+ * @param ls     Lockstep state.
+ * @param cycles Instructions per lane.
+ * @return       Steps executed (less than `cycles` if every lane halted).
+ */
+uint32_t lockstep_run(Lockstep *ls, uint32_t cycles) {
+    if (!ls || !ls->vm) {
+        fprintf(stderr, "lockstep_run called with null pointer\n");
+        return 0;
+    }
+
+    uint32_t steps = 0;
+
+    // Too few lanes to ever fill a group
+    if (ls->lanes < MIN_GROUP_LANES) {
+        for (uint32_t i = 0; i < ls->lanes; i++) ls->spare_members[i] = i;
+        if (together(ls)) return interleave_lanes(ls, cycles);
+        return run_lanes(ls, ls->lanes, 0, cycles, false);
+    }
+
+    gather(ls);
+
+    for (; steps < cycles && ls->live > 0; steps++) {
+        if (ls->group_count * MIN_GROUP_LANES > ls->live) return finish_lanes(ls, steps, cycles);
+
+        bool all = ls->group_count == 1 && ls->live == ls->lanes;
+        for (uint32_t g = 0; g < ls->group_count; g++) run_group(ls, &ls->groups[g], steps, all);
+
+        update_groups(ls, steps);
+    }
+
+    scatter(ls, steps);
+    return steps;
+}
@@ -4,11 +4,16 @@
  * Entry point for the CHIP-8 emulator.
  * Supports both interactive and test-mode execution.
  *
- * In interactive mode, a ROM is executed in a 60 FPS loop using SDL2.
- * In test mode, the emulator runs a limited number of cycles and exits after a RET instruction.
+ * In interactive mode, a ROM is executed in a 60 FPS loop using SDL2; frames are presented
+ * by a separate render thread, so vsync never stalls emulation.
+ * In test mode, the emulator runs headless for a limited number of cycles and exits after a RET instruction.
+ * With --jit, hot code runs through the x86-64 JIT backend instead of the interpreter.
+ * With --no-skip-idle, timer-wait loops are executed pass by pass instead of fast-forwarded.
+ * With --palette, the window draws unlit and lit pixels in the given colors (hex RRGGBB).
+ * With --seed, Cxkk draws from a generator seeded with N (default 1); --libc-rand uses rand() instead.
  *
  * Usage:
- *     chip8 <ROM file> [--test]
+ *     chip8 <ROM file> [--test] [--jit] [--no-skip-idle] [--palette BG,FG] [--seed N] [--libc-rand]
  */
 
 #include <stdlib.h>
@@ -21,12 +26,11 @@
 #include <SDL_timer.h>
 
 #include "chip8.h"
+#include "jit.h"
 #include "utils.h"
 #include "platform.h"
 #include "display.h"
-
-// Global CHIP-8 VM instance
-Chip8 chip8;
+#include "rng.h"
 
 // Signal-safe flag to support graceful shutdown on SIGINT
 volatile sig_atomic_t quit_requested = 0;
@@ -54,23 +58,77 @@ int SDL_main(int argc, char *argv[])
 #endif
 {
     bool test_mode = false;
+    bool use_jit = false;
+    bool skip_idle = true;
+    bool libc_rand = false;
+    uint64_t seed = RNG_DEFAULT_SEED;
+    const char *palette = NULL;
+    uint32_t background = 0, foreground = 0;
+
+    // The VM and the host backend it draws to; test mode leaves the backend empty (headless)
+    Chip8 chip8;
+    Platform platform = {0};
 
     // Parse command-line arguments
-    if (argc == 3 && strcmp(argv[2], "--test") == 0) {
-        test_mode = true;
-    } else if (argc != 2) {
-        fprintf(stderr, "Usage: %s <ROM file> [--test]\n", argv[0]);
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <ROM file> [--test] [--jit] [--no-skip-idle] [--palette BG,FG] [--seed N] [--libc-rand]\n", argv[0]);
         return EXIT_FAILURE;
     }
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--test") == 0) {
+            test_mode = true;
+        } else if (strcmp(argv[i], "--jit") == 0) {
+            use_jit = true;
+        } else if (strcmp(argv[i], "--no-skip-idle") == 0) {
+            skip_idle = false;
+        } else if (strcmp(argv[i], "--palette") == 0 && i + 1 < argc) {
+            palette = argv[++i];
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--libc-rand") == 0) {
+            libc_rand = true;
+        } else {
+            fprintf(stderr, "Usage: %s <ROM file> [--test] [--jit] [--no-skip-idle] [--palette BG,FG] [--seed N] [--libc-rand]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Palette: two hex colors, e.g. 000000,FFFFFF (white on black)
+    if (palette) {
+        char *end;
+        background = (uint32_t)strtoul(palette, &end, 16);
+        bool valid = end != palette && *end == ',';
+
+        if (valid) {
+            const char *fg = end + 1;
+            foreground = (uint32_t)strtoul(fg, &end, 16);
+            valid = end != fg && *end == '\0';
+        }
+        if (!valid || background > 0xFFFFFF || foreground > 0xFFFFFF) {
+            fprintf(stderr, "Invalid palette: %s (expected BG,FG as hex RRGGBB)\n", palette);
+            return EXIT_FAILURE;
+        }
+    }
 
     // Initialize emulator state
     chip8_init(&chip8);
 
+    // Open the window and audio for interactive runs
+    if (!test_mode) {
+        if (!platform_sdl_init(&platform)) return EXIT_FAILURE;
+        if (palette) platform_sdl_set_palette(&platform, background, foreground);
+        chip8.platform = &platform;
+    }
+
     // Enable test mode (used to trigger test_halt() on RET)
     if (test_mode) {
         chip8.test_mode = true;
     }
 
+    chip8.skip_idle = skip_idle;
+    chip8.libc_rand = libc_rand;
+    chip8_seed(&chip8, seed);
+
     // Store ROM path (used for dumping results in test mode)
     strncpy(chip8.rom_path, argv[1], sizeof(chip8.rom_path) - 1);
     chip8.rom_path[sizeof(chip8.rom_path) - 1] = '\0';
@@ -78,12 +136,19 @@ int SDL_main(int argc, char *argv[])
     // Load the ROM into memory starting at 0x200
     if (chip8_load_rom(&chip8, argv[1])) {
         fprintf(stderr, "Failed to load ROM: %s\n", argv[1]);
+        platform_quit(&platform);
         return EXIT_FAILURE;
     }
 
+    // Optional JIT backend; test mode compiles on first visit so fixtures exercise native code
+    if (use_jit) {
+        jit_enable(&chip8, test_mode ? 1 : JIT_HOT_THRESHOLD);
+    }
+
     // Register signal handler for graceful termination
     if (signal(SIGINT, handle_signal) == SIG_ERR) {
         fprintf(stderr, "Failed to register SIGINT handler\n");
+        platform_quit(&platform);
         return EXIT_FAILURE;
     }
 
@@ -95,16 +160,17 @@ int SDL_main(int argc, char *argv[])
      * which writes a binary dump and exits. This path is used for automated testing.
      */
     if (test_mode) {
-        const int CYCLES_PER_FRAME = 10;
+        const int TEST_CYCLES_PER_FRAME = 10;
         const int FRAME_DELAY_MS = 1000 / 60;
         const int TEST_FRAMES = 10;
 
+        // Timers tick exactly once per test frame
+        chip8.cpu_hz = TEST_CYCLES_PER_FRAME * TIMER_FREQUENCY;
+
         for (int frame = 0; frame < TEST_FRAMES && !quit_requested; frame++) {
             clock_t start = clock();
 
-            for (int i = 0; i < CYCLES_PER_FRAME; i++) {
-                chip8_cycle(&chip8);
-            }
+            chip8_run(&chip8, TEST_CYCLES_PER_FRAME);
 
             clock_t end = clock();
             int elapsed_ms = (int)((end - start) * 1000 / CLOCKS_PER_SEC);
@@ -120,7 +186,7 @@ int SDL_main(int argc, char *argv[])
         }
 
         // Clean shutdown after test run
-        display_quit();
+        platform_quit(&platform);
         return EXIT_SUCCESS;
     }
 
@@ -130,14 +196,18 @@ int SDL_main(int argc, char *argv[])
      * INTERACTIVE MODE EXECUTION
      * ------------------------
      * Main event loop that runs continuously, cycling the VM and updating display.
-     * Timed to simulate ~700 instructions per second.
+     * Each 60Hz frame runs up to the next timer tick at chip8.cpu_hz (700 instructions per second).
+     * While the ROM waits for a key (Fx0A), the loop sleeps until input arrives.
      */
-    const int CYCLES_PER_SECOND = 700;
-    const int FRAME_RATE = 60;
-    const int CYCLES_PER_FRAME = CYCLES_PER_SECOND / FRAME_RATE;
+    const int FRAME_RATE = TIMER_FREQUENCY;
+    const Uint32 KEY_WAIT_TIMEOUT_MS = 100;  // Longest sleep while blocked in Fx0A
+
+    // Present from a render thread; update_display() then only hands frames over
+    bool threaded = platform_sdl_start_renderer(&platform);
 
     Uint32 last_time = SDL_GetTicks();
     Uint32 accumulator = 0;
+    Chip8Frame frame = {0};
 
     while (!quit_requested) {
         Uint32 current_time = SDL_GetTicks();
@@ -147,23 +217,33 @@ int SDL_main(int argc, char *argv[])
 
         // Run cycles for each frame slice
         while (accumulator >= (1000 / FRAME_RATE)) {
-            for (int i = 0; i < CYCLES_PER_FRAME; i++) {
-                chip8_cycle(&chip8);
-            }
+            frame = chip8_run_frame(&chip8);
 
-            if (chip8.draw_flag) {
-                update_display(&chip8);
-                chip8.draw_flag = false;
-            }
+            if (frame.draw) update_display(&chip8);
 
             accumulator -= (1000 / FRAME_RATE);
         }
 
-        // Avoid maxing out CPU
-        SDL_Delay(1);
+        if (frame.waiting && !frame.sound) {
+            // Blocked on a key wait: sleep on the input events instead of polling.
+            // The frames missed meanwhile are caught up above and cost almost nothing.
+            platform_wait_input(&platform, KEY_WAIT_TIMEOUT_MS);
+            frame.waiting = false;  // Sleep again only after a frame still finds no key
+        } else {
+            // Avoid maxing out CPU
+            SDL_Delay(1);
+        }
+    }
+
+    if (threaded) {
+        PlatformRenderStats stats;
+        platform_sdl_stop_renderer(&platform, &stats);
+        printf("Render thread: %llu frames presented, %llu dropped of %llu; queue latency avg %.2f ms, max %.2f ms\n",
+               (unsigned long long)stats.presented, (unsigned long long)stats.dropped,
+               (unsigned long long)stats.published, stats.latency_avg_ms, stats.latency_max_ms);
     }
 
-    display_quit();
+    platform_quit(&platform);
     return EXIT_SUCCESS;
 #else
     return EXIT_SUCCESS;
@@ -1,26 +1,20 @@
 #include "opcodes.h"
+#include "dispatch.h"
 #include "display.h"
 #include "input.h"
+#include "rng.h"
 #include "timer.h"
 #include "utils.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 
-// Macros for extracting components of an opcode
-#define OPCODE_NNN(op) ((op) & 0x0FFF)       // Lowest 12 bits
-#define OPCODE_X(op)   (((op) >> 8) & 0x0F)  // 2nd nibble
-#define OPCODE_Y(op)   (((op) >> 4) & 0x0F)  // 3rd nibble
-#define OPCODE_N(op)   ((op) & 0x000F)       // Lowest nibble
-#define OPCODE_KK(op)  ((op) & 0x00FF)       // Lowest byte
-
 /**
  * 00E0 - CLS
  * Clear the display.
  */
 void op_00E0(Chip8 *chip8, uint16_t opcode) {
-    memset(chip8->display, 0, sizeof(chip8->display));
-    chip8->draw_flag = true;
+    clear_display(chip8);
 }
 
 #include "utils.h" // Ensures access to test_halt
@@ -230,9 +224,10 @@ void op_Bnnn(Chip8 *chip8, uint16_t opcode) {
 /**
  * Cxkk - RND Vx, kk
  * Set Vx = random byte AND kk.
+ * The byte comes from the instance's seeded generator (see rng.c).
  */
 void op_Cxkk(Chip8 *chip8, uint16_t opcode) {
-    uint8_t rnd = rand() % 256;
+    uint8_t rnd = rng_byte(chip8);
     chip8->V[OPCODE_X(opcode)] = rnd & OPCODE_KK(opcode);
 }
 
@@ -246,7 +241,6 @@ void op_Dxyn(Chip8 *chip8, uint16_t opcode) {
     uint8_t n = OPCODE_N(opcode);
     const uint8_t *sprite = &chip8->memory[chip8->I];
     chip8->V[0xF] = draw_sprite(chip8, x, y, n, sprite);
-    chip8->draw_flag = true;
 }
 
 /**
@@ -272,21 +266,26 @@ void op_ExA1(Chip8 *chip8, uint16_t opcode) {
  * Set Vx = delay timer.
  */
 void op_Fx07(Chip8 *chip8, uint16_t opcode) {
-    chip8->V[OPCODE_X(opcode)] = chip8->delay_timer;
+    chip8->V[OPCODE_X(opcode)] = get_delay_timer(chip8);
 }
 
 /**
  * Fx0A - LD Vx, K
  * Wait for key press, store it in Vx.
+ *
+ * With no key down, PC stays on this instruction and the VM enters the
+ * key-wait run state; `chip8_run` then idles until a poll finds a key.
  */
 void op_Fx0A(Chip8 *chip8, uint16_t opcode) {
     for (uint8_t key = 0; key < KEYPAD_SIZE; ++key) {
         if (chip8->keypad[key]) {
             chip8->V[OPCODE_X(opcode)] = key;
+            chip8->key_wait = false;
             return;
         }
     }
     chip8->pc -= 2;  // Repeat instruction if no key pressed
+    chip8->key_wait = true;
 }
 
 /**
@@ -294,7 +293,7 @@ void op_Fx0A(Chip8 *chip8, uint16_t opcode) {
  * Set delay timer = Vx.
  */
 void op_Fx15(Chip8 *chip8, uint16_t opcode) {
-    chip8->delay_timer = chip8->V[OPCODE_X(opcode)];
+    set_delay_timer(chip8, chip8->V[OPCODE_X(opcode)]);
 }
 
 /**
@@ -302,7 +301,7 @@ void op_Fx15(Chip8 *chip8, uint16_t opcode) {
  * Set sound timer = Vx.
  */
 void op_Fx18(Chip8 *chip8, uint16_t opcode) {
-    chip8->sound_timer = chip8->V[OPCODE_X(opcode)];
+    set_sound_timer(chip8, chip8->V[OPCODE_X(opcode)]);
 }
 
 /**
@@ -324,22 +323,26 @@ void op_Fx29(Chip8 *chip8, uint16_t opcode) {
 /**
  * Fx33 - LD B, Vx
  * Store BCD of Vx at I, I+1, I+2.
+ * Memory stores must invalidate the decode cache (see dispatch_invalidate).
  */
 void op_Fx33(Chip8 *chip8, uint16_t opcode) {
     uint8_t value = chip8->V[OPCODE_X(opcode)];
     chip8->memory[chip8->I]     = value / 100;
     chip8->memory[chip8->I + 1] = (value / 10) % 10;
     chip8->memory[chip8->I + 2] = value % 10;
+    dispatch_invalidate(chip8, chip8->I, 3);
 }
 
 /**
  * Fx55 - LD [I], Vx
  * Store registers V0 through Vx in memory starting at I.
+ * Memory stores must invalidate the decode cache (see dispatch_invalidate).
  */
 void op_Fx55(Chip8 *chip8, uint16_t opcode) {
     uint8_t Vx = OPCODE_X(opcode);
     for (int i = 0; i <= Vx; i++)
         chip8->memory[chip8->I + i] = chip8->V[i];
+    dispatch_invalidate(chip8, chip8->I, Vx + 1);
 }
 
 /**
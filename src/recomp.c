@@ -0,0 +1,105 @@
+/**
+ * recomp.c
+ *
+ * Runtime support for ROMs translated ahead of time by chip8-recomp.
+ *
+ * The generated translation unit provides one C function per basic block and
+ * an address map. This module runs those blocks from `chip8_run` and hands
+ * control back to the interpreter whenever:
+ * - PC is not the start of a translated block (e.g., after Bnnn)
+ * - The block's bytes no longer match the original ROM (self-modified code)
+ *   Only blocks overlapping memory written since attach are compared; stores
+ *   report their range through `dispatch_invalidate`.
+ * - The block would exceed the remaining instruction budget
+ * - Fx0A found no key down (the VM is waiting for a key)
+ */
+
+#include "recomp.h"
+#include "dispatch.h"
+#include "idle.h"
+#include "utils.h"
+#include <string.h>
+
+/**
+ * Loads a recompiled program into an instance.
+ *
+ * Copies the original ROM image to 0x200 (replacing `chip8_load_rom`) and
+ * makes `chip8_run` execute the native blocks.
+ *
+ * @param chip8   Pointer to the emulator state (after chip8_init).
+ * @param program Program emitted by chip8-recomp.
+ */
+void recomp_attach(Chip8 *chip8, const RecompProgram *program) {
+    if (!chip8 || !program) {
+        fprintf(stderr, "recomp_attach called with null pointer\n");
+        return;
+    }
+
+    memory_copy(chip8->memory + 0x200, program->rom, program->rom_size);
+    dispatch_invalidate_all(chip8);
+    chip8->recomp = program;
+
+    // Memory now matches the ROM image exactly
+    chip8->recomp_dirty_lo = MEMORY_SIZE;
+    chip8->recomp_dirty_hi = 0;
+}
+
+/**
+ * Widens the written range that blocks are re-checked against.
+ *
+ * @param chip8 Pointer to the emulator state.
+ * @param addr  First written address.
+ * @param len   Number of bytes written.
+ */
+void recomp_invalidate(Chip8 *chip8, uint16_t addr, uint16_t len) {
+    uint32_t end = (uint32_t)addr + len;
+
+    if (end > MEMORY_SIZE) {
+        end = MEMORY_SIZE;
+    }
+    if (addr < chip8->recomp_dirty_lo) {
+        chip8->recomp_dirty_lo = addr;
+    }
+    if (end > chip8->recomp_dirty_hi) {
+        chip8->recomp_dirty_hi = (uint16_t)end;
+    }
+}
+
+/**
+ * Runs translated blocks back to back, starting at the current PC.
+ *
+ * @param chip8  Pointer to the emulator state.
+ * @param budget Maximum number of instructions to execute.
+ * @return       Number of instructions executed natively.
+ *
+ * Advances the emulated clock after each block. Stops at a timer-wait loop
+ * the interpreter fast-forwards (see idle.c).
+ */
+uint32_t recomp_execute(Chip8 *chip8, uint32_t budget) {
+    const RecompProgram *program = chip8->recomp;
+    uint32_t executed = 0;
+
+    while (chip8->pc < MEMORY_SIZE) {
+        const RecompBlock *block = program->map[chip8->pc];
+
+        if (!block || block->length > budget - executed) break;
+
+        // Timer-wait loops are fast-forwarded by the interpreter instead
+        if (idle_at(chip8)) break;
+
+        // Possibly self-modified code: let the interpreter run the current bytes
+        if (block->addr < chip8->recomp_dirty_hi &&
+            block->addr + block->size > chip8->recomp_dirty_lo &&
+            memcmp(&chip8->memory[block->addr], &program->rom[block->addr - 0x200], block->size) != 0)
+            break;
+
+        uint32_t ran = block->fn(chip8);
+        executed += ran;
+        chip8->cycles += ran;
+
+        // Fx0A found no key: chip8_run idles out the frame
+        if (chip8->key_wait) break;
+    }
+
+    return executed;
+}
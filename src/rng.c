@@ -0,0 +1,60 @@
+/**
+ * rng.c
+ *
+ * Per-instance random numbers for Cxkk.
+ *
+ * Each Chip8 owns a PCG32 generator (64-bit LCG state, XSH-RR output) in
+ * `chip8->rng`. The state is part of the power-on state: `chip8_reset`
+ * derives it from `chip8->seed`, which is configuration and survives
+ * resets. A run is therefore a function of the ROM, the seed and the input,
+ * whatever else the process does, and instances on different threads never
+ * share anything.
+ *
+ * With `chip8->libc_rand` set, Cxkk draws from the C library's `rand()`
+ * instead, as before per-instance generators existed (process-wide and
+ * seeded with `srand`).
+ */
+
+#include "rng.h"
+#include <stdlib.h>
+
+#define PCG_MULTIPLIER 6364136223846793005ull
+#define PCG_INCREMENT 1442695040888963407ull  // Any odd constant selects the stream
+
+/**
+ * Advances the state and returns the next 32-bit output.
+ */
+static uint32_t pcg32(uint64_t *state) {
+    uint64_t old = *state;
+    *state = old * PCG_MULTIPLIER + PCG_INCREMENT;
+
+    uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+    uint32_t rot = (uint32_t)(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+}
+
+/**
+ * Sets the generator state from a seed (the reference PCG32 seeding), so
+ * every seed, including 0, gives a full-period sequence.
+ *
+ * @param chip8 Pointer to the emulator state.
+ * @param seed  Any 64-bit value.
+ */
+void rng_seed(Chip8 *chip8, uint64_t seed) {
+    chip8->rng = 0;
+    pcg32(&chip8->rng);
+    chip8->rng += seed;
+    pcg32(&chip8->rng);
+}
+
+/**
+ * Draws the random byte of one Cxkk.
+ *
+ * @param chip8 Pointer to the emulator state.
+ * @return      The top byte of the next PCG32 output, or `rand() % 256`
+ *              with `chip8->libc_rand`.
+ */
+uint8_t rng_byte(Chip8 *chip8) {
+    if (chip8->libc_rand) return (uint8_t)(rand() % 256);
+    return (uint8_t)(pcg32(&chip8->rng) >> 24);
+}
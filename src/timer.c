@@ -5,11 +5,24 @@
  *
  * Implements the behavior of the delay and sound timers as defined in the CHIP-8 specification.
  * Timers count down at a fixed 60Hz rate and can be accessed or modified by various opcodes.
+ *
+ * Timers are never decremented. Each one stores the value it was set to and
+ * the emulated cycle (`chip8->cycles`) at which it was set; the current value
+ * is derived from the number of 60Hz ticks of the emulated clock since then,
+ * at `chip8->cpu_hz` instructions per second. Nothing runs per instruction or
+ * per frame, and timer behavior does not depend on how the host batches
+ * frames or how fast it runs them.
+ *
+ * The beep is reported to the platform as start/stop edges stamped with the
+ * emulated time at which they happen: a start when the sound timer is set,
+ * a stop at the exact cycle it runs out (found lazily, when the timer is set
+ * again or at the end of a frame). Backends can render them sample-accurately
+ * whatever the frame batching.
  */
 
 #include "timer.h"
 #include "utils.h"
-#include "platform.h"  // For platform_play_beep
+#include "platform.h"  // For platform_beep_edge
 #include <stdint.h>
 #include <stdio.h>
 
@@ -29,14 +42,101 @@ void timer_init(Chip8 *chip8) {
 
     chip8->delay_timer = 0;
     chip8->sound_timer = 0;
+    chip8->delay_set_at = chip8->cycles;
+    chip8->sound_set_at = chip8->cycles;
+}
+
+/**
+ * Converts a point on the emulated clock to 60Hz timer ticks.
+ *
+ * Tick k starts at the first cycle c with c * 60 / cpu_hz >= k, so at 600Hz
+ * the timers tick every 10 instructions and at 700Hz every 11 or 12.
+ *
+ * @param chip8 Pointer to the CHIP-8 emulator state.
+ * @param cycle Instructions executed since reset.
+ * @return      Ticks elapsed by that cycle.
+ */
+uint64_t timer_ticks(const Chip8 *chip8, uint64_t cycle) {
+    uint32_t hz = chip8->cpu_hz ? chip8->cpu_hz : CPU_FREQUENCY;
+    return cycle * TIMER_FREQUENCY / hz;
+}
+
+/**
+ * Finds where the next 60Hz tick starts on the emulated clock.
+ *
+ * @param chip8 Pointer to the CHIP-8 emulator state.
+ * @param cycle Current point on the emulated clock.
+ * @return      Smallest cycle > `cycle` whose tick count is one higher.
+ */
+uint64_t timer_next_tick(const Chip8 *chip8, uint64_t cycle) {
+    uint32_t hz = chip8->cpu_hz ? chip8->cpu_hz : CPU_FREQUENCY;
+    uint64_t next = timer_ticks(chip8, cycle) + 1;
+
+    return (next * hz + TIMER_FREQUENCY - 1) / TIMER_FREQUENCY;
+}
+
+/**
+ * Value of a timer at a given cycle.
+ *
+ * @param chip8  Pointer to the CHIP-8 emulator state.
+ * @param value  Value the timer was set to.
+ * @param set_at Cycle at which it was set.
+ * @param now    Cycle to evaluate at (not before `set_at`).
+ * @return       The value minus the ticks since then, floored at 0.
+ */
+static inline uint8_t timer_value(const Chip8 *chip8, uint8_t value, uint64_t set_at, uint64_t now) {
+    if (!value) return 0;
+
+    uint64_t elapsed = timer_ticks(chip8, now) - timer_ticks(chip8, set_at);
+    return elapsed >= value ? 0 : (uint8_t)(value - elapsed);
+}
+
+/**
+ * Converts a point on the emulated clock to microseconds.
+ *
+ * @param chip8 Pointer to the CHIP-8 emulator state.
+ * @param cycle Instructions executed since reset.
+ * @return      Emulated time at that cycle, in microseconds since reset.
+ */
+uint64_t timer_cycle_us(const Chip8 *chip8, uint64_t cycle) {
+    uint32_t hz = chip8->cpu_hz ? chip8->cpu_hz : CPU_FREQUENCY;
+    return cycle * 1000000 / hz;
+}
+
+/**
+ * Start or stop the beep at `cycle` and tell the platform.
+ */
+static void sound_edge(Chip8 *chip8, bool active, uint64_t cycle) {
+    chip8->sound_active = active;
+    platform_beep_edge(chip8->platform, active, timer_cycle_us(chip8, cycle));
 }
 
 /**
- * Update the CHIP-8 timers once per frame (typically at 60Hz).
+ * Stop the beep if the sound timer ran out by `now`.
  *
- * - Decrements the delay timer if it is greater than zero.
- * - Decrements the sound timer and plays a beep when active.
- * - Stops beeping when the sound timer reaches zero.
+ * The beep lasts from the cycle the sound timer was set until the first
+ * cycle at which it reads 0, so a timer set to 1 beeps for the rest of
+ * the tick it was set in.
+ */
+static void sound_catch_up(Chip8 *chip8, uint64_t now) {
+    if (!chip8->sound_active) return;
+
+    uint32_t hz = chip8->cpu_hz ? chip8->cpu_hz : CPU_FREQUENCY;
+    uint64_t end_tick = timer_ticks(chip8, chip8->sound_set_at) + chip8->sound_timer;
+    uint64_t end = (end_tick * hz + TIMER_FREQUENCY - 1) / TIMER_FREQUENCY;
+
+    if (now >= end) sound_edge(chip8, false, end);
+}
+
+/**
+ * Bring the platform's beep up to date with the sound timer.
+ *
+ * Reports the stop edge of a beep that ran out during the frame (stamped
+ * with the cycle it ran out at). Start edges are reported when the timer
+ * is set, so the audio device is not touched on frames where nothing
+ * changed.
+ *
+ * Called once per frame by `chip8_run`.
  *
  * @param chip8 Pointer to the CHIP-8 emulator state.
  */
@@ -46,46 +146,39 @@ void timer_update(Chip8 *chip8) {
         return;
     }
 
-    if (chip8->delay_timer > 0) {
-        chip8->delay_timer--;
-    }
-
-    if (chip8->sound_timer > 0) {
-        chip8->sound_timer--;
-        platform_play_beep(true);  // Activate tone while sound timer is active
-    } else {
-        platform_play_beep(false); // Silence when sound timer expires
-    }
+    sound_catch_up(chip8, chip8->cycles);
 }
 
 /**
  * Get the current value of the delay timer.
  *
+ * Used by opcode 0xFx07.
+ *
  * @param chip8 Pointer to the CHIP-8 emulator state.
- * @return      Current value of the delay timer.
+ * @return      Value of the delay timer at `chip8->cycles`.
  */
-uint8_t get_delay_timer(Chip8 *chip8) {
+uint8_t get_delay_timer(const Chip8 *chip8) {
     if (!chip8) {
         DEBUG_PRINT(chip8, "get_delay_timer called with null pointer\n");
         return 0;
     }
 
-    return chip8->delay_timer;
+    return timer_value(chip8, chip8->delay_timer, chip8->delay_set_at, chip8->cycles);
 }
 
 /**
  * Get the current value of the sound timer.
  *
  * @param chip8 Pointer to the CHIP-8 emulator state.
- * @return      Current value of the sound timer.
+ * @return      Value of the sound timer at `chip8->cycles`.
  */
-uint8_t get_sound_timer(Chip8 *chip8) {
+uint8_t get_sound_timer(const Chip8 *chip8) {
     if (!chip8) {
         DEBUG_PRINT(chip8, "get_sound_timer called with null pointer\n");
         return 0;
     }
 
-    return chip8->sound_timer;
+    return timer_value(chip8, chip8->sound_timer, chip8->sound_set_at, chip8->cycles);
 }
 
 /**
@@ -103,12 +196,14 @@ void set_delay_timer(Chip8 *chip8, uint8_t value) {
     }
 
     chip8->delay_timer = value;
+    chip8->delay_set_at = chip8->cycles;
 }
 
 /**
  * Set the sound timer to a specific value.
  *
- * Used by opcode 0xFx18.
+ * Used by opcode 0xFx18. Starts the beep (or stops it, for 0) at the
+ * current cycle; a beep still running just continues.
  *
  * @param chip8 Pointer to the CHIP-8 emulator state.
  * @param value New value for the sound timer.
@@ -119,5 +214,10 @@ void set_sound_timer(Chip8 *chip8, uint8_t value) {
         return;
     }
 
+    sound_catch_up(chip8, chip8->cycles);  // An earlier beep may have ended before now
+
     chip8->sound_timer = value;
+    chip8->sound_set_at = chip8->cycles;
+
+    if ((value > 0) != chip8->sound_active) sound_edge(chip8, value > 0, chip8->cycles);
 }
@@ -12,11 +12,14 @@
 
 #include "chip8.h"
 #include "utils.h"
+#include "timer.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#ifdef _WIN32
 #include <direct.h>     // For _mkdir on Windows
+#endif
 #include <libgen.h>     // For basename and dirname
 #include <sys/stat.h>   // For mkdir on Unix
 #include <sys/types.h>
@@ -128,6 +131,7 @@ void print_registers(const uint8_t *V, uint16_t I, uint16_t pc, uint8_t delay_ti
  *   - 0x1012–0x1013: PC register (2 bytes, little endian)
  *   - 0x1014: delay_timer (1 byte)
  *   - 0x1015: sound_timer (1 byte)
+ *   - 0x1016–0x1115: display (32 rows of 8 bytes, little endian, bit 63 = leftmost pixel)
  *
  * @param chip8     Pointer to the emulator state.
  * @param rom_path  Path to the loaded ROM (used to name the output file).
@@ -176,8 +180,9 @@ void dump_memory(Chip8 *chip8, const char *rom_path) {
     fwrite(chip8->V, 1, 16, f);
     fwrite(&chip8->I, sizeof(uint16_t), 1, f);
     fwrite(&chip8->pc, sizeof(uint16_t), 1, f);
-    fwrite(&chip8->delay_timer, sizeof(uint8_t), 1, f);
-    fwrite(&chip8->sound_timer, sizeof(uint8_t), 1, f);
+    uint8_t timers[2] = { get_delay_timer(chip8), get_sound_timer(chip8) };
+    fwrite(timers, sizeof(uint8_t), 2, f);
+    fwrite(chip8->display, sizeof(uint64_t), DISPLAY_HEIGHT, f);
 
     fclose(f);
     printf("Memory dumped to %s\n", full_path);
@@ -195,7 +200,7 @@ void test_halt(Chip8 *chip8, const char *rom_path) {
     fprintf(stderr, "[TEST_MODE] End of test reached after RET — exiting emulator.\n");
 
 #ifdef DEBUG
-    print_registers(chip8->V, chip8->I, chip8->pc, chip8->delay_timer, chip8->sound_timer);
+    print_registers(chip8->V, chip8->I, chip8->pc, get_delay_timer(chip8), get_sound_timer(chip8));
 #endif
 
     dump_memory(chip8, rom_path);
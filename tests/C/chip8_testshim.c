@@ -1,5 +1,6 @@
 // chip8_testshim.c
 #include "chip8_testshim.h"
+#include "timer.h"
 #include <stdio.h>
 #include <stdint.h>
 
@@ -21,13 +22,15 @@ void chip8_dump_state(Chip8 *chip8, const char *filename) {
     // - 0x1012–0x1013: PC register (2 bytes, little endian)
     // - 0x1014: delay_timer (1 byte)
     // - 0x1015: sound_timer (1 byte)
+    // - 0x1016–0x1115: display (32 rows of 8 bytes, little endian, bit 63 = leftmost pixel)
 
     fwrite(chip8->memory, 1, 4096, f);                  // memory
     fwrite(chip8->V, 1, 16, f);                         // V[0–F]
     fwrite(&chip8->I, sizeof(uint16_t), 1, f);          // I
     fwrite(&chip8->pc, sizeof(uint16_t), 1, f);         // PC
-    fwrite(&chip8->delay_timer, sizeof(uint8_t), 1, f); // delay_timer
-    fwrite(&chip8->sound_timer, sizeof(uint8_t), 1, f); // sound_timer
+    uint8_t timers[2] = { get_delay_timer(chip8), get_sound_timer(chip8) };
+    fwrite(timers, sizeof(uint8_t), 2, f);              // delay_timer, sound_timer
+    fwrite(chip8->display, sizeof(uint64_t), DISPLAY_HEIGHT, f);  // display rows
 
     fclose(f);
 }
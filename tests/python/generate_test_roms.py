@@ -55,6 +55,8 @@ def disassemble(opcode: int) -> str:
         return f"ADD V{x:X}, 0x{kk:02X}"
     elif opcode & 0xF000 == 0xA000:
         return f"LD I, 0x{nnn:03X}"
+    elif opcode & 0xF000 == 0xC000:
+        return f"RND V{x:X}, 0x{kk:02X}"
     elif opcode & 0xF000 == 0xD000:
         return f"DRW V{x:X}, V{y:X}, 0x{n:X}"
     elif opcode & 0xF0FF == 0xE09E:
@@ -129,7 +131,54 @@ def generate_roms() -> None:
         "draw_sprite.rom": [0x6000, 0x6100, 0xA300, 0xD015],
         "key_skip.rom": [0x6005, 0xE09E, 0x60FF],
         "bcd.rom": [0x600F, 0xA300, 0xF033],
-        "timer_set.rom": [0x601E, 0xF015, 0xF018],  # Note: not currently validated due to timing issues
+        "timer_set.rom": [0x601E, 0xF015, 0xF018],
+        "self_modify.rom": [
+            0x6300,      # LD V3, 0x00
+            0x6505,      # LD V5, 0x05   <- patched to LD V5, 0x42 after first run
+            0x3301,      # SE V3, 0x01
+            0x1212,      # JP 0x212      (first pass: go patch)
+            0x00EE,      # RET           (second pass: done)
+            0x6065,      # LD V0, 0x65
+            0x6142,      # LD V1, 0x42
+            0xA20A,      # LD I, 0x20A
+            0xF155,      # LD [I], V0–V1 (overwrite already-executed code)
+            0x6301,      # LD V3, 0x01
+            0x120A,      # JP 0x20A
+        ],
+        "counting_loop.rom": [
+            0x6100,      # LD V1, 0x00   \
+            0x6200,      # LD V2, 0x00    > register setup
+            0x6300,      # LD V3, 0x00   /
+            0x7101,      # ADD V1, 0x01  \
+            0x3105,      # SE V1, 0x05    > counting loop
+            0x120E,      # JP 0x20E      /
+            0xA300,      # LD I, 0x300   \ draw pair
+            0xD235,      # DRW V2, V3, 5 /
+        ],
+        "draw_wrap.rom": [
+            0x00E0,      # CLS           (the body runs twice)
+            0x6000,      # LD V0, 0x00
+            0xF029,      # LD F, V0      (glyph "0")
+            0x613E,      # LD V1, 62
+            0x621E,      # LD V2, 30
+            0xD125,      # DRW V1, V2, 5 (wraps right and bottom edges)
+        ],
+        "idle_loop.rom": [
+            0x6103,      # LD V1, 0x03
+            0xF115,      # LD DT, V1
+            0xF407,      # LD V4, DT     \
+            0x4403,      # SNE V4, 0x03   > wait while DT == 3
+            0x120C,      # JP 0x20C      /
+            0xF207,      # LD V2, DT     \
+            0x3200,      # SE V2, 0x00    > wait for DT == 0
+            0x1212,      # JP 0x212      /
+            0x6301,      # LD V3, 0x01
+        ],
+        "rnd.rom": [
+            0xC0FF,      # RND V0, 0xFF  \
+            0xC1FF,      # RND V1, 0xFF   > per-instance generator, default seed (1)
+            0xC20F,      # RND V2, 0x0F  /
+        ],
     }
 
     for name, body in roms_raw.items():
@@ -137,7 +186,7 @@ def generate_roms() -> None:
         padding_size = (0x208 - 0x202) // 2
         wrapper = [CALL_TEST] + [0x6000] * padding_size
 
-        if name == "call_ret.rom":
+        if name in ("call_ret.rom", "self_modify.rom"):
             test = body  # already includes RET
         else:
             test = body + [TEST_END]  # ensure clean return
@@ -52,7 +52,7 @@ class Chip8(ctypes.LittleEndianStructure):
         sound_timer  -- sound timer value
         draw_flag    -- flag to signal redraw
         keypad       -- 16-key input array
-        display      -- 64x32 monochrome pixel display buffer
+        display      -- 32 packed 64-bit rows (bit 63 = leftmost pixel)
         stack        -- 16-entry call stack
         memory       -- 4096-byte main memory
     """
@@ -65,7 +65,7 @@ class Chip8(ctypes.LittleEndianStructure):
         ("sound_timer", ctypes.c_uint8),
         ("draw_flag", ctypes.c_uint8),
         ("keypad", ctypes.c_uint8 * KEYPAD_SIZE),
-        ("display", ctypes.c_uint8 * (DISPLAY_WIDTH * DISPLAY_HEIGHT)),
+        ("display", ctypes.c_uint64 * DISPLAY_HEIGHT),
         ("stack", ctypes.c_uint16 * STACK_SIZE),
         ("memory", ctypes.c_uint8 * MEMORY_SIZE),
     ]
@@ -82,6 +82,7 @@ def read_dump(path: str):
     - [0x1012–0x1013]   → PC register (little endian)
     - [0x1014]          → delay_timer
     - [0x1015]          → sound_timer
+    - [0x1016–0x1115]   → display, 32 rows of 8 bytes (little endian, bit 63 = leftmost pixel)
 
     Args:
         path: Path to the binary dump file.
@@ -101,8 +102,18 @@ def read_dump(path: str):
             self.pc = int.from_bytes(raw[4114:4116], "little")
             self.delay_timer = raw[4116]
             self.sound_timer = raw[4117]
+            self.display = [int.from_bytes(raw[4118 + 8 * y:4126 + 8 * y], "little")
+                            for y in range(DISPLAY_HEIGHT)]
             # Note: Add more fields here if extended in the C dump format
 
+        def pixel(self, x: int, y: int) -> int:
+            """Return the pixel at (x, y): 1 if lit, 0 otherwise."""
+            return (self.display[y] >> (63 - x)) & 1
+
+        def pixels(self) -> list:
+            """Unpack the display to one value per pixel, row-major (64x32)."""
+            return [self.pixel(x, y) for y in range(DISPLAY_HEIGHT) for x in range(DISPLAY_WIDTH)]
+
     with open(path, "rb") as f:
         data = f.read()
 
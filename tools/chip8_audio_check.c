@@ -0,0 +1,279 @@
+/**
+ * chip8_audio_check.c
+ *
+ * End-to-end check of the SDL beep: runs a program through the real SDL
+ * backend with the disk audio driver (SDL_AUDIODRIVER=disk), which writes
+ * every sample the audio callback produces to a raw file, then reads the
+ * file back and compares it with the beep edges the core reported.
+ *
+ * Each beep must come out as one run of non-silent samples whose length,
+ * and distance from the previous beep, are exactly the number of samples
+ * between its edges on the emulated clock, and the run must be the square
+ * wave from phase 0. Any click, gap, truncated or stretched beep fails.
+ *
+ * Without a ROM, a built-in program plays a pattern of beeps and pauses
+ * (including a beep extended while playing and one cut short by ST = 0).
+ * The emulator is paced at 60Hz so edges reach the audio thread as they
+ * would in the interactive build.
+ *
+ * Usage:
+ *     chip8-audio-check [--frames N] [--out FILE] [ROM]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL_stdinc.h>
+#include <SDL_timer.h>
+
+#include "chip8.h"
+#include "platform.h"
+#include "timer.h"
+
+#define AUDIO_RATE 44100               // Must match platform_sdl.c
+#define TONE_PERIOD (AUDIO_RATE / 440)
+#define SILENCE 128
+
+#define MAX_EDGES 4096
+#define DEFAULT_OUT "chip8_audio_check.raw"
+#define DEFAULT_ROM_FRAMES 600         // Ten seconds of a ROM
+#define DRAIN_MS 500                   // Audio still queued after the last frame
+
+// Beep pattern of the built-in program: set ST, then wait for DT to run out
+typedef struct {
+    uint8_t sound;                     // ST value (0 stops a beep)
+    uint8_t wait;                      // Ticks until the next entry
+} BeepStep;
+
+static const BeepStep pattern[] = {
+    { 1, 3 }, { 2, 5 }, { 6, 9 }, { 5, 2 }, { 4, 8 },   // 5 then 4 extends the beep
+    { 20, 22 }, { 3, 4 }, { 8, 3 }, { 0, 6 }, { 45, 50 },
+};
+
+// Beep edges as reported by the core, forwarded to the SDL backend
+typedef struct {
+    Platform sdl;
+    uint64_t time_us[MAX_EDGES];
+    bool active[MAX_EDGES];
+    int count;
+} Recorder;
+
+static void record_edge(void *ctx, bool active, uint64_t time_us) {
+    Recorder *rec = ctx;
+    if (rec->count < MAX_EDGES) {
+        rec->time_us[rec->count] = time_us;
+        rec->active[rec->count] = active;
+        rec->count++;
+    }
+    platform_beep_edge(&rec->sdl, active, time_us);
+}
+
+/**
+ * Assembles the built-in pattern at 0x200.
+ *
+ * @return Frames needed to play it, plus a few of silence.
+ */
+static long load_pattern(Chip8 *chip8) {
+    uint16_t addr = 0x200;
+    long frames = 10;
+
+    for (size_t i = 0; i < sizeof(pattern) / sizeof(pattern[0]); i++) {
+        const uint16_t loop = addr + 8;
+        const uint16_t code[] = {
+            (uint16_t)(0x6000 | pattern[i].sound),   // LD V0, sound
+            0xF018,                                  // LD ST, V0
+            (uint16_t)(0x6100 | pattern[i].wait),    // LD V1, wait
+            0xF115,                                  // LD DT, V1
+            0xF207,                                  // loop: LD V2, DT
+            0x3200,                                  // SE V2, 0
+            (uint16_t)(0x1000 | loop),               // JP loop
+        };
+        for (size_t k = 0; k < sizeof(code) / sizeof(code[0]); k++, addr += 2) {
+            chip8->memory[addr] = (uint8_t)(code[k] >> 8);
+            chip8->memory[addr + 1] = (uint8_t)code[k];
+        }
+        frames += pattern[i].wait + 1;
+    }
+
+    chip8->memory[addr] = (uint8_t)((0x1000 | addr) >> 8);   // JP . (done)
+    chip8->memory[addr + 1] = (uint8_t)addr;
+    return frames;
+}
+
+/**
+ * Sample index of an edge, as computed by the audio callback.
+ */
+static int64_t edge_sample(uint64_t time_us) {
+    return (int64_t)(time_us * AUDIO_RATE / 1000000);
+}
+
+/**
+ * Reads the whole raw sample file.
+ *
+ * @return Allocated buffer (caller frees) or NULL on failure.
+ */
+static uint8_t *read_samples(const char *path, long *length) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    *length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    uint8_t *samples = malloc(*length > 0 ? (size_t)*length : 1);
+    if (samples && fread(samples, 1, (size_t)*length, file) != (size_t)*length) {
+        free(samples);
+        samples = NULL;
+    }
+    fclose(file);
+    return samples;
+}
+
+/**
+ * Compares the recorded samples with the beep edges.
+ *
+ * @return Number of mismatches found.
+ */
+static int check_samples(const Recorder *rec, const uint8_t *samples, long length) {
+    int errors = 0, beeps = 0;
+    long pos = 0, previous_end = -1;
+    int64_t previous_off = 0;
+
+    for (int e = 0; e + 1 < rec->count; e += 2) {
+        if (!rec->active[e] || rec->active[e + 1]) {
+            fprintf(stderr, "Edges %d and %d are not a start/stop pair\n", e, e + 1);
+            return errors + 1;
+        }
+
+        int64_t on = edge_sample(rec->time_us[e]);
+        int64_t off = edge_sample(rec->time_us[e + 1]);
+
+        // Find the next non-silent run
+        while (pos < length && samples[pos] == SILENCE) pos++;
+        long start = pos;
+        while (pos < length && samples[pos] != SILENCE) pos++;
+
+        if (start >= length) {
+            fprintf(stderr, "Beep %d missing from the output\n", beeps);
+            return errors + 1;
+        }
+
+        if (pos - start != off - on) {
+            fprintf(stderr, "Beep %d: %ld samples, expected %lld\n", beeps, pos - start, (long long)(off - on));
+            errors++;
+        }
+        if (previous_end >= 0 && start - previous_end != on - previous_off) {
+            fprintf(stderr, "Beep %d: gap of %ld samples, expected %lld\n", beeps,
+                    start - previous_end, (long long)(on - previous_off));
+            errors++;
+        }
+        for (long i = start; i < pos; i++) {
+            uint8_t expected = ((i - start) % TONE_PERIOD < TONE_PERIOD / 2) ? SILENCE + 64 : SILENCE - 64;
+            if (samples[i] != expected) {
+                fprintf(stderr, "Beep %d: wrong waveform at sample %ld\n", beeps, i - start);
+                errors++;
+                break;
+            }
+        }
+
+        if (beeps == 0) printf("First beep at output sample %ld\n", start);
+        previous_end = pos;
+        previous_off = off;
+        beeps++;
+    }
+
+    while (pos < length && samples[pos] == SILENCE) pos++;
+    if (pos < length) {
+        fprintf(stderr, "Unexpected sound after the last beep (sample %ld)\n", pos);
+        errors++;
+    }
+
+    printf("%d beep(s), %d edge(s), %ld samples checked\n", beeps, rec->count, length);
+    return errors;
+}
+
+int SDL_main(int argc, char *argv[]) {
+    long frames = 0;
+    const char *out = DEFAULT_OUT;
+    const char *rom = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = strtol(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out = argv[++i];
+        } else if (argv[i][0] != '-' && !rom) {
+            rom = argv[i];
+        } else {
+            fprintf(stderr, "Usage: %s [--frames N] [--out FILE] [ROM]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // No window and no sound card: samples go to `out`
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    SDL_setenv("SDL_AUDIODRIVER", "disk", 1);
+    SDL_setenv("SDL_DISKAUDIOFILE", out, 1);
+
+    static Recorder rec;
+    if (!platform_sdl_init(&rec.sdl)) {
+        fprintf(stderr, "Failed to initialize SDL\n");
+        return EXIT_FAILURE;
+    }
+    const Platform recorder = { .ctx = &rec, .beep_edge = record_edge };
+
+    static Chip8 chip8;
+    chip8_init(&chip8);
+    chip8.platform = &recorder;
+
+    if (rom) {
+        if (chip8_load_rom(&chip8, rom)) {
+            fprintf(stderr, "Failed to load ROM: %s\n", rom);
+            platform_quit(&rec.sdl);
+            return EXIT_FAILURE;
+        }
+        if (frames <= 0) frames = DEFAULT_ROM_FRAMES;
+    } else {
+        long needed = load_pattern(&chip8);
+        if (frames <= 0) frames = needed;
+    }
+
+    // Paced against absolute deadlines so emulated time tracks the audio clock
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+    const Uint64 start = SDL_GetPerformanceCounter();
+
+    for (long frame = 0; frame < frames; frame++) {
+        chip8_run_frame(&chip8);
+
+        Uint64 deadline = start + (Uint64)(frame + 1) * frequency / TIMER_FREQUENCY;
+        Uint64 now = SDL_GetPerformanceCounter();
+        if (now < deadline) SDL_Delay((Uint32)((deadline - now) * 1000 / frequency));
+    }
+
+    // Silence the last beep (as a reset would), let the queue play out, close the file
+    if (chip8.sound_active) record_edge(&rec, false, timer_cycle_us(&chip8, chip8.cycles));
+    SDL_Delay(DRAIN_MS);
+    platform_quit(&rec.sdl);
+
+    if (rec.count == 0) {
+        printf("No beeps in %ld frames; nothing to check\n", frames);
+        return EXIT_SUCCESS;
+    }
+
+    long length = 0;
+    uint8_t *samples = read_samples(out, &length);
+    if (!samples) return EXIT_FAILURE;
+
+    int errors = check_samples(&rec, samples, length);
+    free(samples);
+
+    if (errors) {
+        fprintf(stderr, "Audio check failed (%d mismatch(es)), samples in %s\n", errors, out);
+        return EXIT_FAILURE;
+    }
+    printf("Audio output matches the emulated beep edges\n");
+    return EXIT_SUCCESS;
+}
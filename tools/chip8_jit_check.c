@@ -0,0 +1,194 @@
+/**
+ * chip8_jit_check.c
+ *
+ * JIT-versus-interpreter checker.
+ *
+ * Runs each program twice in lockstep: once through compiled blocks (JIT
+ * threshold 1, so every address is compiled on its first visit) and once
+ * through the plain interpreter, with the same key states and the same Cxkk
+ * seed. After every compiled block the interpreter is advanced to the same
+ * instruction count, and the instruction counts and the full machine
+ * state must match.
+ *
+ * A built-in self-modifying loop runs first: its block stores over its own
+ * translated bytes, which flushes the code cache while the block runs.
+ *
+ * Usage:
+ *     chip8-jit-check [--frames N] [--cycles N] [ROM]...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "chip8.h"
+#include "jit.h"
+#include "timer.h"
+
+#define DEFAULT_FRAMES 600             // Ten emulated seconds per program
+
+// LD I,0x20A; LD V0,0x70; ADD V1,1; LD [I],V0..V1 (rewrites 0x20A as ADD V0,V1);
+// ADD V2,1; CLS (patched); SE V2,0x40; JP 0x200; JP 0x210
+static const uint8_t self_modifying[] = {
+    0xA2, 0x0A, 0x60, 0x70, 0x71, 0x01, 0xF1, 0x55, 0x72, 0x01,
+    0x00, 0xE0, 0x32, 0x40, 0x12, 0x00, 0x12, 0x10,
+};
+
+/**
+ * Compares the complete machine state of two instances.
+ *
+ * @return Name of the first differing component, or NULL if they match.
+ */
+static const char *state_diff(const Chip8 *a, const Chip8 *b) {
+    if (a->cycles != b->cycles) return "instruction count";
+    if (a->pc != b->pc) return "pc";
+    if (a->I != b->I) return "I";
+    if (memcmp(a->V, b->V, sizeof(a->V)) != 0) return "V";
+    if (a->sp != b->sp || memcmp(a->stack, b->stack, sizeof(a->stack)) != 0) return "stack";
+    if (a->delay_timer != b->delay_timer || a->delay_set_at != b->delay_set_at ||
+        a->sound_timer != b->sound_timer || a->sound_set_at != b->sound_set_at) return "timers";
+    if (a->rng != b->rng) return "rng";
+    if (a->key_wait != b->key_wait) return "key_wait";
+    if (memcmp(a->memory, b->memory, sizeof(a->memory)) != 0) return "memory";
+    if (memcmp(a->display, b->display, sizeof(a->display)) != 0) return "display";
+    return NULL;
+}
+
+/**
+ * Runs one program through the JIT and the interpreter in lockstep.
+ *
+ * @param name   Program name for the report.
+ * @param jit    Instance with the program loaded and the JIT enabled.
+ * @param plain  Instance with the same program, interpreting.
+ * @param frames Number of frames to run.
+ * @param cycles Instructions per frame.
+ * @return       0 if every step matched, -1 otherwise.
+ */
+static int check_program(const char *name, Chip8 *jit, Chip8 *plain, long frames, uint32_t cycles) {
+    uint64_t blocks = 0;
+
+    for (long frame = 0; frame < frames; frame++) {
+        // Same key states for both; a key ends an Fx0A wait at the frame start, as in chip8_run
+        srand((unsigned)frame);
+        for (int k = 0; k < KEYPAD_SIZE; k++) jit->keypad[k] = plain->keypad[k] = (rand() & 7) == 0;
+        for (int k = 0; k < KEYPAD_SIZE; k++) {
+            if (jit->keypad[k]) jit->key_wait = plain->key_wait = false;
+        }
+
+        uint64_t end = jit->cycles + cycles;
+        while (jit->cycles < end && jit->pc < MEMORY_SIZE - 1) {
+            // Still waiting: the clock runs on to the end of the frame
+            if (jit->key_wait) {
+                jit->cycles = plain->cycles = end;
+                break;
+            }
+
+            // The smallest budget the block at PC fits in runs exactly that one block
+            uint64_t before = jit->cycles;
+            uint32_t executed = 0;
+            for (uint32_t budget = 1; !executed && budget <= UINT8_MAX && budget <= end - before; budget++) {
+                executed = jit_execute(jit, budget);
+            }
+            if (executed) {
+                blocks++;
+            } else {
+                chip8_cycle(jit);
+                executed = 1;
+            }
+
+            if (jit->cycles != before + executed) {
+                fprintf(stderr, "%s: frame %ld, pc 0x%03X: %u instructions executed but the count advanced by %llu\n",
+                        name, frame, jit->pc, executed, (unsigned long long)(jit->cycles - before));
+                return -1;
+            }
+
+            for (uint32_t i = 0; i < executed && plain->pc < MEMORY_SIZE - 1; i++) chip8_cycle(plain);
+
+            const char *diff = state_diff(jit, plain);
+            if (diff) {
+                fprintf(stderr, "%s: mismatch in %s after instruction %llu (pc 0x%03X vs 0x%03X)\n",
+                        name, diff, (unsigned long long)plain->cycles, jit->pc, plain->pc);
+                return -1;
+            }
+        }
+
+        timer_update(jit);
+        timer_update(plain);
+    }
+
+    printf("%s: JIT and interpreter match over %ld frames (%llu blocks run)\n",
+           name, frames, (unsigned long long)blocks);
+    return 0;
+}
+
+/**
+ * Sets up the two instances of one program, loaded from `path` or, if it is
+ * NULL, from `program`.
+ *
+ * @return 0 on success, -1 on failure.
+ */
+static int load_pair(Chip8 *jit, Chip8 *plain, const char *path, const uint8_t *program, size_t size) {
+    Chip8 *pair[2] = { jit, plain };
+
+    for (int i = 0; i < 2; i++) {
+        chip8_init(pair[i]);
+        pair[i]->skip_idle = false;
+        if (path) {
+            if (chip8_load_rom(pair[i], path)) {
+                fprintf(stderr, "Failed to load ROM: %s\n", path);
+                return -1;
+            }
+        } else {
+            memcpy(&pair[i]->memory[0x200], program, size);
+        }
+    }
+
+    if (!jit_enable(jit, 1)) {
+        fprintf(stderr, "JIT backend not supported on this host\n");
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    static Chip8 jit, plain;
+    long frames = DEFAULT_FRAMES;
+    long cycles = CYCLES_PER_FRAME;
+    int first_rom = argc;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = strtol(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--cycles") == 0 && i + 1 < argc) {
+            cycles = strtol(argv[++i], NULL, 0);
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "Usage: %s [--frames N] [--cycles N] [ROM]...\n", argv[0]);
+            return EXIT_FAILURE;
+        } else {
+            first_rom = i;
+            break;
+        }
+    }
+
+    if (frames <= 0 || cycles <= 0) {
+        fprintf(stderr, "Usage: %s [--frames N] [--cycles N] [ROM]...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int failures = 0;
+    if (load_pair(&jit, &plain, NULL, self_modifying, sizeof(self_modifying)) ||
+        check_program("self-modifying loop", &jit, &plain, frames, (uint32_t)cycles)) {
+        failures++;
+    }
+    jit_disable(&jit);
+
+    for (int i = first_rom; i < argc; i++) {
+        if (load_pair(&jit, &plain, argv[i], NULL, 0) ||
+            check_program(argv[i], &jit, &plain, frames, (uint32_t)cycles)) {
+            failures++;
+        }
+        jit_disable(&jit);
+    }
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,248 @@
+/**
+ * chip8_profile.c
+ *
+ * Opcode sequence profiler and idle-skip checker.
+ *
+ * Profile mode runs each ROM through the interpreter one instruction at a
+ * time and counts opcode pairs and triples that execute back to back at
+ * consecutive addresses, i.e. the straight-line sequences the interpreter
+ * dispatches one instruction at a time. Opcodes are grouped by their leaf handler
+ * (`Annn`, `8xy4`, ...), and the hottest sequences over the whole corpus are
+ * printed.
+ *
+ * Check mode (--check) runs every ROM twice in lockstep, with and without
+ * `chip8->skip_idle`, and compares the full machine state after every frame.
+ *
+ * Usage:
+ *     chip8-profile [--frames N] [--cycles N] [--top N] [--check] <ROM>...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "chip8.h"
+#include "input.h"
+#include "timer.h"
+#include "platform.h"
+#include "opcode_names.h"
+
+#define DEFAULT_FRAMES 3600            // One emulated minute per ROM
+#define DEFAULT_TOP 15
+#define MAX_CLASSES 48                 // Distinct handler names (+ undefined)
+
+static const char *class_names[MAX_CLASSES];
+static int class_count;
+
+static uint64_t pairs[MAX_CLASSES * MAX_CLASSES];
+static uint64_t triples[MAX_CLASSES * MAX_CLASSES * MAX_CLASSES];
+static uint64_t total_instructions;
+
+/**
+ * Maps an opcode to a small class index (one per leaf handler).
+ */
+static int opcode_class(uint16_t opcode) {
+    const char *name = opcode_handler_name(opcode);
+    name = name ? name + 3 : "????";   // Strip the "op_" prefix
+
+    for (int i = 0; i < class_count; i++) {
+        if (class_names[i] == name || strcmp(class_names[i], name) == 0) return i;
+    }
+    class_names[class_count] = name;
+    return class_count++;
+}
+
+/**
+ * Headless input for the tools: each key is down with probability 1/8,
+ * drawn from rand() so instances reseeded alike see the same keys.
+ */
+static void random_keys(void *ctx, uint8_t *keypad) {
+    (void)ctx;
+    for (int i = 0; i < KEYPAD_SIZE; i++) keypad[i] = (rand() & 7) == 0;
+}
+
+static const Platform random_input = { .poll_input = random_keys };
+
+/**
+ * Loads a ROM into a freshly initialized instance, with or without
+ * idle-loop fast-forward.
+ *
+ * @return 0 on success, -1 on failure.
+ */
+static int load(Chip8 *chip8, const char *path, bool skip_idle) {
+    chip8_init(chip8);
+    chip8->skip_idle = skip_idle;
+    chip8->platform = &random_input;
+    if (chip8_load_rom(chip8, path)) {
+        fprintf(stderr, "Failed to load ROM: %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Profiles one ROM, accumulating into the global pair/triple counts.
+ */
+static int profile_rom(const char *path, long frames, uint32_t cycles) {
+    static Chip8 chip8;
+    if (load(&chip8, path, false)) return -1;
+
+    int prev1 = -1, prev2 = -1;
+    uint16_t last_pc = 0;
+
+    for (long frame = 0; frame < frames; frame++) {
+        srand((unsigned)frame);
+        keypad_scan(&chip8, cycles);
+
+        for (uint32_t i = 0; i < cycles && chip8.pc < MEMORY_SIZE - 1; i++) {
+            uint16_t pc = chip8.pc;
+            int cls = opcode_class((uint16_t)((chip8.memory[pc] << 8) | chip8.memory[pc + 1]));
+
+            // Only fall-through sequences are counted
+            if (pc != last_pc + 2) prev1 = prev2 = -1;
+
+            if (prev1 >= 0) pairs[prev1 * MAX_CLASSES + cls]++;
+            if (prev2 >= 0) triples[(prev2 * MAX_CLASSES + prev1) * MAX_CLASSES + cls]++;
+            prev2 = prev1;
+            prev1 = cls;
+            last_pc = pc;
+
+            chip8_cycle(&chip8);
+            total_instructions++;
+        }
+
+        timer_update(&chip8);
+    }
+
+    return 0;
+}
+
+static const uint64_t *sort_counts;   // Table being ranked by compare_counts
+
+/**
+ * qsort comparator: descending count.
+ */
+static int compare_counts(const void *a, const void *b) {
+    uint64_t ca = sort_counts[*(const int *)a];
+    uint64_t cb = sort_counts[*(const int *)b];
+    return (ca < cb) - (ca > cb);
+}
+
+/**
+ * Prints the `top` largest entries of a count table.
+ */
+static void print_top(const char *title, const uint64_t *counts, int entries, int arity, int top) {
+    static int order[MAX_CLASSES * MAX_CLASSES * MAX_CLASSES];
+    int used = 0;
+
+    for (int i = 0; i < entries; i++) {
+        if (counts[i]) order[used++] = i;
+    }
+    sort_counts = counts;
+    qsort(order, (size_t)used, sizeof(order[0]), compare_counts);
+
+    printf("\n%s\n", title);
+    for (int rank = 0; rank < top && rank < used; rank++) {
+        int index = order[rank], parts[3];
+
+        for (int k = arity - 1; k >= 0; k--) {
+            parts[k] = index % MAX_CLASSES;
+            index /= MAX_CLASSES;
+        }
+
+        printf("  %12llu  %5.2f%%  ", (unsigned long long)counts[order[rank]],
+               100.0 * (double)counts[order[rank]] / (double)total_instructions);
+        for (int k = 0; k < arity; k++) printf("%-6s", class_names[parts[k]]);
+        printf("\n");
+    }
+}
+
+/**
+ * Compares the architectural state of two instances.
+ *
+ * @return Name of the first differing component, or NULL if they match.
+ */
+static const char *state_diff(const Chip8 *a, const Chip8 *b) {
+    if (a->pc != b->pc) return "pc";
+    if (a->I != b->I) return "I";
+    if (memcmp(a->V, b->V, sizeof(a->V)) != 0) return "V";
+    if (a->sp != b->sp || memcmp(a->stack, b->stack, sizeof(a->stack)) != 0) return "stack";
+    if (get_delay_timer(a) != get_delay_timer(b) || get_sound_timer(a) != get_sound_timer(b)) return "timers";
+    if (memcmp(a->memory, b->memory, sizeof(a->memory)) != 0) return "memory";
+    if (memcmp(a->display, b->display, sizeof(a->display)) != 0) return "display";
+    return NULL;
+}
+
+/**
+ * Runs one ROM with and without idle skipping in lockstep.
+ *
+ * @return 0 if every frame matched, -1 otherwise.
+ */
+static int check_rom(const char *path, long frames, uint32_t cycles) {
+    static Chip8 skipping, plain;
+    if (load(&skipping, path, true) || load(&plain, path, false)) return -1;
+
+    for (long frame = 0; frame < frames; frame++) {
+        // Same key states for both instances; each has its own Cxkk generator, seeded alike
+        srand((unsigned)frame);
+        chip8_run(&skipping, cycles);
+        srand((unsigned)frame);
+        chip8_run(&plain, cycles);
+
+        const char *diff = state_diff(&skipping, &plain);
+        if (diff) {
+            fprintf(stderr, "%s: mismatch in %s after frame %ld (pc 0x%03X vs 0x%03X)\n",
+                    path, diff, frame, skipping.pc, plain.pc);
+            return -1;
+        }
+    }
+
+    printf("%s: idle skipping matches plain execution over %ld frames (%.1f%% fast-forwarded)\n", path, frames,
+           100.0 * (double)skipping.idle_skipped / (double)(skipping.cycles ? skipping.cycles : 1));
+    return 0;
+}
+
+int SDL_main(int argc, char *argv[]) {
+    long frames = DEFAULT_FRAMES;
+    long cycles = CYCLES_PER_FRAME;
+    int top = DEFAULT_TOP;
+    bool check = false;
+    int first_rom = argc;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = strtol(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--cycles") == 0 && i + 1 < argc) {
+            cycles = strtol(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--top") == 0 && i + 1 < argc) {
+            top = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--check") == 0) {
+            check = true;
+        } else if (argv[i][0] == '-') {
+            break;
+        } else {
+            first_rom = i;
+            break;
+        }
+    }
+
+    if (first_rom >= argc || frames <= 0 || cycles <= 0) {
+        fprintf(stderr, "Usage: %s [--frames N] [--cycles N] [--top N] [--check] <ROM>...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int failures = 0;
+    for (int i = first_rom; i < argc; i++) {
+        int result = check ? check_rom(argv[i], frames, (uint32_t)cycles)
+                           : profile_rom(argv[i], frames, (uint32_t)cycles);
+        if (result) failures++;
+    }
+
+    if (!check) {
+        printf("%llu instructions over %d ROM(s)\n", (unsigned long long)total_instructions, argc - first_rom);
+        print_top("Hottest fall-through pairs:", pairs, MAX_CLASSES * MAX_CLASSES, 2, top);
+        print_top("Hottest fall-through triples:", triples, MAX_CLASSES * MAX_CLASSES * MAX_CLASSES, 3, top);
+    }
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
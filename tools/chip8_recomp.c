@@ -0,0 +1,419 @@
+/**
+ * chip8_recomp.c
+ *
+ * Ahead-of-time static recompiler: translates a CHIP-8 ROM into a C
+ * translation unit with one function per basic block.
+ *
+ * Usage: chip8-recomp <ROM file> <output.c>
+ *
+ * Control flow is walked from 0x200; only code reachable through direct
+ * jumps, calls, returns sites and skips is translated, so data embedded in
+ * the ROM is never mistaken for code. The output defines `recomp_program`
+ * (see include/recomp.h) and is linked against the regular src/ subsystems:
+ * - Register/ALU opcodes, Annn, Fx1E and Fx29 are emitted as plain C
+ * - 1nnn and the conditional skips become direct PC assignments
+ * - A skip over a jump or a plain instruction does not end the block; the
+ *   skipped instruction is emitted behind a PC test (see `folds`)
+ * - Everything else calls the interpreter's handler from opcodes.h
+ *
+ * The emulated clock advances once per block, so the timer opcodes
+ * (Fx07/Fx15/Fx18) always start a block, where the clock is exact.
+ *
+ * Computed jumps (Bnnn) and bytes that no longer match the ROM image are left
+ * to the interpreter at runtime (see src/recomp.c).
+ */
+
+#include "chip8.h"
+#include "opcode_names.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define ROM_START 0x200
+#define MAX_BLOCK_OPS 64             // Longer straight-line runs are split
+
+// How an instruction affects the basic block it appears in
+typedef enum {
+    KIND_INLINE,                     // Emitted as C, block continues
+    KIND_CALL,                       // Interpreter handler, block continues
+    KIND_CALL_END,                   // Interpreter handler that may change PC, ends the block
+    KIND_BRANCH                      // Jump or skip emitted as C, ends the block (see `folds`)
+} OpKind;
+
+static uint8_t rom[MEMORY_SIZE];
+static uint16_t rom_end;             // One past the last ROM byte
+
+static bool block_start[MEMORY_SIZE];
+static uint16_t worklist[MEMORY_SIZE];
+static int worklist_len;
+
+/**
+ * Reads the big-endian opcode at `addr`.
+ */
+static uint16_t fetch(uint16_t addr) {
+    return (uint16_t)((rom[addr] << 8) | rom[addr + 1]);
+}
+
+/**
+ * Returns true if a full instruction at `addr` lies inside the ROM image.
+ */
+static bool in_rom(uint16_t addr) {
+    return addr >= ROM_START && addr + 1 < rom_end;
+}
+
+/**
+ * Classifies an opcode for block formation.
+ *
+ * Stores (Fx33/Fx55) end the block so a write to code that follows is seen
+ * before it is executed.
+ */
+static OpKind classify(uint16_t opcode) {
+    switch (opcode >> 12) {
+        case 0x0:
+            return opcode == 0x00E0 ? KIND_CALL : KIND_CALL_END;
+        case 0x1: case 0x3: case 0x4: case 0x5: case 0x9:
+            return KIND_BRANCH;
+        case 0x6: case 0x7: case 0xA:
+            return KIND_INLINE;
+        case 0x8:
+            return opcode_handler_name(opcode) ? KIND_INLINE : KIND_CALL;
+        case 0xC:
+            return KIND_CALL;
+        case 0x2: case 0xB: case 0xD: case 0xE:
+            return KIND_CALL_END;
+        default:
+            switch (opcode & 0x00FF) {
+                case 0x1E: case 0x29: return KIND_INLINE;
+                case 0x0A: case 0x33: case 0x55: return KIND_CALL_END;
+                default: return KIND_CALL;
+            }
+    }
+}
+
+/**
+ * Whether an opcode reads or timestamps the emulated clock (Fx07/Fx15/Fx18).
+ */
+static bool uses_clock(uint16_t opcode) {
+    uint8_t kk = opcode & 0x00FF;
+    return (opcode >> 12) == 0xF && (kk == 0x07 || kk == 0x15 || kk == 0x18);
+}
+
+/**
+ * Whether a timer-wait loop (Fx07 ; 3xkk/4xkk ; 1nnn back to the Fx07)
+ * starts at `addr`. The interpreter fast-forwards these (see src/idle.c) and
+ * hands back to native code after running the Fx07 of the final pass.
+ */
+static bool idle_loop(uint16_t addr) {
+    if (!in_rom(addr) || !in_rom(addr + 4)) return false;
+
+    uint16_t skip = fetch(addr + 2);
+    return (fetch(addr) & 0xF0FF) == 0xF007 &&
+           ((skip >> 12) == 0x3 || (skip >> 12) == 0x4) &&
+           fetch(addr + 4) == (0x1000 | addr);
+}
+
+/**
+ * Whether the instruction after the skip at `addr` is folded into the block.
+ *
+ * A conditional skip (3xkk/4xkk/5xy0/9xy0/Ex9E/ExA1) followed by a jump or
+ * by an instruction that keeps the block going is translated as a guarded
+ * statement, so the block continues after it instead of ending at the skip.
+ */
+static bool folds(uint16_t addr) {
+    uint16_t opcode = fetch(addr);
+    uint8_t op = opcode >> 12;
+    bool skip = op == 0x3 || op == 0x4 || op == 0x5 || op == 0x9 ||
+                (opcode & 0xF0FF) == 0xE09E || (opcode & 0xF0FF) == 0xE0A1;
+
+    if (!skip || !in_rom(addr + 2)) return false;
+
+    uint16_t next = fetch(addr + 2);
+    OpKind kind = classify(next);
+    return (next >> 12) == 0x1 || ((kind == KIND_INLINE || kind == KIND_CALL) && !uses_clock(next));
+}
+
+/**
+ * Queues a block entry point if it is inside the ROM and not yet known.
+ */
+static void add_entry(uint16_t addr) {
+    if (!in_rom(addr) || block_start[addr]) return;
+    block_start[addr] = true;
+    worklist[worklist_len++] = addr;
+}
+
+/**
+ * Walks one block starting at `start`.
+ *
+ * @param start     First instruction of the block.
+ * @param discover  Queue successor blocks when true.
+ * @return          Number of instructions in the block.
+ */
+static int walk_block(uint16_t start, bool discover) {
+    uint16_t addr = start;
+    int count = 0;
+
+    if (discover && idle_loop(start)) add_entry(start + 2);
+
+    while (in_rom(addr)) {
+        uint16_t opcode = fetch(addr);
+        OpKind kind = classify(opcode);
+
+        // Timer opcodes need the exact clock, which is only current at block entry
+        if (count > 0 && uses_clock(opcode)) {
+            if (discover) add_entry(addr);
+            return count;
+        }
+        count++;
+
+        // Skip over one instruction: translate both and keep going. Both
+        // successors stay entry points for the interpreter to hand back to
+        if (count < MAX_BLOCK_OPS && folds(addr)) {
+            uint16_t next = fetch(addr + 2);
+            if (discover) {
+                if ((next >> 12) == 0x1) add_entry(next & 0x0FFF);
+                add_entry(addr + 2);
+                add_entry(addr + 4);
+            }
+            count++;
+            addr += 4;
+            if (count == MAX_BLOCK_OPS) {
+                if (discover) add_entry(addr);
+                return count;
+            }
+            continue;
+        }
+
+        if (kind == KIND_BRANCH) {
+            if (discover) {
+                if ((opcode >> 12) == 0x1) {
+                    add_entry(opcode & 0x0FFF);
+                } else {
+                    add_entry(addr + 2);
+                    add_entry(addr + 4);
+                }
+            }
+            return count;
+        }
+
+        if (kind == KIND_CALL_END) {
+            if (discover) {
+                switch (opcode >> 12) {
+                    case 0x2:               // Callee, then the return site
+                        add_entry(opcode & 0x0FFF);
+                        add_entry(addr + 2);
+                        break;
+                    case 0xB:               // Computed: resolved by the interpreter
+                        break;
+                    case 0xE:               // Key skips
+                        add_entry(addr + 2);
+                        add_entry(addr + 4);
+                        break;
+                    case 0x0:
+                        if (opcode != 0x00EE) add_entry(addr + 2);
+                        break;
+                    default:                // Dxyn, Fx0A, Fx33, Fx55
+                        add_entry(addr + 2);
+                        break;
+                }
+            }
+            return count;
+        }
+
+        addr += 2;
+        if (count == MAX_BLOCK_OPS) {
+            if (discover) add_entry(addr);
+            return count;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Emits the C statement(s) for one instruction, without a trailing newline.
+ */
+static void emit_stmt(FILE *out, uint16_t addr, uint16_t opcode) {
+    unsigned x = (opcode >> 8) & 0xF;
+    unsigned y = (opcode >> 4) & 0xF;
+    unsigned kk = opcode & 0xFF;
+    unsigned nnn = opcode & 0x0FFF;
+    unsigned next = addr + 2, skip = addr + 4;
+    OpKind kind = classify(opcode);
+    const char *name = opcode_handler_name(opcode);
+
+    if (kind == KIND_CALL || kind == KIND_CALL_END) {
+        // Handlers expect PC to already point past the instruction
+        fprintf(out, "c->pc = 0x%03X; %s(c, 0x%04X);", next, name ? name : "op_unknown", opcode);
+        return;
+    }
+
+    switch (opcode >> 12) {
+        case 0x1: fprintf(out, "c->pc = 0x%03X;", nnn); break;
+        case 0x3: fprintf(out, "c->pc = V[0x%X] == 0x%02X ? 0x%03X : 0x%03X;", x, kk, skip, next); break;
+        case 0x4: fprintf(out, "c->pc = V[0x%X] != 0x%02X ? 0x%03X : 0x%03X;", x, kk, skip, next); break;
+        case 0x5: fprintf(out, "c->pc = V[0x%X] == V[0x%X] ? 0x%03X : 0x%03X;", x, y, skip, next); break;
+        case 0x9: fprintf(out, "c->pc = V[0x%X] != V[0x%X] ? 0x%03X : 0x%03X;", x, y, skip, next); break;
+        case 0x6: fprintf(out, "V[0x%X] = 0x%02X;", x, kk); break;
+        case 0x7: fprintf(out, "V[0x%X] = (uint8_t)(V[0x%X] + 0x%02X);", x, x, kk); break;
+        case 0xA: fprintf(out, "c->I = 0x%03X;", nnn); break;
+        case 0x8:
+            switch (opcode & 0xF) {
+                case 0x0: fprintf(out, "V[0x%X] = V[0x%X];", x, y); break;
+                case 0x1: fprintf(out, "V[0x%X] |= V[0x%X];", x, y); break;
+                case 0x2: fprintf(out, "V[0x%X] &= V[0x%X];", x, y); break;
+                case 0x3: fprintf(out, "V[0x%X] ^= V[0x%X];", x, y); break;
+                case 0x4:
+                    fprintf(out, "{ uint16_t sum = V[0x%X] + V[0x%X]; V[0xF] = sum > 0xFF; V[0x%X] = (uint8_t)sum; }\n",
+                            x, y, x);
+                    break;
+                case 0x5: fprintf(out, "V[0xF] = V[0x%X] > V[0x%X]; V[0x%X] -= V[0x%X];", x, y, x, y); break;
+                case 0x6: fprintf(out, "V[0xF] = V[0x%X] & 0x1; V[0x%X] >>= 1;", x, x); break;
+                case 0x7:
+                    fprintf(out, "V[0xF] = V[0x%X] > V[0x%X]; V[0x%X] = V[0x%X] - V[0x%X];", y, x, x, y, x);
+                    break;
+                case 0xE: fprintf(out, "V[0xF] = (V[0x%X] & 0x80) >> 7; V[0x%X] <<= 1;", x, x); break;
+            }
+            break;
+        case 0xF:
+            if (kk == 0x1E) fprintf(out, "c->I += V[0x%X];", x);
+            else fprintf(out, "c->I = V[0x%X] * 5;", x);
+            break;
+    }
+}
+
+/**
+ * Emits the function for the block starting at `start`.
+ *
+ * An instruction folded behind a skip only runs if the skip fell through
+ * (PC still points at it); the function returns how many instructions ran.
+ *
+ * @return Size of the block in bytes.
+ */
+static uint16_t emit_block(FILE *out, uint16_t start, int count) {
+    uint16_t addr = start;
+    bool open = false, folded = false, has_folds = false;
+
+    for (int i = 0; i + 1 < count; i++)
+        has_folds |= folds((uint16_t)(start + 2 * i));
+
+    fprintf(out, "static uint32_t blk_%03X(Chip8 *c) {\n", start);
+    fprintf(out, "    uint8_t *V = c->V;\n");
+    fprintf(out, "    (void)V;\n");
+    if (has_folds) fprintf(out, "    uint32_t skipped = 0;\n");
+
+    for (int i = 0; i < count; i++, addr += 2) {
+        uint16_t opcode = fetch(addr);
+        OpKind kind = classify(opcode);
+
+        fprintf(out, "    /* %03X: %04X */ ", addr, opcode);
+        if (folded) {
+            fprintf(out, "if (c->pc == 0x%03X) { ", addr);
+            emit_stmt(out, addr, opcode);
+            if (kind == KIND_BRANCH) fprintf(out, " return %d - skipped;", i + 1);
+            fprintf(out, " } else skipped++;\n");
+        } else {
+            emit_stmt(out, addr, opcode);
+            fprintf(out, "\n");
+        }
+
+        // The block goes on after a folded instruction whatever it was
+        open = folded || kind == KIND_INLINE || kind == KIND_CALL;
+        folded = !folded && i + 1 < count && folds(addr);
+    }
+
+    // Straight-line block split by length or the end of the ROM
+    if (open) fprintf(out, "    c->pc = 0x%03X;\n", addr);
+
+    fprintf(out, "    return %d%s;\n", count, has_folds ? " - skipped" : "");
+    fprintf(out, "}\n\n");
+    return (uint16_t)(addr - start);
+}
+
+/**
+ * Derives a C-friendly program name from the ROM path (used for messages only).
+ */
+static void rom_label(const char *path, char *label, size_t size) {
+    const char *base = strrchr(path, '/');
+    const char *alt = strrchr(path, '\\');
+    if (alt && (!base || alt > base)) base = alt;
+    base = base ? base + 1 : path;
+
+    size_t n = 0;
+    for (; base[n] && n + 1 < size; n++)
+        label[n] = (isprint((unsigned char)base[n]) && base[n] != '"' && base[n] != '\\') ? base[n] : '_';
+    label[n] = '\0';
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <ROM file> <output.c>\n", argv[0]);
+        return 1;
+    }
+
+    FILE *in = fopen(argv[1], "rb");
+    if (!in) {
+        fprintf(stderr, "Failed to open ROM file: %s\n", argv[1]);
+        return 1;
+    }
+    size_t size = fread(rom + ROM_START, 1, MEMORY_SIZE - ROM_START, in);
+    fclose(in);
+
+    if (size == 0) {
+        fprintf(stderr, "ROM file is empty: %s\n", argv[1]);
+        return 1;
+    }
+    rom_end = (uint16_t)(ROM_START + size);
+
+    // Discover blocks by following direct control flow from the entry point
+    add_entry(ROM_START);
+    while (worklist_len > 0)
+        walk_block(worklist[--worklist_len], true);
+
+    FILE *out = fopen(argv[2], "w");
+    if (!out) {
+        fprintf(stderr, "Failed to open output file: %s\n", argv[2]);
+        return 1;
+    }
+
+    char label[64];
+    rom_label(argv[1], label, sizeof(label));
+
+    fprintf(out, "/* Generated by chip8-recomp from %s. Do not edit. */\n\n", label);
+    fprintf(out, "#include \"recomp.h\"\n#include \"opcodes.h\"\n#include \"dispatch.h\"\n\n");
+
+    fprintf(out, "static const uint8_t rom_image[%u] = {", (unsigned)size);
+    for (size_t i = 0; i < size; i++)
+        fprintf(out, "%s0x%02X,", (i % 12) ? " " : "\n    ", rom[ROM_START + i]);
+    fprintf(out, "\n};\n\n");
+
+    int block_count = 0;
+    for (unsigned addr = ROM_START; addr < rom_end; addr++) {
+        if (!block_start[addr]) continue;
+        emit_block(out, (uint16_t)addr, walk_block((uint16_t)addr, false));
+        block_count++;
+    }
+
+    fprintf(out, "static const RecompBlock blocks[%d] = {\n", block_count);
+    for (unsigned addr = ROM_START; addr < rom_end; addr++) {
+        if (!block_start[addr]) continue;
+        int count = walk_block((uint16_t)addr, false);
+        fprintf(out, "    { 0x%03X, %d, %d, blk_%03X },\n", addr, count * 2, count, addr);
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static const RecompBlock *const block_map[MEMORY_SIZE] = {\n");
+    for (int i = 0, addr = ROM_START; addr < rom_end; addr++) {
+        if (!block_start[addr]) continue;
+        fprintf(out, "    [0x%03X] = &blocks[%d],\n", addr, i++);
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "const RecompProgram recomp_program = {\n");
+    fprintf(out, "    \"%s\", rom_image, sizeof(rom_image), block_map\n", label);
+    fprintf(out, "};\n");
+
+    fclose(out);
+    printf("%s: %d blocks from %u bytes\n", label, block_count, (unsigned)size);
+    return 0;
+}
@@ -0,0 +1,106 @@
+/**
+ * gen_dispatch_table.c
+ *
+ * Build-time generator for the flat opcode dispatch table.
+ *
+ * Usage: gen_dispatch_table <output.c>
+ *
+ * Emits `dispatch_table`, a compile-time constant array with one entry per
+ * 16-bit opcode pointing straight at its leaf handler in opcodes.h. Opcodes
+ * with no defined instruction map to the single fault handler `op_unknown`.
+ * Decoding rules come from opcode_names.h, shared with chip8-recomp.
+ *
+ * Also emits the compact form the decode cache stores: `dispatch_handlers`,
+ * every distinct leaf handler once (entry 0 is NULL, "not decoded"), and
+ * `dispatch_index`, the position of each opcode's handler in that list.
+ */
+
+#include "opcode_names.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TABLE_SIZE 0x10000
+#define ENTRIES_PER_LINE 8
+#define INDEX_ENTRIES_PER_LINE 16
+#define MAX_HANDLERS 256             // Indices must fit in a byte
+
+static const char *handlers[MAX_HANDLERS];
+static int handler_count = 1;        // Index 0 is reserved for "not decoded"
+
+/**
+ * Returns the index of a handler name in `handlers`, adding it if new.
+ *
+ * @return The index, or -1 if the list is full.
+ */
+static int handler_index(const char *name) {
+    for (int i = 1; i < handler_count; i++) {
+        if (strcmp(handlers[i], name) == 0) return i;
+    }
+    if (handler_count == MAX_HANDLERS) return -1;
+    handlers[handler_count] = name;
+    return handler_count++;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <output.c>\n", argv[0]);
+        return 1;
+    }
+
+    FILE *out = fopen(argv[1], "w");
+    if (!out) {
+        fprintf(stderr, "Failed to open output file: %s\n", argv[1]);
+        return 1;
+    }
+
+    fprintf(out, "/* Generated by gen_dispatch_table. Do not edit. */\n\n");
+    fprintf(out, "#include <stddef.h>\n#include \"dispatch.h\"\n#include \"opcodes.h\"\n\n");
+    fprintf(out, "const OpcodeHandler dispatch_table[0x10000] = {\n");
+
+    int valid = 0;
+    for (unsigned opcode = 0; opcode < TABLE_SIZE; opcode++) {
+        const char *name = opcode_handler_name((uint16_t)opcode);
+        if (name) valid++;
+
+        if (opcode % ENTRIES_PER_LINE == 0)
+            fprintf(out, "    /* %04X */", opcode);
+        fprintf(out, " %s,", name ? name : "op_unknown");
+        if (opcode % ENTRIES_PER_LINE == ENTRIES_PER_LINE - 1)
+            fprintf(out, "\n");
+    }
+
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "const uint8_t dispatch_index[0x10000] = {\n");
+    for (unsigned opcode = 0; opcode < TABLE_SIZE; opcode++) {
+        const char *name = opcode_handler_name((uint16_t)opcode);
+        int index = handler_index(name ? name : "op_unknown");
+        if (index < 0) {
+            fprintf(stderr, "More than %d leaf handlers\n", MAX_HANDLERS - 1);
+            fclose(out);
+            return 1;
+        }
+
+        if (opcode % INDEX_ENTRIES_PER_LINE == 0)
+            fprintf(out, "    /* %04X */", opcode);
+        fprintf(out, " %d,", index);
+        if (opcode % INDEX_ENTRIES_PER_LINE == INDEX_ENTRIES_PER_LINE - 1)
+            fprintf(out, "\n");
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "const OpcodeHandler dispatch_handlers[%d] = {\n    NULL,\n", handler_count);
+    for (int i = 1; i < handler_count; i++) {
+        fprintf(out, "    %s,\n", handlers[i]);
+    }
+    fprintf(out, "};\n");
+
+    if (fclose(out) != 0) {
+        fprintf(stderr, "Failed to write output file: %s\n", argv[1]);
+        return 1;
+    }
+
+    printf("dispatch_table: %d valid opcodes, %d faulting, %d leaf handlers\n",
+           valid, TABLE_SIZE - valid, handler_count - 1);
+    return 0;
+}
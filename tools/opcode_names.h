@@ -0,0 +1,67 @@
+#ifndef OPCODE_NAMES_H
+#define OPCODE_NAMES_H
+
+/**
+ * opcode_names.h
+ *
+ * Opcode decoding rules shared by the host tools (gen_dispatch_table,
+ * chip8-recomp). Maps an opcode to the name of its leaf handler in
+ * opcodes.h, following the same groups as the tables in dispatch.c.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Name of the leaf handler for an opcode.
+ *
+ * @param opcode The 16-bit opcode.
+ * @return       Handler name, or NULL if the opcode is not a valid instruction.
+ */
+static const char *opcode_handler_name(uint16_t opcode) {
+    static const char *const main_names[0x10] = {
+        NULL, "op_1nnn", "op_2nnn", "op_3xkk", "op_4xkk", "op_5xy0", "op_6xkk", "op_7xkk",
+        NULL, "op_9xy0", "op_Annn", "op_Bnnn", "op_Cxkk", "op_Dxyn", NULL, NULL
+    };
+
+    switch (opcode >> 12) {
+        case 0x0:
+            if (opcode == 0x00E0) return "op_00E0";
+            if (opcode == 0x00EE) return "op_00EE";
+            return NULL;
+        case 0x8:
+            switch (opcode & 0x000F) {
+                case 0x0: return "op_8xy0";
+                case 0x1: return "op_8xy1";
+                case 0x2: return "op_8xy2";
+                case 0x3: return "op_8xy3";
+                case 0x4: return "op_8xy4";
+                case 0x5: return "op_8xy5";
+                case 0x6: return "op_8xy6";
+                case 0x7: return "op_8xy7";
+                case 0xE: return "op_8xyE";
+                default:  return NULL;
+            }
+        case 0xE:
+            if ((opcode & 0x00FF) == 0x9E) return "op_Ex9E";
+            if ((opcode & 0x00FF) == 0xA1) return "op_ExA1";
+            return NULL;
+        case 0xF:
+            switch (opcode & 0x00FF) {
+                case 0x07: return "op_Fx07";
+                case 0x0A: return "op_Fx0A";
+                case 0x15: return "op_Fx15";
+                case 0x18: return "op_Fx18";
+                case 0x1E: return "op_Fx1E";
+                case 0x29: return "op_Fx29";
+                case 0x33: return "op_Fx33";
+                case 0x55: return "op_Fx55";
+                case 0x65: return "op_Fx65";
+                default:   return NULL;
+            }
+        default:
+            return main_names[opcode >> 12];
+    }
+}
+
+#endif
@@ -0,0 +1,178 @@
+/**
+ * recomp_main.c
+ *
+ * Host for a ROM translated by chip8-recomp. Linked with the generated
+ * translation unit (which defines `recomp_program`) and the regular core.
+ *
+ * Runs the program frame by frame as fast as possible and reports the
+ * instruction rate. With --verify, an interpreter instance runs in lockstep
+ * and the full machine state is compared after every frame. With --bench,
+ * the recompiled program and the interpreter each run BENCH_REPEATS times
+ * from power-on and the fastest run of each side is reported.
+ *
+ * Usage:
+ *     <binary> [--frames N] [--cycles N] [--verify] [--interp] [--bench]
+ */
+
+#include "../bench/bench.h"
+#include <stdlib.h>
+#include <string.h>
+
+#include "chip8.h"
+#include "recomp.h"
+#include "platform.h"
+#include "timer.h"
+
+extern const RecompProgram recomp_program;
+
+#define DEFAULT_FRAMES 3600            // One emulated minute at 60Hz
+#define DEFAULT_CYCLES 1000            // Instructions per frame (throughput, not accuracy)
+
+/**
+ * Headless input for the tools: each key is down with probability 1/8,
+ * drawn from rand() so instances reseeded alike see the same keys.
+ */
+static void random_keys(void *ctx, uint8_t *keypad) {
+    (void)ctx;
+    for (int i = 0; i < KEYPAD_SIZE; i++) keypad[i] = (rand() & 7) == 0;
+}
+
+static const Platform random_input = { .poll_input = random_keys };
+
+/**
+ * Compares the architectural state of two instances.
+ *
+ * @return Name of the first differing component, or NULL if they match.
+ */
+static const char *state_diff(const Chip8 *a, const Chip8 *b) {
+    if (a->pc != b->pc) return "pc";
+    if (a->I != b->I) return "I";
+    if (memcmp(a->V, b->V, sizeof(a->V)) != 0) return "V";
+    if (a->sp != b->sp || memcmp(a->stack, b->stack, sizeof(a->stack)) != 0) return "stack";
+    if (get_delay_timer(a) != get_delay_timer(b) || get_sound_timer(a) != get_sound_timer(b)) return "timers";
+    if (memcmp(a->memory, b->memory, sizeof(a->memory)) != 0) return "memory";
+    if (memcmp(a->display, b->display, sizeof(a->display)) != 0) return "display";
+    return NULL;
+}
+
+/**
+ * Powers on an instance with the program's ROM image loaded.
+ *
+ * @param chip8  Instance to reset.
+ * @param native Run the translated blocks (false: interpreter only).
+ */
+static void power_on(Chip8 *chip8, bool native) {
+    chip8_init(chip8);
+    chip8->platform = &random_input;
+    recomp_attach(chip8, &recomp_program);
+    if (!native) chip8->recomp = NULL;
+}
+
+/**
+ * Runs `frames` frames of `cycles` instructions.
+ *
+ * @param chip8     Instance under test.
+ * @param reference Interpreter instance compared after every frame, or NULL.
+ * @param executed  Receives the number of instructions executed.
+ * @return          Elapsed seconds, or a negative value on a state mismatch.
+ */
+static double run_frames(Chip8 *chip8, Chip8 *reference, long frames, long cycles, uint64_t *executed) {
+    double start = bench_now();
+    *executed = 0;
+
+    for (long frame = 0; frame < frames; frame++) {
+        // Keys come from rand(); reseed so both instances see the same key states
+        srand((unsigned)frame);
+        Chip8Frame result = chip8_run(chip8, (uint32_t)cycles);
+        *executed += result.cycles;
+        chip8->draw_flag = false;
+
+        if (!reference) continue;
+
+        srand((unsigned)frame);
+        chip8_run(reference, (uint32_t)cycles);
+        reference->draw_flag = false;
+
+        const char *diff = state_diff(chip8, reference);
+        if (diff) {
+            fprintf(stderr, "%s: mismatch in %s after frame %ld (pc 0x%03X vs 0x%03X)\n",
+                    recomp_program.name, diff, frame, chip8->pc, reference->pc);
+            return -1.0;
+        }
+    }
+
+    return bench_now() - start;
+}
+
+/**
+ * Times the recompiled program against the interpreter from power-on,
+ * alternating sides, and prints the best run of each.
+ */
+static void bench(long frames, long cycles) {
+    static Chip8 chip8;
+    double best[2] = { 0.0, 0.0 };
+    uint64_t executed[2] = { 0, 0 };
+
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        for (int native = 0; native < 2; native++) {
+            power_on(&chip8, native);
+            double seconds = run_frames(&chip8, NULL, frames, cycles, &executed[native]);
+            if (r == 0 || seconds < best[native]) best[native] = seconds;
+        }
+    }
+
+    double mips[2];
+    for (int native = 0; native < 2; native++)
+        mips[native] = best[native] > 0 ? executed[native] / best[native] / 1e6 : 0.0;
+
+    printf("%s: interpreter %.1f MIPS, recompiled %.1f MIPS (%.2fx, best of %d)\n",
+           recomp_program.name, mips[0], mips[1], mips[0] > 0 ? mips[1] / mips[0] : 0.0, BENCH_REPEATS);
+}
+
+int SDL_main(int argc, char *argv[]) {
+    long frames = DEFAULT_FRAMES;
+    long cycles = DEFAULT_CYCLES;
+    bool verify = false;
+    bool interp = false;
+    bool timed = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = strtol(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--cycles") == 0 && i + 1 < argc) {
+            cycles = strtol(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            verify = true;
+        } else if (strcmp(argv[i], "--interp") == 0) {
+            interp = true;
+        } else if (strcmp(argv[i], "--bench") == 0) {
+            timed = true;
+        } else {
+            fprintf(stderr, "Usage: %s [--frames N] [--cycles N] [--verify] [--interp] [--bench]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (timed) {
+        bench(frames, cycles);
+        return EXIT_SUCCESS;
+    }
+
+    static Chip8 native, reference;
+
+    // --interp runs the same image through the interpreter for comparison
+    power_on(&native, !interp);
+    if (verify) power_on(&reference, false);
+
+    uint64_t executed;
+    double seconds = run_frames(&native, verify ? &reference : NULL, frames, cycles, &executed);
+    if (seconds < 0) return EXIT_FAILURE;
+
+    printf("%s: %llu instructions in %.3fs (%.1f MIPS, %s)%s\n",
+           recomp_program.name, (unsigned long long)executed, seconds,
+           seconds > 0 ? executed / seconds / 1e6 : 0.0,
+           interp ? "interpreter" : "recompiled",
+           verify ? ", matches interpreter" : "");
+
+    return EXIT_SUCCESS;
+}